@@ -3,11 +3,30 @@
 #include <stdio.h>
 #include <finder/feasible_solution_finder.h>
 #include <model/model_parser.h>
+#include <model/model_cache.h>
+#include <generator/generator.h>
+#include <solution/solution_parser.h>
+#include <config/config.h>
+#include <heuristics/heuristic_solver.h>
+#include <timeout/timeout.h>
+#include <heuristics/methods/local_search.h>
+#include <heuristics/methods/hill_climbing.h>
+#include <heuristics/methods/tabu_search.h>
+#include <heuristics/methods/simulated_annealing.h>
 #include <utils/io_utils.h>
 #include <utils/time_utils.h>
 #include <log/verbose.h>
 #include <utils/rand_utils.h>
 #include <utils/mem_utils.h>
+#include <utils/array_utils.h>
+#include <heuristics/neighbourhoods/swap.h>
+#include <heuristics/neighbourhoods/swap_scan.h>
+#include <heuristics/neighbourhoods/swap_sampler.h>
+#include <decomposition/decomposition.h>
+#include <string.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
 
 #define VERBOSITY 0
 
@@ -19,6 +38,20 @@ static const char *DATASETS[] = {
         "datasets/comp05.ctt",
         "datasets/comp06.ctt",
         "datasets/comp07.ctt",
+        "datasets/comp08.ctt",
+        "datasets/comp09.ctt",
+        "datasets/comp10.ctt",
+        "datasets/comp11.ctt",
+        "datasets/comp12.ctt",
+        "datasets/comp13.ctt",
+        "datasets/comp14.ctt",
+        "datasets/comp15.ctt",
+        "datasets/comp16.ctt",
+        "datasets/comp17.ctt",
+        "datasets/comp18.ctt",
+        "datasets/comp19.ctt",
+        "datasets/comp20.ctt",
+        "datasets/comp21.ctt",
 };
 
 #define COUNT_DIFFERENT_SOLUTIONS 1
@@ -89,9 +122,1170 @@ void test_finder_multi(const char **datasets, double r_from, double r_to, double
     }
 }
 
+/* Memory taken by the helpers of a solution of the model. */
+void test_solution_copy(const char *dataset, int trials) {
+    model m;
+    model_init(&m);
+    if (!parse_model(&m, dataset))
+        return;
+
+    solution s1, s2;
+    solution_init(&s1, &m);
+    solution_init(&s2, &m);
+
+    long start = ms();
+    for (int i = 0; i < trials; i++)
+        solution_copy(&s2, &s1);
+    long copy_time = ms() - start;
+
+    start = ms();
+    for (int i = 0; i < trials; i++)
+        solution_clear(&s2);
+    long clear_time = ms() - start;
+
+    print("%s  size: %zu bytes  copy: %.3fus  clear: %.3fus",
+          m._filename, s1._arena_size,
+          (double) 1000 * copy_time / trials,
+          (double) 1000 * clear_time / trials);
+
+    solution_destroy(&s1);
+    solution_destroy(&s2);
+    model_destroy(&m);
+}
+
+void test_solution_copy_multi(const char **datasets, int n_datasets, int trials) {
+    for (int i = 0; i < n_datasets; i++)
+        test_solution_copy(datasets[i], trials);
+}
+
+void test_solution_rollback(const char *dataset, int trials) {
+    model m;
+    model_init(&m);
+    if (!parse_model(&m, dataset))
+        return;
+
+    feasible_solution_finder finder;
+    feasible_solution_finder_init(&finder);
+    feasible_solution_finder_config finder_conf;
+    feasible_solution_finder_config_default(&finder_conf);
+
+    solution s;
+    solution_init(&s, &m);
+    if (!feasible_solution_finder_find(&finder, &finder_conf, &s)) {
+        print("%s  no feasible solution found", m._filename);
+        goto QUIT;
+    }
+
+    // The solution is always brought back, so the moves can be generated upfront
+    swap_move *moves = mallocx(trials, sizeof(swap_move));
+    for (int i = 0; i < trials; i++)
+        swap_move_generate_random_feasible_effective(&s, &moves[i]);
+
+    long start = ms();
+    for (int i = 0; i < trials; i++) {
+        swap_move mv_back;
+        swap_perform(&s, &moves[i], NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
+        swap_move_reverse(&moves[i], &mv_back);
+        swap_perform(&s, &mv_back, NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
+    }
+    long reverse_time = ms() - start;
+
+    start = ms();
+    for (int i = 0; i < trials; i++) {
+        solution_begin(&s);
+        swap_perform(&s, &moves[i], NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
+        solution_rollback(&s);
+    }
+    long rollback_time = ms() - start;
+
+    print("%s  perform+reverse: %.3fus  begin+perform+rollback: %.3fus",
+          m._filename,
+          (double) 1000 * reverse_time / trials,
+          (double) 1000 * rollback_time / trials);
+
+    free(moves);
+QUIT:
+    solution_destroy(&s);
+    feasible_solution_finder_destroy(&finder);
+    model_destroy(&m);
+}
+
+void test_solution_rollback_multi(const char **datasets, int n_datasets, int trials) {
+    for (int i = 0; i < n_datasets; i++)
+        test_solution_rollback(datasets[i], trials);
+}
+
+void test_swap_predict(const char *dataset, int rounds) {
+    model m;
+    model_init(&m);
+    if (!parse_model(&m, dataset))
+        return;
+
+    feasible_solution_finder finder;
+    feasible_solution_finder_init(&finder);
+    feasible_solution_finder_config finder_conf;
+    feasible_solution_finder_config_default(&finder_conf);
+
+    rand_set_seed(1); // always the same solution
+    solution s;
+    solution_init(&s, &m);
+    if (!feasible_solution_finder_find(&finder, &finder_conf, &s)) {
+        print("%s  no feasible solution found", m._filename);
+        goto QUIT;
+    }
+
+    long moves = 0;
+    int feasible = 0;
+    long start = ms();
+
+    // Scan the whole neighbourhood as local_search does
+    for (int i = 0; i < rounds; i++) {
+        swap_iter iter;
+        swap_iter_init(&iter, &s);
+        swap_result result;
+
+        while (swap_iter_next(&iter)) {
+            swap_predict(&s, &iter.move,
+                         NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
+                         NEIGHBOURHOOD_PREDICT_COST_IF_FEASIBLE,
+                         &result);
+            feasible += result.feasible;
+            moves++;
+        }
+        swap_iter_destroy(&iter);
+    }
+
+    long elapsed = MAX(1, ms() - start);
+    print("%s  moves: %ld  feasible: %d  predict: %.2fM moves/s",
+          m._filename, moves / rounds, feasible / rounds,
+          (double) moves / elapsed / 1000);
+
+QUIT:
+    solution_destroy(&s);
+    feasible_solution_finder_destroy(&finder);
+    model_destroy(&m);
+}
+
+void test_swap_predict_multi(const char **datasets, int n_datasets, int rounds) {
+    for (int i = 0; i < n_datasets; i++)
+        test_swap_predict(datasets[i], rounds);
+}
+
+/*
+ * Throughput of swap_predict with the given strategies
+ * over the whole swap neighbourhood of a feasible solution.
+ */
+static void time_swap_predict(const char *dataset, int rounds,
+                              neighbourhood_predict_feasibility_strategy predict_feasibility,
+                              neighbourhood_predict_cost_strategy predict_cost) {
+    model m;
+    model_init(&m);
+    if (!parse_model(&m, dataset))
+        return;
+
+    feasible_solution_finder finder;
+    feasible_solution_finder_init(&finder);
+    feasible_solution_finder_config finder_conf;
+    feasible_solution_finder_config_default(&finder_conf);
+
+    rand_set_seed(1); // always the same solution
+    solution s;
+    solution_init(&s, &m);
+    if (!feasible_solution_finder_find(&finder, &finder_conf, &s)) {
+        print("%s  no feasible solution found", m._filename);
+        goto QUIT;
+    }
+
+    // Collect the neighbourhood first, for timing the checks only
+    GArray *moves = g_array_new(false, false, sizeof(swap_move));
+    swap_iter iter;
+    swap_iter_init(&iter, &s);
+    while (swap_iter_next(&iter))
+        g_array_append_val(moves, iter.move);
+    swap_iter_destroy(&iter);
+
+    const swap_move *mvs = (const swap_move *) moves->data;
+    int n_curriculas = m.curriculas_of_course_offsets[m.n_courses];
+    int feasible = 0;
+    long start = ms();
+
+    for (int i = 0; i < rounds; i++) {
+        for (int j = 0; j < moves->len; j++) {
+            swap_result result;
+            swap_predict(&s, &mvs[j], predict_feasibility, predict_cost, &result);
+            feasible += result.feasible;
+        }
+    }
+
+    long elapsed = MAX(1, ms() - start);
+    print("%s  curriculas/course: %.2f  moves: %u  feasible: %d  predict: %.2fM moves/s",
+          m._filename, (double) n_curriculas / m.n_courses,
+          moves->len, feasible / rounds, (double) moves->len * rounds / elapsed / 1000);
+
+    g_array_free(moves, true);
+
+QUIT:
+    solution_destroy(&s);
+    feasible_solution_finder_destroy(&finder);
+    model_destroy(&m);
+}
+
+/*
+ * Throughput of the hard constraints checks alone (no cost prediction).
+ */
+void test_swap_feasibility(const char *dataset, int rounds) {
+    time_swap_predict(dataset, rounds,
+                      NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS, NEIGHBOURHOOD_PREDICT_COST_NEVER);
+}
+
+void test_swap_feasibility_multi(const char **datasets, int n_datasets, int rounds) {
+    for (int i = 0; i < n_datasets; i++)
+        test_swap_feasibility(datasets[i], rounds);
+}
+
+/*
+ * Throughput of the cost prediction alone (no hard constraints checks).
+ */
+void test_swap_cost(const char *dataset, int rounds) {
+    time_swap_predict(dataset, rounds,
+                      NEIGHBOURHOOD_PREDICT_FEASIBILITY_NEVER, NEIGHBOURHOOD_PREDICT_COST_ALWAYS);
+}
+
+void test_swap_cost_multi(const char **datasets, int n_datasets, int rounds) {
+    for (int i = 0; i < n_datasets; i++)
+        test_swap_cost(datasets[i], rounds);
+}
+
+/*
+ * Memory taken by the relations between courses, curriculas and teachers:
+ * the former dense boolean tables
+ *      course_belongs_to_curricula [q,c], course_taught_by_teacher [c,t],
+ *      courses_share_curricula [c,c,q], courses_same_teacher [c,c]
+ * against the curriculas bitset (the teachers relations are now answered
+ * by teacher_of_course, which was already there).
+ */
+/*
+ * Full scan of the swap neighbourhood (as local_search does)
+ * with swap_iter_init and with swap_iter_init_pruned.
+ */
+void test_swap_iter_pruned(const char *dataset, int rounds) {
+    model m;
+    model_init(&m);
+    if (!parse_model(&m, dataset))
+        return;
+
+    feasible_solution_finder finder;
+    feasible_solution_finder_init(&finder);
+    feasible_solution_finder_config finder_conf;
+    feasible_solution_finder_config_default(&finder_conf);
+
+    rand_set_seed(1); // always the same solution
+    solution s;
+    solution_init(&s, &m);
+    if (!feasible_solution_finder_find(&finder, &finder_conf, &s)) {
+        print("%s  no feasible solution found", m._filename);
+        goto QUIT;
+    }
+
+    long moves[2] = {0, 0};
+    long duplicates[2] = {0, 0};
+    long scan_time[2];
+    int feasible[2] = {0, 0};
+
+    for (int pruned = 0; pruned <= 1; pruned++) {
+        long start = ms();
+        for (int i = 0; i < rounds; i++) {
+            swap_iter iter;
+            if (pruned)
+                swap_iter_init_pruned(&iter, &s);
+            else
+                swap_iter_init(&iter, &s);
+            swap_result result;
+
+            while (swap_iter_next(&iter)) {
+                swap_predict(&s, &iter.move,
+                             NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
+                             NEIGHBOURHOOD_PREDICT_COST_IF_FEASIBLE,
+                             &result);
+                feasible[pruned] += result.feasible;
+            }
+            moves[pruned] = iter.i;
+            duplicates[pruned] = iter.n_duplicates;
+            swap_iter_destroy(&iter);
+        }
+        scan_time[pruned] = ms() - start;
+    }
+
+    print("%s  moves: %ld -> %ld  duplicates skipped: %ld -> %ld  feasible: %d -> %d  "
+          "scan: %.2fms -> %.2fms",
+          m._filename, moves[0], moves[1], duplicates[0], duplicates[1],
+          feasible[0] / rounds, feasible[1] / rounds,
+          (double) scan_time[0] / rounds, (double) scan_time[1] / rounds);
+
+QUIT:
+    solution_destroy(&s);
+    feasible_solution_finder_destroy(&finder);
+    model_destroy(&m);
+}
+
+void test_swap_iter_pruned_multi(const char **datasets, int n_datasets, int rounds) {
+    for (int i = 0; i < n_datasets; i++)
+        test_swap_iter_pruned(datasets[i], rounds);
+}
+
+/*
+ * Full scan of the (pruned) swap neighbourhood, predicting the moves
+ * one at a time and in batches of batch_size moves, with the scalar
+ * and the vectorized kernels.
+ */
+void test_swap_predict_batch(const char *dataset, int rounds, int batch_size) {
+    model m;
+    model_init(&m);
+    if (!parse_model(&m, dataset))
+        return;
+
+    feasible_solution_finder finder;
+    feasible_solution_finder_init(&finder);
+    feasible_solution_finder_config finder_conf;
+    feasible_solution_finder_config_default(&finder_conf);
+
+    rand_set_seed(1); // always the same solution
+    solution s;
+    solution_init(&s, &m);
+    if (!feasible_solution_finder_find(&finder, &finder_conf, &s)) {
+        print("%s  no feasible solution found", m._filename);
+        goto QUIT;
+    }
+
+    long moves = 0;
+    long feasible[3] = {0, 0, 0};
+    long cost[3] = {0, 0, 0};
+    long elapsed[3];
+
+    long start = ms();
+    for (int i = 0; i < rounds; i++) {
+        swap_iter iter;
+        swap_iter_init_pruned(&iter, &s);
+        swap_result result;
+        while (swap_iter_next(&iter)) {
+            swap_predict(&s, &iter.move,
+                         NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
+                         NEIGHBOURHOOD_PREDICT_COST_IF_FEASIBLE,
+                         &result);
+            if (result.feasible) {
+                feasible[0]++;
+                cost[0] += result.delta.cost;
+            }
+        }
+        moves = iter.i;
+        swap_iter_destroy(&iter);
+    }
+    elapsed[0] = MAX(1, ms() - start);
+
+    swap_moves batch;
+    swap_moves_init(&batch, batch_size);
+    swap_results results;
+    swap_results_init(&results, batch_size);
+
+    for (int k = 1; k <= 2; k++) {
+        swap_set_vectorization(k == 2);
+        start = ms();
+        for (int i = 0; i < rounds; i++) {
+            swap_iter iter;
+            swap_iter_init_pruned(&iter, &s);
+            int n;
+            while ((n = swap_iter_next_batch(&iter, &batch)) > 0) {
+                swap_predict_batch(&s, &batch, n, &results);
+                for (int j = 0; j < n; j++) {
+                    if (results.feasible[j]) {
+                        feasible[k]++;
+                        cost[k] += results.cost[j];
+                    }
+                }
+            }
+            swap_iter_destroy(&iter);
+        }
+        elapsed[k] = MAX(1, ms() - start);
+    }
+    swap_set_vectorization(true);
+
+    swap_results_destroy(&results);
+    swap_moves_destroy(&batch);
+
+    bool match = feasible[0] == feasible[1] && cost[0] == cost[1] &&
+                 feasible[0] == feasible[2] && cost[0] == cost[2];
+    print("%s  moves: %ld  feasible: %ld%s  single: %.2fM moves/s  "
+          "batch scalar: %.2fM moves/s  batch %s: %.2fM moves/s",
+          m._filename, moves, feasible[0] / rounds, match ? "" : " (MISMATCH)",
+          (double) moves * rounds / elapsed[0] / 1000,
+          (double) moves * rounds / elapsed[1] / 1000,
+          swap_vectorization_supported() ? "avx2" : "(no avx2)",
+          (double) moves * rounds / elapsed[2] / 1000);
+
+QUIT:
+    solution_destroy(&s);
+    feasible_solution_finder_destroy(&finder);
+    model_destroy(&m);
+}
+
+void test_swap_predict_batch_multi(const char **datasets, int n_datasets, int rounds, int batch_size) {
+    for (int i = 0; i < n_datasets; i++)
+        test_swap_predict_batch(datasets[i], rounds, batch_size);
+}
+
+static bool count_feasible_visit(int thread, int block,
+                                 const swap_moves *moves, int n,
+                                 const swap_results *results, void *arg) {
+    int *feasible = arg; // [block]
+    for (int i = 0; i < n; i++)
+        feasible[block] += results->feasible[i];
+    return true;
+}
+
+/* Full scan of the (pruned) swap neighbourhood with 1 to max_threads threads. */
+void test_swap_scan(const char *dataset, int rounds, int max_threads) {
+    model m;
+    model_init(&m);
+    if (!parse_model(&m, dataset))
+        return;
+
+    feasible_solution_finder finder;
+    feasible_solution_finder_init(&finder);
+    feasible_solution_finder_config finder_conf;
+    feasible_solution_finder_config_default(&finder_conf);
+
+    rand_set_seed(1); // always the same solution
+    solution s;
+    solution_init(&s, &m);
+    if (!feasible_solution_finder_find(&finder, &finder_conf, &s)) {
+        print("%s  no feasible solution found", m._filename);
+        goto QUIT;
+    }
+
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        swap_scan scan;
+        swap_scan_init(&scan, &m, threads);
+        int *feasible = callocx(scan.n_blocks, sizeof(int));
+
+        long start = ms();
+        for (int i = 0; i < rounds; i++)
+            swap_scan_run(&scan, &s, count_feasible_visit, feasible);
+        long scan_time = ms() - start;
+
+        int n_feasible = 0;
+        for (int b = 0; b < scan.n_blocks; b++)
+            n_feasible += feasible[b];
+
+        print("%s  threads: %d  blocks: %d  moves: %d  feasible: %d  scan: %.2fms",
+              m._filename, threads, scan.n_blocks, scan.n_moves, n_feasible / rounds,
+              (double) scan_time / rounds);
+
+        free(feasible);
+        swap_scan_destroy(&scan);
+    }
+
+QUIT:
+    solution_destroy(&s);
+    feasible_solution_finder_destroy(&finder);
+    model_destroy(&m);
+}
+
+void test_swap_scan_multi(const char **datasets, int n_datasets, int rounds, int max_threads) {
+    for (int i = 0; i < n_datasets; i++)
+        test_swap_scan(datasets[i], rounds, max_threads);
+}
+
+void test_model_memory(const char *dataset) {
+    model m;
+    model_init(&m);
+    if (!parse_model(&m, dataset))
+        return;
+    MODEL(&m);
+
+    size_t dense = ((size_t) Q * C + (size_t) C * T +
+                    (size_t) C * C * Q + (size_t) C * C) * sizeof(bool);
+    size_t bitset = (size_t) C * model->curriculas_bitset_words * sizeof(uint64_t);
+
+    print("%s  C: %d  Q: %d  T: %d  dense: %zu bytes  bitset: %zu bytes  (%.0fx)",
+          m._filename, C, Q, T, dense, bitset, (double) dense / MAX(1, bitset));
+
+    model_destroy(&m);
+}
+
+void test_model_memory_multi(const char **datasets, int n_datasets) {
+    for (int i = 0; i < n_datasets; i++)
+        test_model_memory(datasets[i]);
+}
+
+/*
+ * Writes a synthetic instance with C courses to `filename` (and the timetable
+ * it has been built from to `solution_filename`, if given),
+ * with the default settings of the generator.
+ */
+static bool write_synthetic_model(const char *filename, const char *solution_filename, int C) {
+    generator_config config;
+    generator_config_default(&config);
+    config.n_courses = C;
+    config.seed = C;
+
+    return generate_instance(&config, filename, solution_filename);
+}
+
+/*
+ * Time taken for load (parse + finalize) synthetic instances
+ * of increasing size: should grow linearly with the number of courses.
+ */
+void test_model_load(int C_from, int C_to, int trials) {
+    const char *filename = "/tmp/itc2007-cct-synthetic.ctt";
+
+    for (int C = C_from; C <= C_to; C *= 2) {
+        if (!write_synthetic_model(filename, NULL, C)) {
+            eprint("failed to write '%s'", filename);
+            break;
+        }
+
+        long best = LONG_MAX;
+        for (int i = 0; i < trials; i++) {
+            model m;
+            model_init(&m);
+            long start = ms();
+            bool success = parse_model(&m, filename);
+            long elapsed = ms() - start;
+            model_destroy(&m);
+            if (!success)
+                goto QUIT;
+            best = MIN(best, elapsed);
+        }
+
+        print("C: %d  load: %ldms  (%.2fus per course)",
+              C, best, (double) best * 1000 / C);
+    }
+
+QUIT:
+    remove(filename);
+}
+
+/*
+ * Startup time: parse_model (parse + finalize) against model_cache_load.
+ */
+void test_model_cache(const char *dataset, int trials) {
+    char *cache_filename = model_cache_filename(dataset);
+
+    model m;
+    model_init(&m);
+    if (!parse_model(&m, dataset) || !model_cache_write(&m, dataset, cache_filename)) {
+        model_destroy(&m);
+        goto QUIT;
+    }
+    model_destroy(&m);
+
+    long start = clk();
+    for (int i = 0; i < trials; i++) {
+        model_init(&m);
+        parse_model(&m, dataset);
+        model_destroy(&m);
+    }
+    long parse_time = clk() - start;
+
+    start = clk();
+    for (int i = 0; i < trials; i++) {
+        model_init(&m);
+        model_cache_load(&m, dataset, cache_filename);
+        model_destroy(&m);
+    }
+    long cache_time = clk() - start;
+
+    print("%s  parse: %.1fus  cache: %.1fus  (%.0fx)",
+          dataset,
+          (double) parse_time * 1000 / trials,
+          (double) cache_time * 1000 / trials,
+          (double) parse_time / MAX(1, cache_time));
+
+QUIT:
+    remove(cache_filename);
+    free(cache_filename);
+}
+
+void test_model_cache_multi(const char **datasets, int n_datasets, int trials) {
+    for (int i = 0; i < n_datasets; i++)
+        test_model_cache(datasets[i], trials);
+}
+
+static char *count_line(char *line, void *arg) {
+    (*(long *) arg)++;
+    return NULL;
+}
+
+/*
+ * Throughput of fileparse alone (no-op callback) and of parse_model
+ * on a synthetic instance with C courses.
+ */
+void test_parse_throughput(int C, int trials) {
+    const char *filename = "/tmp/itc2007-cct-synthetic.ctt";
+
+    if (!write_synthetic_model(filename, NULL, C)) {
+        eprint("failed to write '%s'", filename);
+        return;
+    }
+
+    struct stat st;
+    stat(filename, &st);
+    double mb = (double) st.st_size / (1024 * 1024);
+
+    long lines = 0;
+    long best_fileparse = LONG_MAX, best_parse = LONG_MAX;
+    for (int i = 0; i < trials; i++) {
+        long start = clk();
+        free(fileparse(filename, NULL, count_line, &lines));
+        best_fileparse = MIN(best_fileparse, clk() - start);
+
+        model m;
+        model_init(&m);
+        start = clk();
+        parse_model(&m, filename);
+        best_parse = MIN(best_parse, clk() - start);
+        model_destroy(&m);
+    }
+
+    print("C: %d  size: %.1fMB  lines: %ld  fileparse: %.0fMB/s  parse_model: %.0fMB/s",
+          C, mb, lines / trials,
+          mb * 1000 / MAX(1, best_fileparse), mb * 1000 / MAX(1, best_parse));
+
+    remove(filename);
+}
+
+static void add_method(heuristic_solver_config *solver_conf, config *cfg, heuristic_method method) {
+    const char *name = heuristic_method_to_string(method);
+    const char *short_name = heuristic_method_to_string_short(method);
+
+    if (method == HEURISTIC_METHOD_LOCAL_SEARCH)
+        heuristic_solver_config_add_method(solver_conf, local_search, &cfg->ls, name, short_name);
+    else if (method == HEURISTIC_METHOD_HILL_CLIMBING)
+        heuristic_solver_config_add_method(solver_conf, hill_climbing, &cfg->hc, name, short_name);
+    else if (method == HEURISTIC_METHOD_TABU_SEARCH)
+        heuristic_solver_config_add_method(solver_conf, tabu_search, &cfg->ts, name, short_name);
+    else if (method == HEURISTIC_METHOD_SIMULATED_ANNEALING)
+        heuristic_solver_config_add_method(solver_conf, simulated_annealing, &cfg->sa, name, short_name);
+}
+
+/*
+ * Scaling on synthetic instances of increasing size: load time,
+ * memory (solution arena and peak RSS) and moves/s of each method,
+ * run alone for `max_time` seconds starting from the timetable
+ * the instance has been generated from (the finder may not be able
+ * to find a feasible solution of the largest ones).
+ * Note that a method checks the timeout only between its iterations:
+ * on large instances a single iteration (e.g. a full neighbourhood
+ * scan of TS) may last much more than `max_time`.
+ */
+void test_scaling(int C_from, int C_to, int max_time) {
+    const char *filename = "/tmp/itc2007-cct-synthetic.ctt";
+    const char *solution_filename = "/tmp/itc2007-cct-synthetic.ctt.sol";
+    const heuristic_method methods[] = {
+        HEURISTIC_METHOD_LOCAL_SEARCH,
+        HEURISTIC_METHOD_HILL_CLIMBING,
+        HEURISTIC_METHOD_TABU_SEARCH,
+        HEURISTIC_METHOD_SIMULATED_ANNEALING
+    };
+
+    config cfg;
+    config_init(&cfg);
+
+    for (int C = C_from; C <= C_to; C *= 2) {
+        if (!write_synthetic_model(filename, solution_filename, C)) {
+            eprint("failed to write '%s'", filename);
+            break;
+        }
+
+        model m;
+        model_init(&m);
+        long start = ms();
+        if (!parse_model(&m, filename)) {
+            model_destroy(&m);
+            break;
+        }
+        long load_time = ms() - start;
+
+        solution sol;
+        solution_init(&sol, &m);
+        if (!parse_solution(&sol, solution_filename) || !solution_satisfy_hard_constraints(&sol)) {
+            eprint("invalid synthetic solution '%s'", solution_filename);
+            solution_destroy(&sol);
+            model_destroy(&m);
+            break;
+        }
+
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+
+        print("C: %d  L: %d  R: %d  Q: %d  T: %d  load: %ldms  "
+              "solution: %.1fMB  maxrss: %.1fMB",
+              C, m.n_lectures, m.n_rooms, m.n_curriculas, m.n_teachers, load_time,
+              (double) sol._arena_size / (1024 * 1024),
+              (double) usage.ru_maxrss / 1024);
+
+        for (int i = 0; i < LENGTH(methods); i++) {
+            heuristic_solver_config solver_conf;
+            heuristic_solver_config_init(&solver_conf);
+            solver_conf.starting_solution = &sol;
+            solver_conf.max_time = max_time;
+            add_method(&solver_conf, &cfg, methods[i]);
+
+            heuristic_solver solver;
+            heuristic_solver_init(&solver);
+            heuristic_solver_stats stats;
+            heuristic_solver_stats_init(&stats);
+
+            solution result;
+            solution_init(&result, &m);
+
+            heuristic_solver_solve(&solver, &solver_conf, &cfg.finder, &result, &stats);
+            long elapsed = stats.ending_time - stats.starting_time;
+
+            print("    %s  moves: %ld  time: %ldms  (%.0f moves/s)",
+                  heuristic_method_to_string_short(methods[i]),
+                  stats.move_count, elapsed, (double) stats.move_count * 1000 / MAX(1, elapsed));
+
+            solution_destroy(&result);
+            heuristic_solver_stats_destroy(&stats);
+            heuristic_solver_destroy(&solver);
+            heuristic_solver_config_destroy(&solver_conf);
+        }
+
+        solution_destroy(&sol);
+        model_destroy(&m);
+    }
+
+    config_destroy(&cfg);
+
+    remove(filename);
+    remove(solution_filename);
+}
+
+static bool count_improving_visit(int thread, int block,
+                                  const swap_moves *moves, int n,
+                                  const swap_results *results, void *arg) {
+    int *improving = arg; // [block]
+    for (int i = 0; i < n; i++)
+        improving[block] += results->feasible[i] && results->cost[i] < 0;
+    return true;
+}
+
+/*
+ * Convergence of LS, run alone for a cycle from `rounds` initial solutions,
+ * without and with the don't look bits: time, moves performed and
+ * cost of the local minimum reached (which must have no improving move).
+ */
+void test_local_search_convergence(const char *dataset, int rounds) {
+    model m;
+    model_init(&m);
+    if (!parse_model(&m, dataset))
+        return;
+
+    feasible_solution_finder finder;
+    feasible_solution_finder_init(&finder);
+
+    config cfg;
+    config_init(&cfg);
+
+    long time[2] = {0, 0};
+    long moves[2] = {0, 0};
+    long cost[2] = {0, 0};
+    int not_minimum = 0;
+
+    for (int round = 0; round < rounds; round++) {
+        rand_set_seed(round);
+        solution sol;
+        solution_init(&sol, &m);
+        if (!feasible_solution_finder_find(&finder, &cfg.finder, &sol)) {
+            solution_destroy(&sol);
+            continue;
+        }
+
+        for (int dlb = 0; dlb <= 1; dlb++) {
+            cfg.ls.dont_look_bits = dlb;
+
+            heuristic_solver_config solver_conf;
+            heuristic_solver_config_init(&solver_conf);
+            solver_conf.starting_solution = &sol;
+            solver_conf.max_cycles = 1;
+            add_method(&solver_conf, &cfg, HEURISTIC_METHOD_LOCAL_SEARCH);
+
+            heuristic_solver solver;
+            heuristic_solver_init(&solver);
+            heuristic_solver_stats stats;
+            heuristic_solver_stats_init(&stats);
+
+            solution result;
+            solution_init(&result, &m);
+
+            heuristic_solver_solve(&solver, &solver_conf, &cfg.finder, &result, &stats);
+            time[dlb] += stats.ending_time - stats.starting_time;
+            moves[dlb] += stats.move_count;
+            cost[dlb] += solution_cost(&result);
+
+            swap_scan scan;
+            swap_scan_init(&scan, &m, 1);
+            int improving = 0;
+            swap_scan_run(&scan, &result, count_improving_visit, &improving);
+            not_minimum += improving > 0;
+            swap_scan_destroy(&scan);
+
+            solution_destroy(&result);
+            heuristic_solver_stats_destroy(&stats);
+            heuristic_solver_destroy(&solver);
+            heuristic_solver_config_destroy(&solver_conf);
+        }
+
+        solution_destroy(&sol);
+    }
+
+    print("%s  time: %.1fms -> %.1fms  moves: %.1f -> %.1f  cost: %.1f -> %.1f%s",
+          m._filename, (double) time[0] / rounds, (double) time[1] / rounds,
+          (double) moves[0] / rounds, (double) moves[1] / rounds,
+          (double) cost[0] / rounds, (double) cost[1] / rounds,
+          not_minimum ? "  (NOT A LOCAL MINIMUM)" : "");
+
+    config_destroy(&cfg);
+    feasible_solution_finder_destroy(&finder);
+    model_destroy(&m);
+}
+
+void test_local_search_convergence_multi(const char **datasets, int n_datasets, int rounds) {
+    for (int i = 0; i < n_datasets; i++)
+        test_local_search_convergence(datasets[i], rounds);
+}
+
+/*
+ * Random feasible moves as drawn by SA and HC: draws per feasible sample
+ * and samples per second of the rejection loop over all the moves
+ * (swap_move_generate_random_feasible_effective) and of swap_sampler,
+ * performing the sampled moves that don't worsen the cost (as HC).
+ */
+void test_swap_sampler(const char *dataset, int samples) {
+    model m;
+    model_init(&m);
+    if (!parse_model(&m, dataset))
+        return;
+
+    feasible_solution_finder finder;
+    feasible_solution_finder_init(&finder);
+
+    config cfg;
+    config_init(&cfg);
+
+    solution sol;
+    solution_init(&sol, &m);
+    if (!feasible_solution_finder_find(&finder, &cfg.finder, &sol)) {
+        print("%s  no feasible solution found", m._filename);
+        goto QUIT;
+    }
+
+    long draws[2] = {0, 0};
+    long time[2];
+
+    for (int sampled = 0; sampled <= 1; sampled++) {
+        solution s;
+        solution_init(&s, &m);
+        solution_copy(&s, &sol);
+        rand_set_seed(0);
+
+        swap_sampler sampler;
+        swap_sampler_init(&sampler, &s);
+
+        long start = ms();
+        for (int i = 0; i < samples; i++) {
+            swap_move mv;
+            swap_result result = {.feasible = false};
+
+            if (sampled) {
+                swap_sampler_sample(&sampler, &s, &mv, &result);
+            } else {
+                // As swap_move_generate_random_feasible_effective, counting the draws
+                do {
+                    draws[0]++;
+                    swap_move_generate_random_raw(&s, &mv);
+                    if (!swap_move_is_effective(&mv) || swap_move_is_symmetric(&s, &mv))
+                        continue;
+                    swap_predict(&s, &mv,
+                                 NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
+                                 NEIGHBOURHOOD_PREDICT_COST_IF_FEASIBLE,
+                                 &result);
+                } while (!result.feasible);
+            }
+
+            if (result.delta.cost <= 0) {
+                swap_perform(&s, &mv, NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
+                if (sampled)
+                    swap_sampler_update(&sampler, &s, &mv);
+            }
+        }
+        time[sampled] = ms() - start;
+        if (sampled)
+            draws[1] = sampler.n_draws;
+
+        swap_sampler_destroy(&sampler);
+        solution_destroy(&s);
+    }
+
+    print("%s  draws/sample: %.2f -> %.2f  samples/s: %.0f -> %.0f",
+          m._filename,
+          (double) draws[0] / samples, (double) draws[1] / samples,
+          1000.0 * samples / MAX(time[0], 1), 1000.0 * samples / MAX(time[1], 1));
+
+QUIT:
+    solution_destroy(&sol);
+    config_destroy(&cfg);
+    feasible_solution_finder_destroy(&finder);
+    model_destroy(&m);
+}
+
+void test_swap_sampler_multi(const char **datasets, int n_datasets, int samples) {
+    for (int i = 0; i < n_datasets; i++)
+        test_swap_sampler(datasets[i], samples);
+}
+
+/*
+ * Symmetry reduction of the swap neighbourhood: moves enumerated without
+ * and with the symmetric ones (see swap_move_is_symmetric), time of a full
+ * scan of the neighbourhood in both cases (i.e. of an iteration of TS)
+ * and moves/s of LS and TS, run alone for `max_time` seconds.
+ */
+void test_symmetries(const char *dataset, int rounds, int max_time) {
+    model m;
+    model_init(&m);
+    if (!parse_model(&m, dataset))
+        return;
+    MODEL(&m);
+
+    feasible_solution_finder finder;
+    feasible_solution_finder_init(&finder);
+    feasible_solution_finder_config finder_conf;
+    feasible_solution_finder_config_default(&finder_conf);
+
+    rand_set_seed(1); // always the same solution
+    solution sol;
+    solution_init(&sol, &m);
+    if (!feasible_solution_finder_find(&finder, &finder_conf, &sol)) {
+        print("%s  no feasible solution found", m._filename);
+        goto QUIT;
+    }
+
+    swap_result result;
+    long all_moves = 0, moves = 0;
+
+    // Full scan, symmetric moves included
+    long start = ms();
+    for (int i = 0; i < rounds; i++) {
+        all_moves = 0;
+        swap_move mv;
+        for (mv.l1 = 0; mv.l1 < L; mv.l1++) {
+            for (mv.r2 = 0; mv.r2 < R; mv.r2++) {
+                for (mv.d2 = 0; mv.d2 < D; mv.d2++) {
+                    for (mv.s2 = 0; mv.s2 < S; mv.s2++) {
+                        swap_move_compute_helper(&sol, &mv);
+                        if (mv.helper.c1 <= mv.helper.c2)
+                            continue;
+                        swap_predict(&sol, &mv,
+                                     NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
+                                     NEIGHBOURHOOD_PREDICT_COST_IF_FEASIBLE,
+                                     &result);
+                        all_moves++;
+                    }
+                }
+            }
+        }
+    }
+    long all_scan_time = ms() - start;
+
+    // Full scan as swap_iter does
+    start = ms();
+    for (int i = 0; i < rounds; i++) {
+        swap_iter iter;
+        swap_iter_init(&iter, &sol);
+        while (swap_iter_next(&iter))
+            swap_predict(&sol, &iter.move,
+                         NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
+                         NEIGHBOURHOOD_PREDICT_COST_IF_FEASIBLE,
+                         &result);
+        moves = iter.i;
+        swap_iter_destroy(&iter);
+    }
+    long scan_time = ms() - start;
+
+    print("%s  rooms: %d (%d classes)  courses: %d (%d classes)  "
+          "moves: %ld -> %ld (-%.1f%%)  scan: %.2fms -> %.2fms",
+          m._filename, R, m.n_room_classes, C, m.n_course_classes,
+          all_moves, moves, 100.0 * (all_moves - moves) / MAX(1, all_moves),
+          (double) all_scan_time / rounds, (double) scan_time / rounds);
+
+    config cfg;
+    config_init(&cfg);
+    const heuristic_method methods[] = {
+        HEURISTIC_METHOD_LOCAL_SEARCH,
+        HEURISTIC_METHOD_TABU_SEARCH
+    };
+
+    for (int i = 0; i < LENGTH(methods); i++) {
+        heuristic_solver_config solver_conf;
+        heuristic_solver_config_init(&solver_conf);
+        solver_conf.starting_solution = &sol;
+        solver_conf.max_time = max_time;
+        add_method(&solver_conf, &cfg, methods[i]);
+
+        heuristic_solver solver;
+        heuristic_solver_init(&solver);
+        heuristic_solver_stats stats;
+        heuristic_solver_stats_init(&stats);
+
+        solution out;
+        solution_init(&out, &m);
+        heuristic_solver_solve(&solver, &solver_conf, &cfg.finder, &out, &stats);
+        long elapsed = stats.ending_time - stats.starting_time;
+
+        print("    %s  moves: %ld  (%.0f moves/s)",
+              heuristic_method_to_string_short(methods[i]),
+              stats.move_count, (double) stats.move_count * 1000 / MAX(1, elapsed));
+        timeout = 0; // otherwise the finder of the next dataset gives up immediately
+
+        solution_destroy(&out);
+        heuristic_solver_stats_destroy(&stats);
+        heuristic_solver_destroy(&solver);
+        heuristic_solver_config_destroy(&solver_conf);
+    }
+
+    config_destroy(&cfg);
+
+QUIT:
+    solution_destroy(&sol);
+    feasible_solution_finder_destroy(&finder);
+    model_destroy(&m);
+}
+
+void test_symmetries_multi(const char **datasets, int n_datasets, int rounds, int max_time) {
+    for (int i = 0; i < n_datasets; i++)
+        test_symmetries(datasets[i], rounds, max_time);
+}
+
+/*
+ * Independent components of the conflict graph of the courses
+ * and whether the model can be decomposed into `threads` parts.
+ */
+void test_components(const char *dataset, int threads) {
+    model m;
+    model_init(&m);
+    parse_model(&m, dataset);
+
+    int *component_of_course = mallocx(m.n_courses, sizeof(int));
+    int K = model_course_components(&m, component_of_course);
+
+    decomposition dec;
+    bool decomposed = decomposition_init(&dec, &m, threads);
+    print("%s  components: %d  parts: %d", dataset, K, decomposed ? dec.n_parts : 1);
+    if (decomposed)
+        decomposition_destroy(&dec);
+
+    free(component_of_course);
+    model_destroy(&m);
+}
+
+void test_components_multi(const char **datasets, int n_datasets, int threads) {
+    for (int i = 0; i < n_datasets; i++)
+        test_components(datasets[i], threads);
+}
+
+/*
+ * Synthetic instance of C courses made of many departments (few curriculas
+ * per course and one course per teacher) solved with SA+LS for `max_time`
+ * seconds, as a whole and decomposed into `threads` parts.
+ */
+void test_decomposition(int C, int threads, int max_time) {
+    const char *filename = "/tmp/itc2007-cct-synthetic.ctt";
+
+    generator_config gen;
+    generator_config_default(&gen);
+    gen.n_courses = C;
+    gen.curricula_density = 0.3;
+    gen.teacher_load = 1;
+    gen.seed = C;
+    if (!generate_instance(&gen, filename, NULL)) {
+        eprint("failed to write '%s'", filename);
+        return;
+    }
+
+    model m;
+    model_init(&m);
+    if (!parse_model(&m, filename)) {
+        model_destroy(&m);
+        return;
+    }
+
+    int *component_of_course = mallocx(m.n_courses, sizeof(int));
+    print("C: %d  L: %d  R: %d  components: %d",
+          C, m.n_lectures, m.n_rooms, model_course_components(&m, component_of_course));
+    free(component_of_course);
+
+    config cfg;
+    config_init(&cfg);
+
+    for (int decomposed = 0; decomposed <= 1; decomposed++) {
+        heuristic_solver_config solver_conf;
+        heuristic_solver_config_init(&solver_conf);
+        solver_conf.max_time = max_time;
+        solver_conf.decomposition = decomposed;
+        solver_conf.threads = threads;
+        add_method(&solver_conf, &cfg, HEURISTIC_METHOD_SIMULATED_ANNEALING);
+        add_method(&solver_conf, &cfg, HEURISTIC_METHOD_LOCAL_SEARCH);
+
+        heuristic_solver solver;
+        heuristic_solver_init(&solver);
+        heuristic_solver_stats stats;
+        heuristic_solver_stats_init(&stats);
+
+        solution sol;
+        solution_init(&sol, &m);
+
+        heuristic_solver_solve(&solver, &solver_conf, &cfg.finder, &sol, &stats);
+        long elapsed = stats.ending_time - stats.starting_time;
+
+        print("    %s  feasible: %d  cost: %d  moves: %ld  time: %ldms",
+              decomposed ? "decomposed" : "whole     ",
+              solution_satisfy_hard_constraints(&sol), solution_cost(&sol),
+              stats.move_count, elapsed);
+
+        solution_destroy(&sol);
+        heuristic_solver_stats_destroy(&stats);
+        heuristic_solver_destroy(&solver);
+        heuristic_solver_config_destroy(&solver_conf);
+    }
+
+    config_destroy(&cfg);
+    model_destroy(&m);
+
+    remove(filename);
+}
+
 void tests() {
     test_finder_single("datasets/comp03.ctt", 0.33, 0.33, 0.00, 100);
 //    test_finder_multi(DATASETS, 0.20, 0.60, 0.02, 1000);
+//    test_solution_copy_multi(DATASETS, LENGTH(DATASETS), 100000);
+//    test_solution_rollback_multi(DATASETS, LENGTH(DATASETS), 1000000);
+//    test_swap_predict_multi(DATASETS, LENGTH(DATASETS), 200);
+//    test_swap_feasibility_multi(DATASETS, LENGTH(DATASETS), 200);
+//    test_swap_cost_multi(DATASETS, LENGTH(DATASETS), 200);
+//    test_swap_iter_pruned_multi(DATASETS, LENGTH(DATASETS), 200);
+//    test_swap_predict_batch_multi(DATASETS, LENGTH(DATASETS), 200, 256);
+//    test_swap_scan_multi(DATASETS, LENGTH(DATASETS), 200, 8);
+//    test_local_search_convergence_multi(DATASETS, LENGTH(DATASETS), 10);
+//    test_swap_sampler_multi(DATASETS, LENGTH(DATASETS), 1000000);
+//    test_model_memory_multi(DATASETS, LENGTH(DATASETS));
+//    test_model_load(1000, 64000, 3);
+//    test_model_cache_multi(DATASETS, LENGTH(DATASETS), 1000);
+//    test_parse_throughput(64000, 5);
+//    test_scaling(250, 2000, 1);
+//    test_symmetries_multi(DATASETS, LENGTH(DATASETS), 10, 1);
+//    test_components_multi(DATASETS, LENGTH(DATASETS), 4);
+//    test_decomposition(1000, 4, 10);
 }
 
 int main(int argc, char **argv) {
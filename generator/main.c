@@ -0,0 +1,172 @@
+/*
+ * Generator of synthetic instances of the Curriculum-Based Course
+ * Timetabling Problem of ITC 2007 (see src/generator/generator.h).
+ */
+
+#include <stdlib.h>
+#include <argp.h>
+#include "generator/generator.h"
+#include "utils/io_utils.h"
+#include "utils/str_utils.h"
+
+static const char *argp_args_doc = "OUTPUT";
+static const char *argp_doc =
+    "Generator of synthetic instances of the Curriculum-Based Course Timetabling Problem of ITC 2007"
+    "\v"
+    "The generated instances are always feasible: a timetable that satisfies all "
+    "the hard constraints is built first, and the instance is derived from it.\n"
+    "The timetable itself can be written as a solution of the instance with -x FILE.";
+
+typedef enum generator_option {
+    OPTION_COURSES = 'c',
+    OPTION_ROOMS = 'r',
+    OPTION_DAYS = 'd',
+    OPTION_SLOTS = 'p',
+    OPTION_MIN_LECTURES = 'l',
+    OPTION_MAX_LECTURES = 'L',
+    OPTION_OCCUPANCY = 'o',
+    OPTION_CURRICULA_DENSITY = 'q',
+    OPTION_MIN_CURRICULUM_SIZE = 'k',
+    OPTION_MAX_CURRICULUM_SIZE = 'K',
+    OPTION_TEACHER_LOAD = 't',
+    OPTION_UNAVAILABILITY_RATIO = 'u',
+    OPTION_SEED = 's',
+    OPTION_SOLUTION = 'x'
+} generator_option;
+
+static struct argp_option options[] = {
+  { "courses", OPTION_COURSES, "N", 0,
+        "Number of courses (default: 100)" },
+  { "rooms", OPTION_ROOMS, "N", 0,
+        "Number of rooms (default: derived from --occupancy)" },
+  { "days", OPTION_DAYS, "N", 0,
+        "Number of days (default: 5)" },
+  { "slots", OPTION_SLOTS, "N", 0,
+        "Number of periods per day (default: 6)" },
+  { "min-lectures", OPTION_MIN_LECTURES, "N", 0,
+        "Minimum number of lectures of a course (default: 1)" },
+  { "max-lectures", OPTION_MAX_LECTURES, "N", 0,
+        "Maximum number of lectures of a course (default: 6)" },
+  { "occupancy", OPTION_OCCUPANCY, "RATIO", 0,
+        "Fraction of the room-periods occupied by the lectures, "
+        "used for derive the number of rooms (default: 0.7)" },
+  { "curricula-density", OPTION_CURRICULA_DENSITY, "N", 0,
+        "Average number of curricula each course belongs to (default: 1.5)" },
+  { "min-curriculum-size", OPTION_MIN_CURRICULUM_SIZE, "N", 0,
+        "Minimum number of courses of a curriculum (default: 3)" },
+  { "max-curriculum-size", OPTION_MAX_CURRICULUM_SIZE, "N", 0,
+        "Maximum number of courses of a curriculum (default: 8)" },
+  { "teacher-load", OPTION_TEACHER_LOAD, "N", 0,
+        "Average number of courses per teacher (default: 1.5)" },
+  { "unavailability", OPTION_UNAVAILABILITY_RATIO, "RATIO", 0,
+        "Fraction of the periods unavailable for each course (default: 0.1)" },
+  { "seed", OPTION_SEED, "N", 0,
+        "Seed to use for random number generator (default: 0)" },
+  { "solution", OPTION_SOLUTION, "FILE", 0,
+        "Write the timetable the instance has been built from to FILE" },
+  { NULL }
+};
+
+typedef struct generator_args {
+    generator_config config;
+    const char *output_file;
+    const char *solution_file;
+    bool error;
+} generator_args;
+
+static error_t parse_option(int key, char *arg, struct argp_state *state) {
+    generator_args *args = state->input;
+    generator_config *config = &args->config;
+
+#define PARSE_X(converter, str, var) do { \
+    if (!converter(str, var)) { \
+        eprint("ERROR: conversion failed ('%s')", str); \
+        args->error = true; \
+        return EINVAL; \
+    } \
+} while(0)
+
+#define PARSE_INT(str, var) PARSE_X(strtoint, str, var)
+#define PARSE_UINT(str, var) PARSE_X(strtouint, str, var)
+#define PARSE_DOUBLE(str, var) PARSE_X(strtodouble, str, var)
+
+    switch (key) {
+    case OPTION_COURSES:
+        PARSE_INT(arg, &config->n_courses);
+        break;
+    case OPTION_ROOMS:
+        PARSE_INT(arg, &config->n_rooms);
+        break;
+    case OPTION_DAYS:
+        PARSE_INT(arg, &config->n_days);
+        break;
+    case OPTION_SLOTS:
+        PARSE_INT(arg, &config->n_slots);
+        break;
+    case OPTION_MIN_LECTURES:
+        PARSE_INT(arg, &config->min_lectures);
+        break;
+    case OPTION_MAX_LECTURES:
+        PARSE_INT(arg, &config->max_lectures);
+        break;
+    case OPTION_OCCUPANCY:
+        PARSE_DOUBLE(arg, &config->occupancy);
+        break;
+    case OPTION_CURRICULA_DENSITY:
+        PARSE_DOUBLE(arg, &config->curricula_density);
+        break;
+    case OPTION_MIN_CURRICULUM_SIZE:
+        PARSE_INT(arg, &config->min_curriculum_size);
+        break;
+    case OPTION_MAX_CURRICULUM_SIZE:
+        PARSE_INT(arg, &config->max_curriculum_size);
+        break;
+    case OPTION_TEACHER_LOAD:
+        PARSE_DOUBLE(arg, &config->teacher_load);
+        break;
+    case OPTION_UNAVAILABILITY_RATIO:
+        PARSE_DOUBLE(arg, &config->unavailability_ratio);
+        break;
+    case OPTION_SEED:
+        PARSE_UINT(arg, &config->seed);
+        break;
+    case OPTION_SOLUTION:
+        args->solution_file = arg;
+        break;
+    case ARGP_KEY_ARG:
+        if (state->arg_num > 0) {
+            eprint("ERROR: Unexpected argument '%s'", arg);
+            argp_usage(state);
+        }
+        args->output_file = arg;
+        break;
+    case ARGP_KEY_END:
+        if (state->arg_num < 1)
+            argp_usage(state);
+        break;
+    default:
+        return ARGP_ERR_UNKNOWN;
+    }
+
+#undef PARSE_X
+#undef PARSE_INT
+#undef PARSE_UINT
+#undef PARSE_DOUBLE
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    generator_args args = {0};
+    generator_config_default(&args.config);
+
+    struct argp argp = {options, parse_option, argp_args_doc, argp_doc};
+    argp_parse(&argp, argc, argv, 0, 0, &args);
+    if (args.error)
+        exit(EXIT_FAILURE);
+
+    if (!generate_instance(&args.config, args.output_file, args.solution_file))
+        exit(EXIT_FAILURE);
+
+    return 0;
+}
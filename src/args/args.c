@@ -18,7 +18,8 @@ char *args_to_string(const args *args) {
         "print_violations = %s\n"
         "draw_all_directory = %s\n"
         "draw_overview_file = %s\n"
-        "input_solution = %s",
+        "input_solution = %s\n"
+        "model_cache = %s",
         args->input_file,
         args->output_file,
         args->verbosity,
@@ -33,7 +34,8 @@ char *args_to_string(const args *args) {
         booltostr(args->print_violations),
         args->draw_all_directory,
         args->draw_overview_file,
-        args->solution_input_file
+        args->solution_input_file,
+        booltostr(args->model_cache)
     );
 
     free(options_str);
@@ -58,6 +60,7 @@ void args_init(args *args) {
     args->draw_all_directory = NULL;
     args->draw_overview_file = NULL;
     args->solution_input_file = NULL;
+    args->model_cache = false;
 }
 
 void args_destroy(args *args) {
@@ -26,6 +26,7 @@ typedef struct args {
     char *draw_all_directory;
     char *draw_overview_file;
     char *solution_input_file;
+    bool model_cache;
 } args;
 
 void args_init(args *args);
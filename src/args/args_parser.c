@@ -40,6 +40,20 @@ static const char *argp_doc =
     "# (does nothing if multistart is true).\n"
     "solver.restore_best_after_cycles=50\n"
     "\n"
+    "# Keep track of the best solution storing only its assignments\n"
+    "# instead of copying the whole solution each time it improves.\n"
+    "solver.best_snapshot=true\n"
+    "\n"
+    "# Split the instance into independent parts (courses sharing\n"
+    "# no curricula and no teachers), each with its own share of the rooms,\n"
+    "# and solve them concurrently for half of the time limit, then improve\n"
+    "# the merged solution as a whole; instances that can't be split\n"
+    "# are solved as a whole.\n"
+    "solver.decomposition=false\n"
+    "\n"
+    "# Maximum number of threads (0 for as many as the cores).\n"
+    "solver.threads=0\n"
+    "\n"
     "FINDER\n"
     "\n"
     "# Randomness of the initial feasible solution.\n"
@@ -78,6 +92,16 @@ static const char *argp_doc =
     "# ls.max_distance_from_best_ratio times the best solution cost.\n"
     "ls.max_distance_from_best_ratio=-1\n"
     "\n"
+    "# Number of threads scanning the neighbourhood (0 for as many as the cores);\n"
+    "# the result does not depend on it.\n"
+    "ls.threads=1\n"
+    "\n"
+    "# Scan only the courses whose moves might have changed since their last\n"
+    "# scan (don't look bits), resuming from the course of the last move;\n"
+    "# the local minimum is confirmed by a scan of the whole neighbourhood.\n"
+    "# Faster, but the local minimum reached is often worse.\n"
+    "ls.dont_look_bits=false\n"
+    "\n"
     "HILL CLIMBING\n"
     "\n"
     "# Maximum non-improving iterations number.\n"
@@ -113,6 +137,10 @@ static const char *argp_doc =
     "# equal or less ts.near_best_ratio times the best solution cost.\n"
     "ts.near_best_ratio=1.02\n"
     "\n"
+    "# Number of threads scanning the neighbourhood (0 for as many as the cores);\n"
+    "# the result does not depend on it.\n"
+    "ts.threads=1\n"
+    "\n"
     "DEEP LOCAL SARCH\n"
     "\n"
     "# Do nothing if the current solution has cost greater than\n"
@@ -134,7 +162,8 @@ typedef enum itc2007_option {
     OPTION_INPUT_SOLUTION = 'i',
     OPTION_INPUT_SOLUTION_VALIDATE = 'I',
     OPTION_DRAW_ALL_DIRECTORY = 'D',
-    OPTION_DRAW_OVERVIEW_FILE = 'd'
+    OPTION_DRAW_OVERVIEW_FILE = 'd',
+    OPTION_MODEL_CACHE = 'm'
 } itc2007_option;
 
 static struct argp_option options[] = {
@@ -176,6 +205,9 @@ static struct argp_option options[] = {
   { "validate", OPTION_INPUT_SOLUTION_VALIDATE, "FILE", 0,
         "Print only the costs and the violations of a solution in FILE (as a validator).\n"
         "Alias for -0VVqi FILE."},
+  { "model-cache", OPTION_MODEL_CACHE, NULL, 0,
+        "Load the model from its binary cache INPUTb (e.g. comp01.cttb) instead of parsing INPUT; "
+        "the cache is (re)built if it does not exist or INPUT has changed since then" },
   { NULL }
 };
 
@@ -247,6 +279,9 @@ static error_t parse_option(int key, char *arg, struct argp_state *state) {
     case OPTION_INPUT_SOLUTION:
         args->solution_input_file = arg;
         break;
+    case OPTION_MODEL_CACHE:
+        args->model_cache = true;
+        break;
     case OPTION_INPUT_SOLUTION_VALIDATE:
         // Alias for -0VVqi
         parse_option(OPTION_DONT_SOLVE, NULL, state);
@@ -18,8 +18,13 @@ char *config_to_string(const config *cfg) {
         "solver.max_cycles = %d\n"
         "solver.multistart = %s\n"
         "solver.restore_best_after_cycles = %d\n"
+        "solver.best_snapshot = %s\n"
+        "solver.decomposition = %s\n"
+        "solver.threads = %d\n"
         "finder.ranking_randomness = %.4f\n"
         "ls.max_distance_from_best_ratio = %.4f\n"
+        "ls.threads = %d\n"
+        "ls.dont_look_bits = %s\n"
         "hc.max_idle = %ld\n"
         "hc.max_idle_near_best_coeff = %.4f\n"
         "hc.near_best_ratio = %.4f\n"
@@ -28,6 +33,7 @@ char *config_to_string(const config *cfg) {
         "ts.near_best_ratio = %.4f\n"
         "ts.tabu_tenure = %d\n"
         "ts.frequency_penalty_coeff = %.4f\n"
+        "ts.threads = %d\n"
         "sa.initial_temperature = %.5f\n"
         "sa.cooling_rate = %.5f\n"
         "sa.temperature_length_coeff = %.5f\n"
@@ -41,10 +47,15 @@ char *config_to_string(const config *cfg) {
         cfg->solver.max_cycles,
         booltostr(cfg->solver.multistart),
         cfg->solver.restore_best_after_cycles,
+        booltostr(cfg->solver.best_snapshot),
+        booltostr(cfg->solver.decomposition),
+        cfg->solver.threads,
         // ---
         cfg->finder.ranking_randomness,
         // ---
         cfg->ls.max_distance_from_best_ratio,
+        cfg->ls.threads,
+        booltostr(cfg->ls.dont_look_bits),
         // ---
         cfg->hc.max_idle,
         cfg->hc.max_idle_near_best_coeff,
@@ -55,6 +66,7 @@ char *config_to_string(const config *cfg) {
         cfg->ts.near_best_ratio,
         cfg->ts.tabu_tenure,
         cfg->ts.frequency_penalty_coeff,
+        cfg->ts.threads,
         // ---
         cfg->sa.initial_temperature,
         cfg->sa.cooling_rate,
@@ -78,6 +90,9 @@ void config_init(config *cfg) {
     cfg->solver.max_cycles = -1;
     cfg->solver.multistart = false;
     cfg->solver.restore_best_after_cycles = 50;
+    cfg->solver.best_snapshot = true;
+    cfg->solver.decomposition = false;
+    cfg->solver.threads = 0;
 
     feasible_solution_finder_config_default(&cfg->finder);
     local_search_params_default(&cfg->ls);
@@ -20,6 +20,9 @@ typedef struct config {
         int max_cycles;
         bool multistart;
         int restore_best_after_cycles;
+        bool best_snapshot;
+        bool decomposition;
+        int threads;
     } solver;
     feasible_solution_finder_config finder;
     deep_local_search_params dls;
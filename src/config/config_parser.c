@@ -100,12 +100,22 @@ static char * config_parser_key_value_handler(config *cfg, char *key, char *valu
         return PARSE_BOOL(value, &cfg->solver.multistart);
     if (streq(key, "solver.restore_best_after_cycles"))
         return PARSE_INT(value, &cfg->solver.restore_best_after_cycles);
+    if (streq(key, "solver.best_snapshot"))
+        return PARSE_BOOL(value, &cfg->solver.best_snapshot);
+    if (streq(key, "solver.decomposition"))
+        return PARSE_BOOL(value, &cfg->solver.decomposition);
+    if (streq(key, "solver.threads"))
+        return PARSE_INT(value, &cfg->solver.threads);
 
     if (streq(key, "finder.ranking_randomness"))
         return PARSE_DOUBLE(value, &cfg->finder.ranking_randomness);
 
     if (streq(key, "ls.max_distance_from_best_ratio"))
         return PARSE_DOUBLE(value, &cfg->ls.max_distance_from_best_ratio);
+    if (streq(key, "ls.threads"))
+        return PARSE_INT(value, &cfg->ls.threads);
+    if (streq(key, "ls.dont_look_bits"))
+        return PARSE_BOOL(value, &cfg->ls.dont_look_bits);
 
     if (streq(key, "hc.max_idle"))
         return PARSE_LONG(value, &cfg->hc.max_idle);
@@ -124,6 +134,8 @@ static char * config_parser_key_value_handler(config *cfg, char *key, char *valu
         return PARSE_INT(value, &cfg->ts.tabu_tenure);
     if (streq(key, "ts.frequency_penalty_coeff"))
         return PARSE_DOUBLE(value, &cfg->ts.frequency_penalty_coeff);
+    if (streq(key, "ts.threads"))
+        return PARSE_INT(value, &cfg->ts.threads);
 
     if (streq(key, "sa.initial_temperature"))
         return PARSE_DOUBLE(value, &cfg->sa.initial_temperature);
@@ -154,33 +166,28 @@ static char * config_parser_key_value_handler(config *cfg, char *key, char *valu
 };
 
 
-static char * config_parser_line_handler(const char *line, void *arg) {
+static char * config_parser_line_handler(char *line, void *arg) {
     config *cfg = (config *) arg;
 
     char *fields[2];
-    char *error = NULL;
-    char *line_copy = strdup(line);
 
-    if (strsplit(line_copy, "=", fields, 2) != 2) {
+    if (strsplit(line, "=", fields, 2) != 2) {
         print("WARN: invalid line syntax, skipping '%s'", line);
-        goto QUIT;
+        return NULL;
     }
 
     char *key = strtrim(fields[0]);
     char *value = strtrim_chars(fields[1], "\" ");
 
-    error = config_parser_key_value_handler(cfg, key, value);
-
-QUIT:
-    free(line_copy);
-
-    return error;
+    return config_parser_key_value_handler(cfg, key, value);
 }
 
 
 bool config_parser_add_option(config_parser *parser, config *config, const char *option) {
     debug("Adding option to config: %s", option);
-    parser->error = config_parser_line_handler(option, config);
+    char *option_copy = strdup(option);
+    parser->error = config_parser_line_handler(option_copy, config);
+    free(option_copy);
     return strempty(parser->error);
 }
 
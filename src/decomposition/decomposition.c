@@ -0,0 +1,563 @@
+#include "decomposition.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "log/verbose.h"
+#include "utils/mem_utils.h"
+#include "utils/str_utils.h"
+#include "utils/rand_utils.h"
+#include "utils/time_utils.h"
+#include "timeout/timeout.h"
+
+static int union_find_root(int *parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+static void union_find_union(int *parent, int x, int y) {
+    x = union_find_root(parent, x);
+    y = union_find_root(parent, y);
+    // The lower index is the root, so that roots come in order of first course
+    if (x < y)
+        parent[y] = x;
+    else if (y < x)
+        parent[x] = y;
+}
+
+int model_course_components(const model *model, int *component_of_course) {
+    const int C = model->n_courses;
+    const int Q = model->n_curriculas;
+    const int T = model->n_teachers;
+
+    int *parent = mallocx(C, sizeof(int));
+    for (int c = 0; c < C; c++)
+        parent[c] = c;
+
+    for (int q = 0; q < Q; q++) {
+        int n_courses;
+        const int *courses = model_courses_of_curricula(model, q, &n_courses);
+        for (int i = 1; i < n_courses; i++)
+            union_find_union(parent, courses[0], courses[i]);
+    }
+
+    for (int t = 0; t < T; t++) {
+        int n_courses;
+        const int *courses = model_courses_of_teacher(model, t, &n_courses);
+        for (int i = 1; i < n_courses; i++)
+            union_find_union(parent, courses[0], courses[i]);
+    }
+
+    int K = 0;
+    for (int c = 0; c < C; c++) {
+        int root = union_find_root(parent, c);
+        // The root is the first course of its component
+        component_of_course[c] = root == c ? K++ : component_of_course[root];
+    }
+
+    free(parent);
+
+    return K;
+}
+
+/* Group the components into the parts, largest (by lectures) first,
+ * each one to the part with the fewest lectures so far */
+static void decomposition_group_components(decomposition *dec,
+                                           const int *lectures_of_component,
+                                           int *lectures_of_part) {
+    const int K = dec->n_components;
+    int *components = mallocx(K, sizeof(int));
+    int *part_of_component = mallocx(K, sizeof(int));
+
+    for (int k = 0; k < K; k++)
+        components[k] = k;
+    // Insertion sort by lectures (desc), stable
+    for (int i = 1; i < K; i++) {
+        int k = components[i];
+        int j = i - 1;
+        for (; j >= 0 && lectures_of_component[components[j]] < lectures_of_component[k]; j--)
+            components[j + 1] = components[j];
+        components[j + 1] = k;
+    }
+
+    for (int i = 0; i < K; i++) {
+        int k = components[i];
+        int best_p = 0;
+        for (int p = 1; p < dec->n_parts; p++)
+            if (lectures_of_part[p] < lectures_of_part[best_p])
+                best_p = p;
+        part_of_component[k] = best_p;
+        lectures_of_part[best_p] += lectures_of_component[k];
+    }
+
+    for (int c = 0; c < dec->model->n_courses; c++)
+        dec->part_of_course[c] = part_of_component[dec->component_of_course[c]];
+
+    free(part_of_component);
+    free(components);
+}
+
+typedef struct room_capacity {
+    int capacity;
+    int r;
+} room_capacity;
+
+static int room_capacity_compare_desc(const void *a, const void *b) {
+    const room_capacity *rc1 = a, *rc2 = b;
+    if (rc1->capacity != rc2->capacity)
+        return rc2->capacity - rc1->capacity;
+    return rc1->r - rc2->r;
+}
+
+static int int_compare_desc(const void *a, const void *b) {
+    return *(const int *) b - *(const int *) a;
+}
+
+/*
+ * Partition the rooms among the parts: the number of rooms of each part is
+ * proportional to its lectures (highest averages method), and the rooms are
+ * dealt from the largest, each to the part that needs the largest room for
+ * its next one, i.e. the part whose lectures at the rank served by its next
+ * room (with its lectures sorted by students) have the most students
+ */
+static void decomposition_partition_rooms(decomposition *dec,
+                                          const int *lectures_of_part,
+                                          int *rooms_of_part) {
+    const model *model = dec->model;
+    const int R = model->n_rooms;
+    const int N = dec->n_parts;
+
+    for (int i = 0; i < R; i++) {
+        int best_p = 0;
+        for (int p = 1; p < N; p++) {
+            // lectures[p] / (rooms[p] + 1) > lectures[best_p] / (rooms[best_p] + 1)
+            if ((long) lectures_of_part[p] * (rooms_of_part[best_p] + 1) >
+                (long) lectures_of_part[best_p] * (rooms_of_part[p] + 1))
+                best_p = p;
+        }
+        rooms_of_part[best_p]++;
+    }
+
+    // Students of the lectures of each part, in descending order
+    int **students = mallocx(N, sizeof(int *));
+    int *n_students = callocx(N, sizeof(int));
+    for (int p = 0; p < N; p++)
+        students[p] = mallocx(MAX(lectures_of_part[p], 1), sizeof(int));
+    for (int c = 0; c < model->n_courses; c++) {
+        const int p = dec->part_of_course[c];
+        for (int n = 0; n < model->courses[c].n_lectures; n++)
+            students[p][n_students[p]++] = model->courses[c].n_students;
+    }
+    for (int p = 0; p < N; p++)
+        qsort(students[p], n_students[p], sizeof(int), int_compare_desc);
+
+    room_capacity *rooms = mallocx(R, sizeof(room_capacity));
+    for (int r = 0; r < R; r++) {
+        rooms[r].capacity = model->rooms[r].capacity;
+        rooms[r].r = r;
+    }
+    qsort(rooms, R, sizeof(room_capacity), room_capacity_compare_desc);
+
+    int *dealt = callocx(N, sizeof(int));
+    for (int i = 0; i < R; i++) {
+        int best_p = -1;
+        int best_demand = -1;
+        for (int p = 0; p < N; p++) {
+            if (dealt[p] >= rooms_of_part[p])
+                continue;
+            const int rank = (int) ((long) dealt[p] * n_students[p] / rooms_of_part[p]);
+            const int demand = rank < n_students[p] ? students[p][rank] : 0;
+            // Ties to the part with the fewest rooms so far (in proportion)
+            if (demand > best_demand ||
+                (demand == best_demand &&
+                 (long) dealt[p] * rooms_of_part[best_p] <
+                 (long) dealt[best_p] * rooms_of_part[p])) {
+                best_p = p;
+                best_demand = demand;
+            }
+        }
+        dec->part_of_room[rooms[i].r] = best_p;
+        dealt[best_p]++;
+    }
+
+    for (int p = 0; p < N; p++)
+        free(students[p]);
+    free(students);
+    free(n_students);
+    free(dealt);
+    free(rooms);
+}
+
+/* Build the model of the part p, made of its courses and rooms
+ * and of the curriculas and unavailabilities of its courses */
+static void decomposition_part_init(decomposition *dec, int p) {
+    const model *m = dec->model;
+    decomposition_part *part = &dec->parts[p];
+    model *pm = &part->model;
+
+    model_init(pm);
+    pm->name = strmake("%s-%d", m->name, p);
+    pm->n_days = m->n_days;
+    pm->n_slots = m->n_slots;
+
+    for (int c = 0; c < m->n_courses; c++)
+        pm->n_courses += dec->part_of_course[c] == p;
+    for (int r = 0; r < m->n_rooms; r++)
+        pm->n_rooms += dec->part_of_room[r] == p;
+    for (int q = 0; q < m->n_curriculas; q++) {
+        int n_courses;
+        const int *courses = model_courses_of_curricula(m, q, &n_courses);
+        pm->n_curriculas += n_courses > 0 && dec->part_of_course[courses[0]] == p;
+    }
+    for (int u = 0; u < m->n_unavailability_constraints; u++)
+        pm->n_unavailability_constraints +=
+                dec->part_of_course[m->unavailability_constraints[u].course->index] == p;
+
+    pm->courses = mallocx(pm->n_courses, sizeof(course));
+    pm->rooms = mallocx(pm->n_rooms, sizeof(room));
+    pm->curriculas = mallocx(pm->n_curriculas, sizeof(curricula));
+    pm->unavailability_constraints = mallocx(pm->n_unavailability_constraints,
+                                             sizeof(unavailability_constraint));
+    part->courses = mallocx(pm->n_courses, sizeof(int));
+    part->rooms = mallocx(pm->n_rooms, sizeof(int));
+
+    int i = 0;
+    for (int c = 0; c < m->n_courses; c++) {
+        if (dec->part_of_course[c] != p)
+            continue;
+        const course *src = &m->courses[c];
+        course *dst = &pm->courses[i];
+        dst->index = i;
+        dst->id = strdup(src->id);
+        dst->teacher_id = strdup(src->teacher_id);
+        dst->n_lectures = src->n_lectures;
+        dst->min_working_days = src->min_working_days;
+        dst->n_students = src->n_students;
+        part->courses[i++] = c;
+    }
+
+    i = 0;
+    for (int r = 0; r < m->n_rooms; r++) {
+        if (dec->part_of_room[r] != p)
+            continue;
+        pm->rooms[i].index = i;
+        pm->rooms[i].id = strdup(m->rooms[r].id);
+        pm->rooms[i].capacity = m->rooms[r].capacity;
+        part->rooms[i++] = r;
+    }
+
+    i = 0;
+    for (int q = 0; q < m->n_curriculas; q++) {
+        int n_courses;
+        const int *courses = model_courses_of_curricula(m, q, &n_courses);
+        if (!(n_courses > 0 && dec->part_of_course[courses[0]] == p))
+            continue;
+        const curricula *src = &m->curriculas[q];
+        curricula *dst = &pm->curriculas[i];
+        dst->index = i++;
+        dst->id = strdup(src->id);
+        dst->n_courses = src->n_courses;
+        dst->courses_ids = mallocx(src->n_courses, sizeof(char *));
+        for (int qc = 0; qc < src->n_courses; qc++)
+            dst->courses_ids[qc] = strdup(src->courses_ids[qc]);
+    }
+
+    i = 0;
+    for (int u = 0; u < m->n_unavailability_constraints; u++) {
+        const unavailability_constraint *src = &m->unavailability_constraints[u];
+        if (dec->part_of_course[src->course->index] != p)
+            continue;
+        unavailability_constraint *dst = &pm->unavailability_constraints[i++];
+        dst->course_id = strdup(src->course_id);
+        dst->day = src->day;
+        dst->slot = src->slot;
+    }
+
+    model_finalize(pm);
+
+    // The lectures of a course are contiguous, and the courses
+    // of the part are in the same order of the model
+    int *first_lecture = mallocx(m->n_courses, sizeof(int));
+    for (int l = m->n_lectures - 1; l >= 0; l--)
+        first_lecture[m->course_of_lecture[l]] = l;
+
+    part->lectures = mallocx(pm->n_lectures, sizeof(int));
+    i = 0;
+    for (int c = 0; c < pm->n_courses; c++)
+        for (int n = 0; n < pm->courses[c].n_lectures; n++)
+            part->lectures[i++] = first_lecture[part->courses[c]] + n;
+
+    free(first_lecture);
+}
+
+static void decomposition_part_destroy(decomposition_part *part) {
+    model_destroy(&part->model);
+    free(part->courses);
+    free(part->rooms);
+    free(part->lectures);
+}
+
+bool decomposition_init(decomposition *dec, const model *model, int max_parts) {
+    const int C = model->n_courses;
+    const int R = model->n_rooms;
+    const int P = model->n_days * model->n_slots;
+
+    if (max_parts <= 0)
+        max_parts = (int) sysconf(_SC_NPROCESSORS_ONLN);
+
+    int *component_of_course = mallocx(C, sizeof(int));
+    int K = model_course_components(model, component_of_course);
+
+    verbose("Decomposition: %d independent components", K);
+
+    int n_parts = MIN(K, max_parts);
+    if (n_parts <= 1) {
+        free(component_of_course);
+        return false;
+    }
+
+    dec->model = model;
+    dec->n_components = K;
+    dec->component_of_course = component_of_course;
+    dec->n_parts = n_parts;
+    dec->part_of_course = mallocx(C, sizeof(int));
+    dec->part_of_room = mallocx(R, sizeof(int));
+    dec->parts = NULL;
+
+    int *lectures_of_component = callocx(K, sizeof(int));
+    for (int c = 0; c < C; c++)
+        lectures_of_component[component_of_course[c]] += model->courses[c].n_lectures;
+
+    int *lectures_of_part = callocx(n_parts, sizeof(int));
+    int *rooms_of_part = callocx(n_parts, sizeof(int));
+    decomposition_group_components(dec, lectures_of_component, lectures_of_part);
+    decomposition_partition_rooms(dec, lectures_of_part, rooms_of_part);
+
+    // Each part must have rooms enough (at least) for all its lectures
+    bool feasible = true;
+    for (int p = 0; p < n_parts && feasible; p++) {
+        verbose("Decomposition: part %d has %d lectures and %d rooms",
+                p, lectures_of_part[p], rooms_of_part[p]);
+        feasible = (long) rooms_of_part[p] * P >= lectures_of_part[p];
+    }
+
+    free(lectures_of_component);
+    free(lectures_of_part);
+    free(rooms_of_part);
+
+    if (!feasible) {
+        verbose("Decomposition: not enough rooms for each part");
+        free(dec->component_of_course);
+        free(dec->part_of_course);
+        free(dec->part_of_room);
+        return false;
+    }
+
+    dec->parts = mallocx(n_parts, sizeof(decomposition_part));
+    for (int p = 0; p < n_parts; p++)
+        decomposition_part_init(dec, p);
+
+    return true;
+}
+
+void decomposition_destroy(decomposition *dec) {
+    for (int p = 0; p < dec->n_parts; p++)
+        decomposition_part_destroy(&dec->parts[p]);
+    free(dec->parts);
+    free(dec->component_of_course);
+    free(dec->part_of_course);
+    free(dec->part_of_room);
+}
+
+typedef struct decomposition_worker {
+    const decomposition_part *part;
+    const feasible_solution_finder_config *finder_conf;
+    heuristic_solver_config solver_conf;
+    heuristic_solver solver;
+    heuristic_solver_stats stats;
+    solution start;
+    solution sol;
+    unsigned int seed;
+    bool success;
+} decomposition_worker;
+
+static void *decomposition_worker_run(void *arg) {
+    decomposition_worker *worker = arg;
+    // The generator is thread local: each part has its own sequence
+    rand_set_seed(worker->seed);
+    worker->success = heuristic_solver_solve(&worker->solver, &worker->solver_conf,
+                                             worker->finder_conf, &worker->sol, &worker->stats);
+    return NULL;
+}
+
+bool decomposition_solve(decomposition *dec,
+                         heuristic_solver *solver,
+                         const heuristic_solver_config *solver_conf,
+                         const feasible_solution_finder_config *finder_conf,
+                         solution *sol,
+                         heuristic_solver_stats *stats) {
+    const int N = dec->n_parts;
+
+    verbose("Decomposition: solving %d parts concurrently", N);
+
+    long decomposition_starting_time = ms();
+
+    // The timeout is global: set it once for all the parts, which get
+    // half of the time; the rest is left for the merged solution
+    if (solver_conf->max_time >= 0)
+        set_timeout(MAX(1, solver_conf->max_time / 2));
+
+    decomposition_worker *workers = mallocx(N, sizeof(decomposition_worker));
+    pthread_t *threads = mallocx(N, sizeof(pthread_t));
+
+    // Rooms enough for the lectures of a part don't imply that it is
+    // feasible: give up the decomposition if a part has no feasible
+    // solution within a few trials
+    feasible_solution_finder finder;
+    feasible_solution_finder_init(&finder);
+    int n_found = 0;
+    for (; n_found < N; n_found++) {
+        solution *start = &workers[n_found].start;
+        solution_init(start, &dec->parts[n_found].model);
+        bool found = false;
+        for (int trial = 0; trial < DECOMPOSITION_FINDER_TRIALS && !found && !timeout; trial++) {
+            found = feasible_solution_finder_try_find(&finder, finder_conf, start);
+            if (!found)
+                solution_clear(start);
+        }
+        if (!found) {
+            verbose("Decomposition: no feasible solution found for part %d", n_found);
+            solution_destroy(start);
+            break;
+        }
+    }
+    feasible_solution_finder_destroy(&finder);
+
+    if (n_found < N) {
+        for (int p = 0; p < n_found; p++)
+            solution_destroy(&workers[p].start);
+        free(workers);
+        free(threads);
+        return false;
+    }
+
+    for (int p = 0; p < N; p++) {
+        decomposition_worker *worker = &workers[p];
+        worker->part = &dec->parts[p];
+        worker->finder_conf = finder_conf;
+        worker->solver_conf = *solver_conf;
+        worker->solver_conf.starting_solution = &worker->start;
+        worker->solver_conf.max_time = -1;
+        worker->solver_conf.decomposition = false;
+        worker->solver_conf.new_best_callback.callback = NULL;
+        worker->solver_conf.new_best_callback.arg = NULL;
+        heuristic_solver_init(&worker->solver);
+        heuristic_solver_stats_init(&worker->stats);
+        solution_init(&worker->sol, &dec->parts[p].model);
+        // Drawn in order from the caller's generator, for reproducibility
+        worker->seed = (unsigned int) rand_int();
+        worker->success = false;
+    }
+
+    long starting_time = ms();
+
+    for (int p = 0; p < N; p++)
+        pthread_create(&threads[p], NULL, decomposition_worker_run, &workers[p]);
+    for (int p = 0; p < N; p++)
+        pthread_join(threads[p], NULL);
+
+    // Merge the solutions of the parts
+    solution_clear(sol);
+
+    stats->starting_time = starting_time;
+    stats->best_solution_time = starting_time;
+    stats->cycle_count = 0;
+    stats->move_count = 0;
+    stats->best_restored_count = 0;
+    stats->methods = NULL;
+    stats->n_methods = 0;
+
+    for (int p = 0; p < N && strempty(solver->error); p++) {
+        decomposition_worker *worker = &workers[p];
+        const decomposition_part *part = worker->part;
+
+        if (!worker->success) {
+            solver->error = strmake("part %d: %s", p,
+                                    heuristic_solver_get_error(&worker->solver));
+            break;
+        }
+
+        for (int l = 0; l < part->model.n_lectures; l++) {
+            int r, d, s;
+            solution_get_lecture_assignment(&worker->sol, l, &r, &d, &s);
+            if (r >= 0)
+                solution_assign_lecture(sol, part->lectures[l], part->rooms[r], d, s);
+        }
+
+        verbose("Decomposition: part %d solved with cost %d",
+                p, solution_cost(&worker->sol));
+
+        stats->cycle_count = MAX(stats->cycle_count, worker->stats.cycle_count);
+        stats->move_count += worker->stats.move_count;
+        stats->best_restored_count += worker->stats.best_restored_count;
+        stats->best_solution_time = MAX(stats->best_solution_time, worker->stats.best_solution_time);
+    }
+
+    stats->ending_time = ms();
+
+    for (int p = 0; p < N; p++) {
+        decomposition_worker *worker = &workers[p];
+        solution_destroy(&worker->start);
+        solution_destroy(&worker->sol);
+        heuristic_solver_stats_destroy(&worker->stats);
+        heuristic_solver_destroy(&worker->solver);
+    }
+    free(workers);
+    free(threads);
+
+    if (!strempty(solver->error))
+        return false;
+
+    verbose("Decomposition: merged solution of cost %d", solution_cost(sol));
+
+    int remaining_time = -1;
+    if (solver_conf->max_time >= 0) {
+        remaining_time = solver_conf->max_time -
+                (int) ((ms() - decomposition_starting_time) / 1000);
+        if (remaining_time <= 0) {
+            if (solver_conf->new_best_callback.callback)
+                solver_conf->new_best_callback.callback(
+                        sol, stats, solver_conf->new_best_callback.arg);
+            return true;
+        }
+    }
+
+    // Each part is bound to the rooms dealt to it: improve the merged
+    // solution as a whole (starting from it, the result can't be worse)
+    verbose("Decomposition: improving the merged solution as a whole");
+
+    const heuristic_solver_stats parts_stats = *stats;
+
+    solution merged;
+    solution_init(&merged, sol->model);
+    solution_copy(&merged, sol);
+
+    heuristic_solver_config whole_conf = *solver_conf;
+    whole_conf.starting_solution = &merged;
+    whole_conf.decomposition = false;
+    whole_conf.max_time = remaining_time;
+
+    bool success = heuristic_solver_solve(solver, &whole_conf, finder_conf, sol, stats);
+
+    solution_destroy(&merged);
+
+    stats->starting_time = decomposition_starting_time;
+    stats->cycle_count += parts_stats.cycle_count;
+    stats->move_count += parts_stats.move_count;
+    stats->best_restored_count += parts_stats.best_restored_count;
+
+    return success;
+}
@@ -0,0 +1,75 @@
+#ifndef DECOMPOSITION_H
+#define DECOMPOSITION_H
+
+#include <stdbool.h>
+#include "model/model.h"
+#include "heuristics/heuristic_solver.h"
+
+/*
+ * Decomposition of a model into independent parts.
+ *
+ * Two courses conflict if they share a curricula or a teacher: the
+ * connected components of this conflict graph (e.g. departments sharing
+ * only the rooms) can be scheduled independently, but for the rooms.
+ * The components are grouped into (at most) one part per thread, balancing
+ * the lectures, and the rooms are partitioned among the parts; each part
+ * is then a standalone model, solved concurrently with the others by its
+ * own heuristic_solver, and the solutions of the parts are merged.
+ */
+
+typedef struct decomposition_part {
+    model model;
+    int *courses;       // [c] course of the model of the course c of the part
+    int *rooms;         // [r] room of the model of the room r of the part
+    int *lectures;      // [l] lecture of the model of the lecture l of the part
+} decomposition_part;
+
+typedef struct decomposition {
+    const model *model;
+
+    int n_components;
+    int *component_of_course;   // [c]
+
+    int n_parts;
+    int *part_of_course;        // [c]
+    int *part_of_room;          // [r]
+    decomposition_part *parts;
+} decomposition;
+
+/* Compute the connected components of the conflict graph of the courses;
+ * returns the number of components (numbered by their first course) */
+int model_course_components(const model *model, int *component_of_course);
+
+/*
+ * Decompose the model into no more than `max_parts` parts
+ * (0: as many as the cores).
+ * Returns false, and leaves `dec` uninitialized, if the model can't
+ * be decomposed: the conflict graph is connected, or the rooms are not
+ * enough for giving each part its own share.
+ */
+bool decomposition_init(decomposition *dec, const model *model, int max_parts);
+void decomposition_destroy(decomposition *dec);
+
+/* Trials of the finder for each part, before giving up the decomposition */
+#define DECOMPOSITION_FINDER_TRIALS 100
+
+/*
+ * Solve each part on its own thread, with a copy of `solver_conf`, merge
+ * the solutions of the parts into `sol` and improve it as a whole with
+ * `solver`, starting from the merged solution.
+ * Each part starts from a feasible solution found beforehand: if none is
+ * found for a part within DECOMPOSITION_FINDER_TRIALS trials, returns false
+ * without setting the error of `solver` (the model should be solved
+ * as a whole).
+ * The parts share half of the time limit (`solver_conf->max_time`) and
+ * the whole model gets the rest; the cycles limit applies to each part
+ * and to the whole model.
+ */
+bool decomposition_solve(decomposition *dec,
+                         heuristic_solver *solver,
+                         const heuristic_solver_config *solver_conf,
+                         const feasible_solution_finder_config *finder_conf,
+                         solution *sol,
+                         heuristic_solver_stats *stats);
+
+#endif // DECOMPOSITION_H
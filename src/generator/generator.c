@@ -0,0 +1,408 @@
+#include "generator.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <glib.h>
+#include "utils/io_utils.h"
+#include "utils/mem_utils.h"
+#include "utils/rand_utils.h"
+
+// Teachers tried for a course before giving it a new teacher
+#define TEACHER_PROBES 32
+
+// Courses tried (per course) for fill a curriculum
+#define CURRICULUM_PROBES 4
+
+void generator_config_default(generator_config *config) {
+    config->n_courses = 100;
+    config->n_rooms = 0;
+    config->n_days = 5;
+    config->n_slots = 6;
+    config->min_lectures = 1;
+    config->max_lectures = 6;
+    config->occupancy = 0.7;
+    config->curricula_density = 1.5;
+    config->min_curriculum_size = 3;
+    config->max_curriculum_size = 8;
+    config->teacher_load = 1.5;
+    config->unavailability_ratio = 0.1;
+    config->seed = 0;
+}
+
+typedef struct generator_instance {
+    int C, R, D, S, P, L, T, Q, U;
+
+    int *lectures_base;     // [c+1]: lectures of c are [lectures_base[c], lectures_base[c+1])
+    int *period_of_lecture; // [l]: hidden timetable
+    int *room_of_lecture;   // [l]
+    int *teacher_of_course; // [c]
+    int *min_working_days;  // [c]
+    int *students;          // [c]
+    int *capacity;          // [r]
+
+    int *curricula_base;    // [q+1]
+    int *curricula_courses;
+    int *unavailabilities;  // [u]: c * P + p
+} generator_instance;
+
+static void generator_instance_destroy(generator_instance *inst) {
+    free(inst->lectures_base);
+    free(inst->period_of_lecture);
+    free(inst->room_of_lecture);
+    free(inst->teacher_of_course);
+    free(inst->min_working_days);
+    free(inst->students);
+    free(inst->capacity);
+    free(inst->curricula_base);
+    free(inst->curricula_courses);
+    free(inst->unavailabilities);
+}
+
+#define FOR_LECTURE_OF(inst, c, l) \
+    for (int l = (inst)->lectures_base[c]; l < (inst)->lectures_base[(c) + 1]; l++)
+
+/*
+ * Place each lecture in a free room of a distinct period of its course,
+ * the courses with more lectures first.
+ */
+static bool generate_timetable(generator_instance *inst, int max_lectures) {
+    const int C = inst->C, R = inst->R, P = inst->P;
+
+    // Rooms still free in each period: the first n_free_rooms[p] of free_rooms[p,r]
+    int *free_rooms = mallocx(P * R, sizeof(int));
+    int *n_free_rooms = mallocx(P, sizeof(int));
+    // Periods with at least a free room: the first n_open of open_periods
+    int *open_periods = mallocx(P, sizeof(int));
+    int n_open = P;
+
+    for (int p = 0; p < P; p++) {
+        for (int r = 0; r < R; r++)
+            free_rooms[p * R + r] = r;
+        n_free_rooms[p] = R;
+        open_periods[p] = p;
+    }
+
+    bool success = true;
+
+    for (int k = max_lectures; k > 0 && success; k--) {
+        for (int c = 0; c < C; c++) {
+            if (inst->lectures_base[c + 1] - inst->lectures_base[c] != k)
+                continue;
+
+            if (n_open < k) {
+                success = false;
+                break;
+            }
+
+            // Partial shuffle: the first k open periods are the ones of c
+            for (int i = 0; i < k; i++) {
+                int j = rand_range(i, n_open);
+                int tmp = open_periods[i];
+                open_periods[i] = open_periods[j];
+                open_periods[j] = tmp;
+            }
+
+            int i = 0;
+            FOR_LECTURE_OF(inst, c, l) {
+                int p = open_periods[i++];
+                int *rooms = &free_rooms[p * R];
+                int j = rand_range(0, n_free_rooms[p]);
+                inst->period_of_lecture[l] = p;
+                inst->room_of_lecture[l] = rooms[j];
+                rooms[j] = rooms[--n_free_rooms[p]];
+            }
+
+            for (i = k - 1; i >= 0; i--)
+                if (!n_free_rooms[open_periods[i]])
+                    open_periods[i] = open_periods[--n_open];
+        }
+    }
+
+    free(free_rooms);
+    free(n_free_rooms);
+    free(open_periods);
+
+    return success;
+}
+
+static bool course_fits(const generator_instance *inst, int c, const bool *busy) {
+    FOR_LECTURE_OF(inst, c, l)
+        if (busy[inst->period_of_lecture[l]])
+            return false;
+    return true;
+}
+
+static void course_mark(const generator_instance *inst, int c, bool *busy) {
+    FOR_LECTURE_OF(inst, c, l)
+        busy[inst->period_of_lecture[l]] = true;
+}
+
+/*
+ * Give the courses to the teachers round robin (on a random order),
+ * moving to the next teacher if the periods of the course are already
+ * taken by the teacher; after TEACHER_PROBES a new teacher is added.
+ */
+static void generate_teachers(generator_instance *inst, int target_teachers) {
+    const int C = inst->C, P = inst->P;
+
+    int T = target_teachers;
+    int teachers_capacity = T;
+    bool *busy = callocx(teachers_capacity * P, sizeof(bool)); // [t,p]
+
+    int *courses = mallocx(C, sizeof(int));
+    for (int c = 0; c < C; c++)
+        courses[c] = c;
+    shuffle(courses, C, sizeof(int));
+
+    for (int i = 0; i < C; i++) {
+        int c = courses[i];
+        int t = -1;
+
+        for (int k = 0; k < MIN(TEACHER_PROBES, T); k++) {
+            int tk = (i + k) % T;
+            if (course_fits(inst, c, &busy[tk * P])) {
+                t = tk;
+                break;
+            }
+        }
+
+        if (t < 0) {
+            if (T == teachers_capacity) {
+                teachers_capacity *= 2;
+                busy = reallocx(busy, teachers_capacity * P, sizeof(bool));
+                memset(&busy[T * P], 0, (teachers_capacity - T) * P * sizeof(bool));
+            }
+            t = T++;
+        }
+
+        course_mark(inst, c, &busy[t * P]);
+        inst->teacher_of_course[c] = t;
+    }
+
+    inst->T = T;
+
+    free(courses);
+    free(busy);
+}
+
+/*
+ * Fill each curriculum with random courses whose lectures don't overlap
+ * the ones already in the curriculum.
+ */
+static void generate_curricula(generator_instance *inst, int target_curricula,
+                               int min_size, int max_size) {
+    const int C = inst->C, P = inst->P;
+
+    inst->curricula_base = mallocx(target_curricula + 1, sizeof(int));
+    inst->curricula_courses = mallocx(target_curricula * max_size + 1, sizeof(int));
+    bool *busy = mallocx(P, sizeof(bool));
+
+    int Q = 0, n = 0;
+    inst->curricula_base[0] = 0;
+
+    for (int q = 0; q < target_curricula; q++) {
+        int size = rand_range(min_size, max_size + 1);
+        int filled = 0;
+        memset(busy, 0, P * sizeof(bool));
+
+        for (int k = 0; k < CURRICULUM_PROBES * size && filled < size; k++) {
+            int c = rand_range(0, C);
+            if (course_fits(inst, c, busy)) {
+                course_mark(inst, c, busy);
+                inst->curricula_courses[n + filled++] = c;
+            }
+        }
+
+        if (filled) {
+            n += filled;
+            inst->curricula_base[++Q] = n;
+        }
+    }
+
+    inst->Q = Q;
+
+    free(busy);
+}
+
+static void generate_unavailabilities(generator_instance *inst, double ratio) {
+    const int C = inst->C, P = inst->P;
+
+    int capacity = 16;
+    int U = 0;
+    inst->unavailabilities = mallocx(capacity, sizeof(int));
+    bool *busy = mallocx(P, sizeof(bool));
+
+    for (int c = 0; c < C; c++) {
+        memset(busy, 0, P * sizeof(bool));
+        course_mark(inst, c, busy);
+
+        for (int p = 0; p < P; p++) {
+            if (busy[p] || rand_uniform(0, 1) >= ratio)
+                continue;
+            if (U == capacity) {
+                capacity *= 2;
+                inst->unavailabilities = reallocx(inst->unavailabilities, capacity, sizeof(int));
+            }
+            inst->unavailabilities[U++] = c * P + p;
+        }
+    }
+
+    inst->U = U;
+
+    free(busy);
+}
+
+static bool write_instance(const generator_instance *inst,
+                           const generator_config *config, const char *filename) {
+    FILE *f = fopen(filename, "w");
+    if (!f) {
+        eprint("ERROR: failed to open '%s' for write", filename);
+        return false;
+    }
+
+    fprintf(f, "Name: Synthetic-%d-%u\n"
+               "Courses: %d\n"
+               "Rooms: %d\n"
+               "Days: %d\n"
+               "Periods_per_day: %d\n"
+               "Curricula: %d\n"
+               "Constraints: %d\n\n",
+               inst->C, config->seed,
+               inst->C, inst->R, inst->D, inst->S, inst->Q, inst->U);
+
+    fprintf(f, "COURSES:\n");
+    for (int c = 0; c < inst->C; c++)
+        fprintf(f, "c%d t%d %d %d %d\n",
+                c, inst->teacher_of_course[c],
+                inst->lectures_base[c + 1] - inst->lectures_base[c],
+                inst->min_working_days[c], inst->students[c]);
+
+    fprintf(f, "\nROOMS:\n");
+    for (int r = 0; r < inst->R; r++)
+        fprintf(f, "r%d %d\n", r, inst->capacity[r]);
+
+    fprintf(f, "\nCURRICULA:\n");
+    for (int q = 0; q < inst->Q; q++) {
+        fprintf(f, "q%d %d", q, inst->curricula_base[q + 1] - inst->curricula_base[q]);
+        for (int i = inst->curricula_base[q]; i < inst->curricula_base[q + 1]; i++)
+            fprintf(f, " c%d", inst->curricula_courses[i]);
+        fprintf(f, "\n");
+    }
+
+    fprintf(f, "\nUNAVAILABILITY_CONSTRAINTS:\n");
+    for (int u = 0; u < inst->U; u++) {
+        int c = inst->unavailabilities[u] / inst->P;
+        int p = inst->unavailabilities[u] % inst->P;
+        fprintf(f, "c%d %d %d\n", c, p / inst->S, p % inst->S);
+    }
+
+    fprintf(f, "\nEND.\n");
+
+    if (fclose(f) != 0) {
+        eprint("ERROR: failed to write '%s'", filename);
+        return false;
+    }
+
+    return true;
+}
+
+static bool write_timetable(const generator_instance *inst, const char *filename) {
+    FILE *f = fopen(filename, "w");
+    if (!f) {
+        eprint("ERROR: failed to open '%s' for write", filename);
+        return false;
+    }
+
+    for (int c = 0; c < inst->C; c++) {
+        FOR_LECTURE_OF(inst, c, l) {
+            int p = inst->period_of_lecture[l];
+            fprintf(f, "c%d r%d %d %d\n",
+                    c, inst->room_of_lecture[l], p / inst->S, p % inst->S);
+        }
+    }
+
+    if (fclose(f) != 0) {
+        eprint("ERROR: failed to write '%s'", filename);
+        return false;
+    }
+
+    return true;
+}
+
+bool generate_instance(const generator_config *config,
+                       const char *filename, const char *solution_filename) {
+    generator_instance inst = {0};
+    inst.C = config->n_courses;
+    inst.D = config->n_days;
+    inst.S = config->n_slots;
+    inst.P = inst.D * inst.S;
+
+    const int min_lectures = config->min_lectures;
+    const int max_lectures = MIN(config->max_lectures, inst.P);
+
+    if (inst.C <= 0 || inst.P <= 0 || min_lectures <= 0 || min_lectures > max_lectures ||
+        config->min_curriculum_size <= 0 ||
+        config->min_curriculum_size > config->max_curriculum_size ||
+        config->teacher_load <= 0) {
+        eprint("ERROR: invalid generator configuration");
+        return false;
+    }
+
+    rand_set_seed(config->seed);
+
+    // Courses
+    inst.lectures_base = mallocx(inst.C + 1, sizeof(int));
+    inst.min_working_days = mallocx(inst.C, sizeof(int));
+    inst.students = mallocx(inst.C, sizeof(int));
+    inst.teacher_of_course = mallocx(inst.C, sizeof(int));
+
+    inst.lectures_base[0] = 0;
+    for (int c = 0; c < inst.C; c++) {
+        int n_lectures = rand_range(min_lectures, max_lectures + 1);
+        inst.lectures_base[c + 1] = inst.lectures_base[c] + n_lectures;
+        inst.min_working_days[c] = rand_range(1, MIN(n_lectures, inst.D) + 1);
+    }
+    inst.L = inst.lectures_base[inst.C];
+
+    // Rooms
+    inst.R = config->n_rooms > 0 ? config->n_rooms :
+             MAX(1, (int) ceil(inst.L / (MIN(MAX(config->occupancy, 0.01), 1) * inst.P)));
+    inst.capacity = mallocx(inst.R, sizeof(int));
+    for (int r = 0; r < inst.R; r++)
+        inst.capacity[r] = rand_range(20, 400);
+
+    inst.period_of_lecture = mallocx(inst.L, sizeof(int));
+    inst.room_of_lecture = mallocx(inst.L, sizeof(int));
+
+    bool success = true;
+
+    if (inst.L > inst.R * inst.P || !generate_timetable(&inst, max_lectures)) {
+        eprint("ERROR: %d rooms are not enough for %d lectures in %d periods",
+               inst.R, inst.L, inst.P);
+        success = false;
+        goto QUIT;
+    }
+
+    // Students fit the room of the first lecture of the course
+    for (int c = 0; c < inst.C; c++)
+        inst.students[c] = rand_range(10, inst.capacity[inst.room_of_lecture[inst.lectures_base[c]]] + 1);
+
+    generate_teachers(&inst, MAX(1, (int) round(inst.C / config->teacher_load)));
+
+    double avg_curriculum_size =
+            (config->min_curriculum_size + config->max_curriculum_size) / 2.0;
+    generate_curricula(&inst,
+                       (int) round(inst.C * MAX(config->curricula_density, 0) / avg_curriculum_size),
+                       config->min_curriculum_size, config->max_curriculum_size);
+
+    generate_unavailabilities(&inst, config->unavailability_ratio);
+
+    success = write_instance(&inst, config, filename);
+    if (success && solution_filename)
+        success = write_timetable(&inst, solution_filename);
+
+QUIT:
+    generator_instance_destroy(&inst);
+
+    return success;
+}
@@ -0,0 +1,51 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <stdbool.h>
+
+/*
+ * Generator of synthetic ITC2007 instances (.ctt), of arbitrary size.
+ *
+ * The instances are feasible by construction: a hidden timetable is
+ * built first (each lecture in a free room of a distinct period of its
+ * course), then teachers, curricula and unavailabilities are drawn
+ * only among the ones that do not conflict with it.
+ * The hidden timetable can be written too, as a solution of the instance.
+ */
+
+typedef struct generator_config {
+    int n_courses;
+    int n_rooms;                    // 0: derived from occupancy
+    int n_days;
+    int n_slots;
+
+    int min_lectures;               // lectures of each course in
+    int max_lectures;               // [min_lectures, max_lectures]
+
+    double occupancy;               // fraction of the room-periods used,
+                                    // only if n_rooms is 0
+
+    double curricula_density;       // average number of curricula per course
+    int min_curriculum_size;        // courses of each curriculum drawn in
+    int max_curriculum_size;        // [min_curriculum_size, max_curriculum_size]
+                                    // (fewer if they don't fit)
+
+    double teacher_load;            // average number of courses per teacher
+
+    double unavailability_ratio;    // fraction of the (course, period) pairs
+                                    // unavailable, among the free ones
+
+    unsigned int seed;
+} generator_config;
+
+void generator_config_default(generator_config *config);
+
+/*
+ * Generate an instance and write it to `filename`; if `solution_filename`
+ * is not NULL, write also the hidden timetable to it.
+ * Fails if the rooms are not enough for all the lectures.
+ */
+bool generate_instance(const generator_config *config,
+                       const char *filename, const char *solution_filename);
+
+#endif // GENERATOR_H
@@ -9,6 +9,7 @@
 #include "utils/mem_utils.h"
 #include "timeout/timeout.h"
 #include "finder/feasible_solution_finder.h"
+#include "decomposition/decomposition.h"
 
 void heuristic_solver_config_init(heuristic_solver_config *config) {
     config->methods = g_array_new(false, false, sizeof(heuristic_solver_method_callback_parameterized));
@@ -19,6 +20,9 @@ void heuristic_solver_config_init(heuristic_solver_config *config) {
 
     config->starting_solution = NULL;
     config->dont_solve = false;
+    config->best_snapshot = true;
+    config->decomposition = false;
+    config->threads = 0;
     config->new_best_callback.callback = NULL;
     config->new_best_callback.arg = NULL;
 }
@@ -67,10 +71,13 @@ void heuristic_solver_stats_destroy(heuristic_solver_stats *stats) {
 
 void heuristic_solver_init(heuristic_solver *solver) {
     solver->error = NULL;
+    solver->state.solution_pool.model = NULL;
 }
 
 void heuristic_solver_destroy(heuristic_solver *solver) {
     free(solver->error);
+    if (solver->state.solution_pool.model)
+        solution_pool_destroy(&solver->state.solution_pool);
 }
 
 const char *heuristic_solver_get_error(heuristic_solver *solver) {
@@ -135,6 +142,9 @@ bool heuristic_solver_solve(heuristic_solver *solver,
         verbose("solver.cycles_limit = %d", solver_conf->max_cycles);
         verbose("solver.multistart = %s", booltostr(solver_conf->multistart));
         verbose("solver.restore_best_after_cycles = %d", solver_conf->restore_best_after_cycles);
+        verbose("solver.best_snapshot = %s", booltostr(solver_conf->best_snapshot));
+        verbose("solver.decomposition = %s", booltostr(solver_conf->decomposition));
+        verbose("solver.threads = %d", solver_conf->threads);
 
         free(methods_str);
     }
@@ -144,22 +154,40 @@ bool heuristic_solver_solve(heuristic_solver *solver,
         return false;
     }
 
+    if (solver_conf->decomposition && !solver_conf->starting_solution) {
+        decomposition dec;
+        if (decomposition_init(&dec, model, solver_conf->threads)) {
+            bool success = decomposition_solve(&dec, solver, solver_conf, finder_conf,
+                                               sol_out, statistics);
+            decomposition_destroy(&dec);
+            if (success || !strempty(solver->error))
+                return success;
+        }
+        verbose("Model can't be decomposed, solving it as a whole");
+    }
+
     if (solver_conf->max_time >= 0)
         set_timeout(solver_conf->max_time);
 
     int cycles_limit = solver_conf->max_cycles >= 0 ? solver_conf->max_cycles : INT_MAX;
     bool collect_trend = get_verbosity();
 
-    solution current_solution;
-    solution_init(&current_solution, model);
-
     // Initialize solver's state
     heuristic_solver_state *state = &solver->state;
+    if (state->solution_pool.model != model) {
+        if (state->solution_pool.model)
+            solution_pool_destroy(&state->solution_pool);
+        solution_pool_init(&state->solution_pool, model);
+    }
+
     state->model = model;
-    state->current_solution = &current_solution;
+    state->current_solution = solution_pool_acquire(&state->solution_pool);
     state->current_cost = INT_MAX;
     state->best_solution = sol_out;
     state->best_cost = INT_MAX;
+    state->best_solution_outdated = false;
+    if (solver_conf->best_snapshot)
+        solution_snapshot_init(&state->best_snapshot, model);
     state->cycle = 0;
     state->method = 0;
     state->non_improving_best_cycles = 0;
@@ -221,7 +249,10 @@ bool heuristic_solver_solve(heuristic_solver *solver,
             state->non_improving_best_cycles >= solver_conf->restore_best_after_cycles) {
             verbose("Restoring best solution of cost %d after %d cycles not improving best",
                     state->best_cost, state->non_improving_best_cycles);
-            solution_copy(state->current_solution, state->best_solution);
+            if (solver_conf->best_snapshot)
+                solution_restore_snapshot(state->current_solution, &state->best_snapshot);
+            else
+                solution_copy(state->current_solution, state->best_solution);
             state->current_cost = state->best_cost;
             state->non_improving_best_cycles = 0;
             state->non_improving_current_cycles = 0;
@@ -363,8 +394,13 @@ bool heuristic_solver_solve(heuristic_solver *solver,
     }
 
 QUIT:
+    // Rebuild the best solution into sol_out (if it's outdated)
+    heuristic_solver_state_best_solution(state);
+
     free(state->methods_name);
-    solution_destroy(state->current_solution);
+    solution_pool_release(&state->solution_pool, state->current_solution);
+    if (solver_conf->best_snapshot)
+        solution_snapshot_destroy(&state->best_snapshot);
 
     return strempty(solver->error);
 }
@@ -393,18 +429,22 @@ bool heuristic_solver_state_update(heuristic_solver_state *state) {
 
         state->stats->best_solution_time = ms();
 
-        // Copy the current solution to the best
+        // Copy the current solution to the best (or just its assignments)
         state->best_cost = state->current_cost;
-        solution_copy(state->best_solution, state->current_solution);
+        if (state->config->best_snapshot) {
+            solution_take_snapshot(&state->best_snapshot, state->current_solution);
+            state->best_solution_outdated = true;
+        } else {
+            solution_copy(state->best_solution, state->current_solution);
+            assert(state->best_cost == solution_cost(state->best_solution));
+        }
         improved = true;
 
         // Eventually callback
         if (state->config->new_best_callback.callback)
             state->config->new_best_callback.callback(
-                    state->best_solution, state->stats,
+                    heuristic_solver_state_best_solution(state), state->stats,
                     state->config->new_best_callback.arg);
-        
-        assert(state->best_cost == solution_cost(state->best_solution));
     }
 
     state->stats->move_count++;
@@ -412,3 +452,12 @@ bool heuristic_solver_state_update(heuristic_solver_state *state) {
 
    return improved;
 }
+
+const solution * heuristic_solver_state_best_solution(heuristic_solver_state *state) {
+    if (state->best_solution_outdated) {
+        solution_restore_snapshot(state->best_solution, &state->best_snapshot);
+        state->best_solution_outdated = false;
+        assert(state->best_cost == solution_cost(state->best_solution));
+    }
+    return state->best_solution;
+}
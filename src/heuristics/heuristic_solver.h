@@ -65,6 +65,14 @@ typedef struct heuristic_solver_stats {
  *  `starting_solution`: start from this solution instead of generating one.
  *       if `multistart` is true, starts always from this starting solution
  *  `dont_solve`: just generate the initial feasible solution and quit
+ *  `best_snapshot`: keep track of the best solution by storing only
+ *       its assignments instead of copying the whole solution each time
+ *       the best improves; the full solution is rebuilt only when needed
+ *  `decomposition`: split the model into independent parts (no shared
+ *       curricula or teachers), solved concurrently and then improved
+ *       as a whole (see decomposition.h);
+ *       if the model can't be decomposed, it is solved as a whole
+ *  `threads`: maximum number of threads (0: as many as the cores)
  */
 typedef struct heuristic_solver_config {
     GArray *methods;
@@ -75,6 +83,9 @@ typedef struct heuristic_solver_config {
 
     solution *starting_solution;
     bool dont_solve;
+    bool best_snapshot;
+    bool decomposition;
+    int threads;
 
     struct {
         void (*callback)(const solution *, const heuristic_solver_stats *, void * /* arg */);
@@ -98,6 +109,15 @@ typedef struct heuristic_solver_state {
     int current_cost;
     int best_cost;
 
+    // Assignments of the best solution (if config->best_snapshot is true);
+    // best_solution is outdated until heuristic_solver_state_best_solution is called
+    solution_snapshot best_snapshot;
+    bool best_solution_outdated;
+
+    // Pool of solutions of the model, shared across solve calls;
+    // methods may acquire scratch solutions from it
+    solution_pool solution_pool;
+
     long cycle;
     int method;
 
@@ -152,6 +172,9 @@ bool heuristic_solver_solve(heuristic_solver *solver,
 /* Must be called by `heuristic_solver_method_callback` when a move is performed */
 bool heuristic_solver_state_update(heuristic_solver_state *state);
 
+/* Returns the best solution, eventually rebuilding it from the best snapshot */
+const solution * heuristic_solver_state_best_solution(heuristic_solver_state *state);
+
 const char * heuristic_solver_get_error(heuristic_solver *solver);
 
 #endif // HEURISTIC_SOLVER_H
\ No newline at end of file
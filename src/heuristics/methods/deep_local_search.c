@@ -35,6 +35,11 @@ void deep_local_search(heuristic_solver_state *state, void *arg) {
                                       sizeof(swap_move_result));
     int move_cursor;
 
+    swap_moves batch;
+    swap_moves_init(&batch, SWAP_MOVES_BATCH_SIZE);
+    swap_results results;
+    swap_results_init(&results, SWAP_MOVES_BATCH_SIZE);
+
     // Exit conditions: timeout or local minimum reached
     bool improved;
     do {
@@ -42,9 +47,7 @@ void deep_local_search(heuristic_solver_state *state, void *arg) {
         move_cursor = 0;
 
         swap_iter swap_iter;
-        swap_iter_init(&swap_iter, state->current_solution);
-
-        swap_result swap_result;
+        swap_iter_init_pruned(&swap_iter, state->current_solution);
 
         // First of all sort all the moves at distance 1 by
         // decreasing cost, since the moves with better cost are more
@@ -53,28 +56,31 @@ void deep_local_search(heuristic_solver_state *state, void *arg) {
         // the move immediately (as local_search does).
 
         bool performed_deep1 = false;
-        while (swap_iter_next(&swap_iter)) {
-            swap_predict(state->current_solution, &swap_iter.move,
-                         NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
-                         NEIGHBOURHOOD_PREDICT_COST_IF_FEASIBLE,
-                         &swap_result);
-
-            if (!swap_result.feasible)
-                continue;
-
-            if (swap_result.delta.cost < 0) {
-                // Perform improving move immediately
-                swap_perform(state->current_solution, &swap_iter.move,
-                         NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
-                state->current_cost += swap_result.delta.cost;
-                heuristic_solver_state_update(state);
-                performed_deep1 = true;
-                break;
-            } else {
-                // Push to the moves array
-                moves[move_cursor].move = swap_iter.move;
-                moves[move_cursor].delta = swap_result.delta.cost;
-                move_cursor++;
+        int n_moves;
+        while (!performed_deep1 && (n_moves = swap_iter_next_batch(&swap_iter, &batch)) > 0) {
+            swap_predict_batch(state->current_solution, &batch, n_moves, &results);
+
+            for (int i = 0; i < n_moves; i++) {
+                if (!results.feasible[i])
+                    continue;
+
+                swap_move mv;
+                swap_moves_get(state->current_solution, &batch, i, &mv);
+
+                if (results.cost[i] < 0) {
+                    // Perform improving move immediately
+                    swap_perform(state->current_solution, &mv,
+                             NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
+                    state->current_cost += results.cost[i];
+                    heuristic_solver_state_update(state);
+                    performed_deep1 = true;
+                    break;
+                } else {
+                    // Push to the moves array
+                    moves[move_cursor].move = mv;
+                    moves[move_cursor].delta = results.cost[i];
+                    move_cursor++;
+                }
             }
         }
         swap_iter_destroy(&swap_iter);
@@ -105,33 +111,36 @@ void deep_local_search(heuristic_solver_state *state, void *arg) {
 
             // We have to perform the move to look at the neighbourhood.
             // If every move of the neighbourhood of this neighbourhood
-            // does not lead to a pair of move with delta < 0, we'll do
-            // the reverse move to go back to the original solution.
+            // does not lead to a pair of move with delta < 0, we'll roll
+            // back the transaction to go back to the original solution.
+            solution_begin(state->current_solution);
             swap_perform(state->current_solution, mv1,
                          NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
 
-            swap_iter_init(&swap_iter, state->current_solution);
-
-            while (swap_iter_next(&swap_iter)) {
-                swap_predict(state->current_solution, &swap_iter.move,
-                             NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
-                             NEIGHBOURHOOD_PREDICT_COST_IF_FEASIBLE,
-                             &swap_result);
-
-                if (!swap_result.feasible)
-                    continue;
-
-                if (swap_result.delta.cost + mv1_cost < 0) {
-                    verbose("%s: Diving = %d | Performing pair of moves with negative delta = %d (move 1 = %d, move 2 = %d)",
-                            state->methods_name[state->method],
-                            diving,
-                            mv1_cost + swap_result.delta.cost, mv1_cost, swap_result.delta.cost);
-                    swap_perform(state->current_solution, &swap_iter.move,
-                                NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
-                    state->current_cost += swap_result.delta.cost + mv1_cost;
-                    heuristic_solver_state_update(state);
-                    performed_deep_2 = true;
-                    break;
+            swap_iter_init_pruned(&swap_iter, state->current_solution);
+
+            while (!performed_deep_2 && (n_moves = swap_iter_next_batch(&swap_iter, &batch)) > 0) {
+                swap_predict_batch(state->current_solution, &batch, n_moves, &results);
+
+                for (int j = 0; j < n_moves; j++) {
+                    if (!results.feasible[j])
+                        continue;
+
+                    if (results.cost[j] + mv1_cost < 0) {
+                        verbose("%s: Diving = %d | Performing pair of moves with negative delta = %d (move 1 = %d, move 2 = %d)",
+                                state->methods_name[state->method],
+                                diving,
+                                mv1_cost + results.cost[j], mv1_cost, results.cost[j]);
+                        swap_move mv;
+                        swap_moves_get(state->current_solution, &batch, j, &mv);
+                        swap_perform(state->current_solution, &mv,
+                                    NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
+                        solution_commit(state->current_solution);
+                        state->current_cost += results.cost[j] + mv1_cost;
+                        heuristic_solver_state_update(state);
+                        performed_deep_2 = true;
+                        break;
+                    }
                 }
             }
             swap_iter_destroy(&swap_iter);
@@ -142,13 +151,13 @@ void deep_local_search(heuristic_solver_state *state, void *arg) {
             }
 
             // Otherwise, no good pair of move -> go back
-            swap_move mv1_back;
-            swap_move_reverse(mv1, &mv1_back);
-
-            swap_perform(state->current_solution, &mv1_back,
-                         NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
+            solution_rollback(state->current_solution);
         }
 
         diving++;
     } while(!timeout && improved);
+
+    swap_results_destroy(&results);
+    swap_moves_destroy(&batch);
+    free(moves);
 }
@@ -1,6 +1,6 @@
 #include "hill_climbing.h"
 #include <math.h>
-#include "heuristics/neighbourhoods/swap.h"
+#include "heuristics/neighbourhoods/swap_sampler.h"
 #include "log/verbose.h"
 #include "timeout/timeout.h"
 #include "utils/mem_utils.h"
@@ -21,6 +21,9 @@ void hill_climbing(heuristic_solver_state *state, void *arg) {
     long idle = 0;
     long iter = 0;
 
+    swap_sampler sampler;
+    swap_sampler_init(&sampler, state->current_solution);
+
     // Exit conditions: timeout or exceed max_idle (eventually increased if near best)
     while (!timeout &&
             ((state->current_cost < round(params->near_best_ratio * state->best_cost)) ?
@@ -28,15 +31,12 @@ void hill_climbing(heuristic_solver_state *state, void *arg) {
         swap_move swap_mv;
         swap_result swap_result;
 
-        swap_move_generate_random_feasible_effective(state->current_solution, &swap_mv);
-        swap_predict(state->current_solution, &swap_mv,
-                     NEIGHBOURHOOD_PREDICT_FEASIBILITY_NEVER,
-                     NEIGHBOURHOOD_PREDICT_COST_ALWAYS,
-                     &swap_result);
+        swap_sampler_sample(&sampler, state->current_solution, &swap_mv, &swap_result);
 
         if (swap_result.delta.cost <= 0) {
             swap_perform(state->current_solution, &swap_mv,
                          NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
+            swap_sampler_update(&sampler, state->current_solution, &swap_mv);
             state->current_cost += swap_result.delta.cost;
             heuristic_solver_state_update(state);
         }
@@ -50,13 +50,17 @@ void hill_climbing(heuristic_solver_state *state, void *arg) {
 
         if (get_verbosity() >= 2 &&
             idle > 0 && idle % (params->max_idle > 0 ? (params->max_idle / 10) : 10000) == 0)
-            verbose2("%s: Iter = %ld | Idle progress = %ld/%ld (%.2f%%) | Current = %d | Local best = %d | Global best = %d",
+            verbose2("%s: Iter = %ld | Idle progress = %ld/%ld (%.2f%%) | Current = %d | Local best = %d | Global best = %d | "
+                     "Draws per move = %.2f",
                      state->methods_name[state->method],
                      iter, idle,
                      params->max_idle > 0 ? params->max_idle : 0,
                      params->max_idle > 0 ? (double) 100 * idle / params->max_idle : 0,
-                     state->current_cost, local_best_cost, state->best_cost);
+                     state->current_cost, local_best_cost, state->best_cost,
+                     (double) sampler.n_draws / sampler.n_samples);
 
         iter++;
     }
+
+    swap_sampler_destroy(&sampler);
 }
@@ -1,15 +1,97 @@
 #include "local_search.h"
 #include <math.h>
-#include "heuristics/neighbourhoods/swap.h"
+#include "heuristics/neighbourhoods/swap_scan.h"
 #include "utils/mem_utils.h"
+#include "utils/array_utils.h"
 #include "timeout/timeout.h"
+#include "log/debug.h"
 
 void local_search_params_default(local_search_params *params) {
     params->max_distance_from_best_ratio = -1;
+    params->threads = 1;
+    params->dont_look_bits = false;
+}
+
+/* First improving move of each block of the scan */
+typedef struct local_search_block {
+    bool found;
+    swap_move move;
+    int cost;
+} local_search_block;
+
+typedef struct local_search_scan {
+    swap_scan *scan;
+    const solution *solution;
+    local_search_block *blocks; // [b]
+} local_search_scan;
+
+static bool local_search_visit(int thread, int block,
+                               const swap_moves *moves, int n,
+                               const swap_results *results, void *arg) {
+    local_search_scan *ls = arg;
+
+    for (int i = 0; i < n; i++) {
+        if (results->feasible[i] && results->cost[i] < 0) {
+            local_search_block *b = &ls->blocks[block];
+            swap_moves_get(ls->solution, moves, i, &b->move);
+            b->cost = results->cost[i];
+            b->found = true;
+            swap_scan_stop_after(ls->scan, block);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static inline void wake_course(bool *active, int *n_inactive, int c) {
+    if (c >= 0 && !active[c]) {
+        active[c] = true;
+        (*n_inactive)--;
+    }
+}
+
+/*
+ * Clear the don't look bits of the courses whose moves might have
+ * changed by the move mv: the ones swapped, the ones that share curricula
+ * or teacher with them and the ones in the rooms and in the periods touched.
+ */
+static void wake_courses(const solution *sol, const swap_move *mv,
+                         bool *active, int *n_inactive) {
+    MODEL(sol->model);
+    const int courses[2] = {mv->helper.c1, mv->helper.c2};
+
+    for (int i = 0; i < 2; i++) {
+        const int c = courses[i];
+        if (c < 0)
+            continue;
+        for (int k = model->curriculas_of_course_offsets[c];
+             k < model->curriculas_of_course_offsets[c + 1]; k++) {
+            const int q = model->curriculas_of_course[k];
+            for (int j = model->courses_of_curricula_offsets[q];
+                 j < model->courses_of_curricula_offsets[q + 1]; j++)
+                wake_course(active, n_inactive, model->courses_of_curricula[j]);
+        }
+        const int t = model->teacher_of_course[c];
+        for (int j = model->courses_of_teacher_offsets[t];
+             j < model->courses_of_teacher_offsets[t + 1]; j++)
+            wake_course(active, n_inactive, model->courses_of_teacher[j]);
+        wake_course(active, n_inactive, c);
+    }
+
+    const int rooms[2] = {mv->helper.r1, mv->r2};
+    const int periods[2] = {mv->helper.d1 * S + mv->helper.s1, mv->d2 * S + mv->s2};
+    for (int i = 0; i < 2; i++) {
+        for (int p = 0; p < P; p++)
+            wake_course(active, n_inactive, sol->c_rds[INDEX2(rooms[i], R, p, P)]);
+        for (int r = 0; r < R; r++)
+            wake_course(active, n_inactive, sol->c_rds[INDEX2(r, R, periods[i], P)]);
+    }
 }
 
 void local_search(heuristic_solver_state *state, void *arg) {
     local_search_params *params = (local_search_params *) arg;
+    MODEL(state->model);
 
     if (params->max_distance_from_best_ratio > 0 &&
         state->current_cost > round(state->best_cost * params->max_distance_from_best_ratio)) {
@@ -18,31 +100,83 @@ void local_search(heuristic_solver_state *state, void *arg) {
 
     bool improved;
 
+    swap_scan scan;
+    swap_scan_init(&scan, model, params->threads);
+
+    local_search_scan ls;
+    ls.scan = &scan;
+    ls.solution = state->current_solution;
+    ls.blocks = mallocx(scan.n_blocks + 1, sizeof(local_search_block));
+
+    // Don't look bits: only the active courses are scanned
+    bool *active = mallocx(C, sizeof(bool));
+    FOR_C {
+        active[c] = true;
+    }
+    int n_inactive = 0;
+    int l_start = 0;
+
     // Exit conditions: timeout or local minimum reached
     do {
         improved = false;
 
-        swap_iter swap_iter;
-        swap_iter_init(&swap_iter, state->current_solution);
+        for (int b = 0; b <= scan.n_blocks; b++)
+            ls.blocks[b].found = false;
 
-        swap_result swap_result;
+        const bool scanned_all = n_inactive == 0;
+        if (params->dont_look_bits)
+            swap_scan_run_from(&scan, state->current_solution, l_start,
+                               scanned_all ? NULL : active, local_search_visit, &ls);
+        else
+            swap_scan_run(&scan, state->current_solution, local_search_visit, &ls);
 
-        while (swap_iter_next(&swap_iter)) {
-            swap_predict(state->current_solution, &swap_iter.move,
-                         NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
-                         NEIGHBOURHOOD_PREDICT_COST_IF_FEASIBLE,
-                         &swap_result);
+        // The first improving move of the neighbourhood is in the first block that has one
+        for (int b = 0; b < scan.n_run_blocks && !improved; b++) {
+            local_search_block *block = &ls.blocks[b];
 
-            if (swap_result.feasible && swap_result.delta.cost < 0) {
-                swap_perform(state->current_solution, &swap_iter.move,
-                         NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
-                state->current_cost += swap_result.delta.cost;
+            if (params->dont_look_bits) {
+                // The courses scanned before the move have no improving move
+                const int l_end = block->found ? block->move.l1 : scan.run_end[b];
+                for (int l = scan.run_begin[b]; l < l_end; l++) {
+                    const int c = model->course_of_lecture[l];
+                    n_inactive += active[c];
+                    active[c] = false;
+                }
+            }
+
+            if (block->found) {
+                swap_perform(state->current_solution, &block->move,
+                             NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
+                state->current_cost += block->cost;
                 heuristic_solver_state_update(state);
                 improved = true;
-                break;
+
+                if (params->dont_look_bits) {
+                    wake_courses(state->current_solution, &block->move, active, &n_inactive);
+                    // Resume from the course of the move
+                    l_start = block->move.l1;
+                    while (l_start > 0 &&
+                           model->course_of_lecture[l_start - 1] == block->move.helper.c1)
+                        l_start--;
+                }
             }
         }
 
-        swap_iter_destroy(&swap_iter);
+        debug("%s: scanned %d moves (%d duplicates skipped)",
+              state->methods_name[state->method], scan.n_moves, scan.n_duplicates);
+
+        // No improving move among the active courses: since the don't look
+        // bits are a guess, confirm the local minimum scanning all of them
+        if (params->dont_look_bits && !improved && !scanned_all) {
+            FOR_C {
+                active[c] = true;
+            }
+            n_inactive = 0;
+            improved = true;
+        }
     } while(!timeout && improved);
+
+    free(active);
+    free(ls.blocks);
+    swap_scan_destroy(&scan);
 }
@@ -7,10 +7,20 @@
  * Local Search.
  * Performs the first seen improving move of the neighbourhood
  * until such a move exists, therefore reaches a local minimum.
+ *
+ * `threads`: number of threads scanning the neighbourhood (0: as many
+ *      as the cores); the move performed is the same for any number
+ *      of threads (see swap_scan.h)
+ * `dont_look_bits`: scan only the courses whose moves might have changed
+ *      since they were last scanned, resuming each scan from the course
+ *      of the last move performed; the local minimum is confirmed by a
+ *      scan of the whole neighbourhood
  */
 
 typedef struct local_search_params {
     double max_distance_from_best_ratio;
+    int threads;
+    bool dont_look_bits;
 } local_search_params;
 
 void local_search_params_default(local_search_params *params);
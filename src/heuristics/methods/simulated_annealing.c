@@ -1,6 +1,6 @@
 #include "simulated_annealing.h"
 #include <math.h>
-#include "heuristics/neighbourhoods/swap.h"
+#include "heuristics/neighbourhoods/swap_sampler.h"
 #include "utils/rand_utils.h"
 #include "timeout/timeout.h"
 #include "log/verbose.h"
@@ -45,6 +45,9 @@ void simulated_annealing(heuristic_solver_state *state, void *arg) {
     long idle = 0;
     long iter = 0;
 
+    swap_sampler sampler;
+    swap_sampler_init(&sampler, state->current_solution);
+
     // Exit conditions: timeout or below minimum temperature
     while (!timeout &&
             ((state->current_cost < round(params->near_best_ratio * state->best_cost)) ?
@@ -54,15 +57,12 @@ void simulated_annealing(heuristic_solver_state *state, void *arg) {
             swap_move swap_mv;
             swap_result swap_result;
 
-            swap_move_generate_random_feasible_effective(state->current_solution, &swap_mv);
-            swap_predict(state->current_solution, &swap_mv,
-                         NEIGHBOURHOOD_PREDICT_FEASIBILITY_NEVER,
-                         NEIGHBOURHOOD_PREDICT_COST_ALWAYS,
-                         &swap_result);
+            swap_sampler_sample(&sampler, state->current_solution, &swap_mv, &swap_result);
 
             if (simulated_annealing_accept(state, &swap_result, t)) {
                 swap_perform(state->current_solution, &swap_mv,
                              NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
+                swap_sampler_update(&sampler, state->current_solution, &swap_mv);
                 state->current_cost += swap_result.delta.cost;
                 heuristic_solver_state_update(state);
             }
@@ -80,12 +80,12 @@ void simulated_annealing(heuristic_solver_state *state, void *arg) {
                 verbose2("%s: Iter = %ld | Idle = %ld | "
                          "Current = %d | Local best = %d | Global best = %d | "
                          "Temperature = %.5f | p(+1) = %g  p(+5) = %g  p(+10) = %g | "
-                         "T_length = %d | Cooling Rate = %.5f",
+                         "T_length = %d | Cooling Rate = %.5f | Draws per move = %.2f",
                          state->methods_name[state->method],
                          iter, idle,
                          state->current_cost, local_best_cost, state->best_cost,
                          t, SA_ACCEPTANCE(1, t), SA_ACCEPTANCE(5, t), SA_ACCEPTANCE(10, t),
-                         t_len, cooling_rate);
+                         t_len, cooling_rate, (double) sampler.n_draws / sampler.n_samples);
             }
 
             iter++;
@@ -94,4 +94,6 @@ void simulated_annealing(heuristic_solver_state *state, void *arg) {
         // Decrease the temperature by cooling rate
         t *= cooling_rate;
     }
+
+    swap_sampler_destroy(&sampler);
 }
@@ -1,5 +1,5 @@
 #include "tabu_search.h"
-#include "heuristics/neighbourhoods/swap.h"
+#include "heuristics/neighbourhoods/swap_scan.h"
 #include "log/verbose.h"
 #include "timeout/timeout.h"
 #include "utils/mem_utils.h"
@@ -13,6 +13,7 @@ void tabu_search_params_default(tabu_search_params *params) {
     params->near_best_ratio = 1.02;
     params->tabu_tenure = 120;
     params->frequency_penalty_coeff = 0;
+    params->threads = 1;
 }
 
 typedef struct tabu_list_entry {
@@ -81,9 +82,77 @@ static void tabu_list_ban_move(tabu_list *tabu, swap_move *mv, long time) {
     tabu_list_ban_assignment(tabu, mv->helper.c2, mv->r2, mv->d2, mv->s2, time);
 }
 
+/* Best moves of each block of the scan */
+typedef struct tabu_search_block {
+    int best_cost;
+    swap_move *moves;   // the moves with cost best_cost, in scan order
+    int n_moves;
+    int capacity;
+    struct {
+        int n_banned_moves;
+        int n_side_moves;
+        int n_side_banned_moves;
+    } stats;
+} tabu_search_block;
+
+typedef struct tabu_search_scan {
+    const heuristic_solver_state *state;
+    tabu_list *tabu;
+    long iter;
+    bool stats;
+    tabu_search_block *blocks; // [b]
+} tabu_search_scan;
+
+static bool tabu_search_visit(int thread, int block,
+                              const swap_moves *moves, int n,
+                              const swap_results *results, void *arg) {
+    tabu_search_scan *ts = arg;
+    const heuristic_solver_state *state = ts->state;
+    tabu_search_block *b = &ts->blocks[block];
+
+    for (int i = 0; i < n; i++) {
+        if (!results->feasible[i])
+            continue;
+
+        const int cost = results->cost[i];
+        if (!ts->stats && cost > b->best_cost)
+            continue;
+
+        swap_move mv;
+        swap_moves_get(state->current_solution, moves, i, &mv);
+
+        if (ts->stats) {
+            bool banned = !tabu_list_move_is_allowed(ts->tabu, &mv, ts->iter);
+            bool side = cost == 0;
+            b->stats.n_banned_moves += banned;
+            b->stats.n_side_moves += side;
+            b->stats.n_side_banned_moves += (banned && side);
+        }
+
+        if (cost <= b->best_cost &&
+            // Accept only if move is not tabu-active
+            (tabu_list_move_is_allowed(ts->tabu, &mv, ts->iter) ||
+             // exception: aspiration criteria
+             state->current_cost + cost < state->best_cost)) {
+
+            if (cost < b->best_cost) {
+                b->n_moves = 0; // "clear" the best moves array
+                b->best_cost = cost;
+            }
+
+            if (b->n_moves == b->capacity) {
+                b->capacity = b->capacity ? 2 * b->capacity : SWAP_MOVES_BATCH_SIZE;
+                b->moves = reallocx(b->moves, b->capacity, sizeof(swap_move));
+            }
+            b->moves[b->n_moves++] = mv;
+        }
+    }
+
+    return true;
+}
+
 void tabu_search(heuristic_solver_state *state, void *arg) {
     tabu_search_params *params = (tabu_search_params *) arg;
-    MODEL(state->model);
     bool ts_stats = get_verbosity() >= 2;
 
     long max_idle = params->max_idle >= 0 ? params->max_idle : LONG_MAX;
@@ -97,7 +166,15 @@ void tabu_search(heuristic_solver_state *state, void *arg) {
     tabu_list_init(&tabu, state->model,
                    params->tabu_tenure, params->frequency_penalty_coeff);
 
-    swap_move *moves = mallocx(swap_neighbourhood_maximum_size(model), sizeof(swap_move));
+    swap_scan scan;
+    swap_scan_init(&scan, state->model, params->threads);
+
+    tabu_search_scan ts;
+    ts.state = state;
+    ts.tabu = &tabu;
+    ts.stats = ts_stats;
+    ts.blocks = callocx(scan.n_blocks, sizeof(tabu_search_block));
+
     struct {
         int n_banned_moves;
         int n_side_moves;
@@ -108,54 +185,54 @@ void tabu_search(heuristic_solver_state *state, void *arg) {
     while (!timeout &&
             ((state->current_cost < params->near_best_ratio * state->best_cost) ?
                 idle <= max_idle_near_best : idle <= max_idle)) {
-        swap_iter swap_iter;
-        swap_iter_init(&swap_iter, state->current_solution);
-
-        swap_result swap_result;
+        for (int b = 0; b < scan.n_blocks; b++) {
+            tabu_search_block *block = &ts.blocks[b];
+            block->best_cost = INT_MAX;
+            block->n_moves = 0;
+            block->stats.n_banned_moves = block->stats.n_side_moves =
+                    block->stats.n_side_banned_moves = 0;
+        }
+        ts.iter = iter;
 
-        int move_cursor = 0;
-        if (ts_stats)
-            stats.n_side_moves = stats.n_banned_moves = stats.n_side_banned_moves = 0;
+        swap_scan_run(&scan, state->current_solution, tabu_search_visit, &ts);
 
+        // The best moves of the neighbourhood are the best ones of the
+        // blocks, in block order
         int best_swap_cost = INT_MAX;
-
-        while (swap_iter_next(&swap_iter)) {
-            swap_predict(state->current_solution, &swap_iter.move,
-                         NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
-                         NEIGHBOURHOOD_PREDICT_COST_IF_FEASIBLE,
-                         &swap_result);
-
-            if (!swap_result.feasible)
-                continue;
-
-            if (ts_stats) {
-                bool banned = !tabu_list_move_is_allowed(&tabu, &swap_iter.move, iter);
-                bool side = swap_result.delta.cost == 0;
-                stats.n_banned_moves += banned;
-                stats.n_side_moves += side;
-                stats.n_side_banned_moves += (banned && side);
+        int move_cursor = 0;
+        for (int b = 0; b < scan.n_blocks; b++) {
+            const tabu_search_block *block = &ts.blocks[b];
+            if (block->best_cost < best_swap_cost) {
+                best_swap_cost = block->best_cost;
+                move_cursor = 0;
             }
+            if (block->best_cost == best_swap_cost)
+                move_cursor += block->n_moves;
+        }
 
-            if (swap_result.delta.cost <= best_swap_cost &&
-                // Accept only if move is not tabu-active
-                (tabu_list_move_is_allowed(&tabu, &swap_iter.move, iter) ||
-                 // exception: aspiration criteria
-                 state->current_cost + swap_result.delta.cost < state->best_cost)) {
-
-                if (swap_result.delta.cost < best_swap_cost) {
-                    move_cursor = 0; // "clear" the best moves array
-                    best_swap_cost = swap_result.delta.cost;
-                }
-
-                moves[move_cursor++] = swap_iter.move;
+        if (ts_stats) {
+            stats.n_side_moves = stats.n_banned_moves = stats.n_side_banned_moves = 0;
+            for (int b = 0; b < scan.n_blocks; b++) {
+                stats.n_banned_moves += ts.blocks[b].stats.n_banned_moves;
+                stats.n_side_moves += ts.blocks[b].stats.n_side_moves;
+                stats.n_side_banned_moves += ts.blocks[b].stats.n_side_banned_moves;
             }
         }
 
-        swap_iter_destroy(&swap_iter);
-
         if (best_swap_cost != INT_MAX) {
             // Pick a random move among the best ones
-            swap_move *mv = &moves[rand_range(0, move_cursor)];
+            int k = rand_range(0, move_cursor);
+            swap_move *mv = NULL;
+            for (int b = 0; !mv; b++) {
+                tabu_search_block *block = &ts.blocks[b];
+                if (block->best_cost != best_swap_cost)
+                    continue;
+                if (k < block->n_moves)
+                    mv = &block->moves[k];
+                else
+                    k -= block->n_moves;
+            }
+
             swap_perform(state->current_solution, mv,
                          NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
 
@@ -177,19 +254,23 @@ void tabu_search(heuristic_solver_state *state, void *arg) {
             verbose2("%s: Iter = %ld | Idle progress = %ld/%ld (%.2f%%) | "
                      "Current = %d | Local best = %d | Global best = %d | "
                      "# Banned = %d/%d | # Side = %d/%d (%d/%d banned) | "
-                     "# Elite = %d (cost = %d)",
+                     "# Duplicates skipped = %d | # Elite = %d (cost = %d)",
                      state->methods_name[state->method],
                      iter, idle,
                      params->max_idle > 0 ? params->max_idle : 0,
                      params->max_idle > 0 ? (double) 100 * idle / params->max_idle : 0,
                      state->current_cost, local_best_cost, state->best_cost,
-                     stats.n_banned_moves, swap_iter.i, stats.n_side_moves, swap_iter.i,
-                     stats.n_side_banned_moves, stats.n_side_moves, move_cursor, best_swap_cost);
+                     stats.n_banned_moves, scan.n_moves, stats.n_side_moves, scan.n_moves,
+                     stats.n_side_banned_moves, stats.n_side_moves,
+                     scan.n_duplicates, move_cursor, best_swap_cost);
         }
 
         iter++;
     }
 
+    for (int b = 0; b < scan.n_blocks; b++)
+        free(ts.blocks[b].moves);
+    free(ts.blocks);
+    swap_scan_destroy(&scan);
     tabu_list_destroy(&tabu);
-    free(moves);
 }
@@ -14,6 +14,9 @@
  *
  * `frequency_penalty_coeff` increases the ban time of a move
  *      by `frequency_penalty_coeff` * freq(move)
+ * `threads`: number of threads scanning the neighbourhood (0: as many
+ *      as the cores); the best moves are collected in the same order
+ *      for any number of threads (see swap_scan.h)
  */
 
 typedef struct tabu_search_params {
@@ -22,6 +25,7 @@ typedef struct tabu_search_params {
     double near_best_ratio;
     int tabu_tenure;
     double frequency_penalty_coeff;
+    int threads;
 } tabu_search_params;
 
 void tabu_search_params_default(tabu_search_params *params);
@@ -1,12 +1,29 @@
 #include "swap.h"
+#include <limits.h>
 #include "log/debug.h"
 #include "utils/io_utils.h"
+#include "utils/mem_utils.h"
 #include "utils/rand_utils.h"
 #include "utils/array_utils.h"
 #include "utils/assert_utils.h"
 #include "solution/solution.h"
 #include "model/model.h"
 
+/*
+ * The AVX2 kernel of swap_predict_batch is opt-in (it is not faster than
+ * the scalar one on every instance), and needs x86-64, GCC builtins
+ * and the default layout and width of the counters.
+ */
+#if defined(SWAP_AVX2) && \
+    !(defined(__x86_64__) && defined(__GNUC__) && \
+      SOLUTION_COUNTER_BITS == 32 && !defined(SOLUTION_PERIOD_MAJOR))
+#undef SWAP_AVX2
+#endif
+#ifdef SWAP_AVX2
+#include <immintrin.h>
+#endif
+
+static bool swap_vectorization = true;
 
 /*
  * Returns 'true' if course c1 can be assigned
@@ -23,8 +40,9 @@ static bool check_lectures_constraint(
     const bool same_course = c1 == c2;
 
     if (c1 >= 0) {
-        debug2("Check H1b (Lectures) (c=%d, d=%d, s=%d) -> %d", c1, d2, s2, sol->sum_cds[INDEX3(c1, C, d2, D, s2, S)]);
-        if (sol->sum_cds[INDEX3(c1, C, d2, D, s2, S)] - same_period - same_course > 0)
+        const int p2 = PERIOD(d2, s2);
+        debug2("Check H1b (Lectures) (c=%d, d=%d, s=%d) -> %d", c1, d2, s2, SUM_CDS(sol, c1, p2));
+        if (SUM_CDS(sol, c1, p2) - same_period - same_course > 0)
             return false;
     }
 
@@ -44,16 +62,39 @@ static bool check_conflicts_curriculum_constraint(
     MODEL(sol->model);
     const bool same_period = d1 == d2 && s1 == s2;
 
-    if (c1 >= 0) {
+    if (c1 < 0)
+        return true;
+
+    const int p2 = PERIOD(d2, s2);
+
+    if (same_period) {
+        // Rare (only the room changes): check the counters
         int c1_n_curriculas;
         int *c1_curriculas = model_curriculas_of_course(model, c1, &c1_n_curriculas);
         for (int cq = 0; cq < c1_n_curriculas; cq++) {
             const int q = c1_curriculas[cq];
             bool share_curricula = c2 >= 0 && model_share_curricula(model, c1, c2, q);
-            debug2("Check H3a (Conflicts) (q=%d, d=%d, s=%d) -> %d", q, d2, s2, sol->sum_qds[INDEX3(q, Q, d2, D, s2, S)]);
-            if (sol->sum_qds[INDEX3(q, Q, d2, D, s2, S)] - same_period - share_curricula > 0)
+            debug2("Check H3a (Conflicts) (q=%d, d=%d, s=%d) -> %d", q, d2, s2, SUM_QDS(sol, q, p2));
+            if (SUM_QDS(sol, q, p2) - 1 - share_curricula > 0)
                 return false;
         }
+        return true;
+    }
+
+    // A curricula of c1 conflicts if it's busy in p2, or crowded
+    // if c2 (which leaves p2) belongs to it as well
+    const int W = model->curriculas_bitset_words;
+    const uint64_t *busy = &sol->busy_pq[INDEX2(p2, P, 0, W)];
+    const uint64_t *crowded = &sol->crowded_pq[INDEX2(p2, P, 0, W)];
+    const uint64_t *c1_curriculas = &model->curriculas_of_course_bitset[INDEX2(c1, C, 0, W)];
+    const uint64_t *c2_curriculas = c2 >= 0 ?
+            &model->curriculas_of_course_bitset[INDEX2(c2, C, 0, W)] : NULL;
+
+    for (int w = 0; w < W; w++) {
+        const uint64_t shared = c2_curriculas ? c1_curriculas[w] & c2_curriculas[w] : 0;
+        debug2("Check H3a (Conflicts) (w=%d, d=%d, s=%d)", w, d2, s2);
+        if (((busy[w] & c1_curriculas[w] & ~shared) | (crowded[w] & shared)) != 0)
+            return false;
     }
 
     return true;
@@ -74,9 +115,9 @@ static bool check_conflicts_teacher_constraint(
     const bool same_period = d1 == d2 && s1 == s2;
 
     if (c1 >= 0) {
-        const int t1 = model->courses[c1].teacher->index;
+        const int t1 = model->teacher_of_course[c1];
         debug2("Check H3b (Conflicts) (t=%d, d=%d, s=%d)", t1, d2, s2);
-        if (sol->sum_tds[INDEX3(t1, T, d2, D, s2, S)] - same_period - same_teacher > 0)
+        if (SUM_TDS(sol, t1, PERIOD(d2, s2)) - same_period - same_teacher > 0)
             return false;
     }
 
@@ -103,95 +144,113 @@ static bool check_availabilities_constraint(
 }
 
 /*
- * Compute 'RoomCapacity' cost of assigning c1
- * - to (day=d2, slot=s2)
+ * Compute 'RoomCapacity' cost of swapping c1
+ * - from room r1 to room r2
+ * and c2 (eventually)
+ * - from room r2 to room r1
  *
  * [For each lecture, the number of students that attend the course must be
  *  less or equal than the number of seats of all the rooms that host its lectures.
  *  Each student above the capacity counts as 1 point of penalty]
  */
 static int compute_room_capacity_cost(
-        const solution *sol, int c1, int r1, int r2) {
-    if (c1 < 0)
-        return 0;
+        const solution *sol, int c1, int r1, int c2, int r2) {
+    MODEL(sol->model);
+    const int *penalty = model->room_capacity_penalty;
 
-    int cost =
-        MIN(0, sol->model->rooms[r1].capacity - sol->model->courses[c1].n_students) +
-        MAX(0, sol->model->courses[c1].n_students - sol->model->rooms[r2].capacity);
+    int cost = 0;
+    if (c1 >= 0)
+        cost += penalty[INDEX2(c1, C, r2, R)] - penalty[INDEX2(c1, C, r1, R)];
+    if (c2 >= 0)
+        cost += penalty[INDEX2(c2, C, r1, R)] - penalty[INDEX2(c2, C, r2, R)];
     cost *= ROOM_CAPACITY_COST_FACTOR;
 
     debug2("RoomCapacity delta cost: %d", cost);
     return cost;
 }
 
+/* Change of the 'MinimumWorkingDays' penalty of moving a lecture of c from day d1 to d2 */
+static inline int min_working_days_penalty_delta(const solution *sol, int c, int d1, int d2) {
+    MODEL(sol->model);
+    const int min_working_days = model->courses[c].min_working_days;
+    const int prev_working_days = sol->working_days_c[c];
+    const int cur_working_days = prev_working_days -
+            (sol->sum_cd[INDEX2(c, C, d1, D)] == 1) +
+            (sol->sum_cd[INDEX2(c, C, d2, D)] == 0);
+    return MIN(0, prev_working_days - min_working_days) +
+           MAX(0, min_working_days - cur_working_days);
+}
+
 /*
- * Compute 'MinimumWorkingDays' cost of assigning c1
- * - from day d2
- * - to day d2 (previously occupied by c2)
+ * Compute 'MinimumWorkingDays' cost of swapping c1
+ * - from day d1 to day d2
+ * and c2 (eventually)
+ * - from day d2 to day d1
  *
  * [The lectures of each course must be spread into the given mini-
  *  mum number of days. Each day below the minimum counts as 5 points of penalty]
  */
 static int compute_min_working_days_cost(
         const solution *sol, int c1, int d1, int c2, int d2) {
-
-    if (c1 < 0)
-        return 0;
-    if (c1 == c2)
+    if (c1 == c2 || d1 == d2)
         return 0;
 
-    MODEL(sol->model);
-
-    int min_working_days = sol->model->courses[c1].min_working_days;
-    int prev_working_days = 0;
-    int cur_working_days = 0;
-    FOR_D {
-        prev_working_days += MIN(1, sol->sum_cd[INDEX2(c1, C, d, D)]);
-        cur_working_days += MIN(1, sol->sum_cd[INDEX2(c1, C, d, D)] - (d == d1) + (d == d2));
-    }
-
-    int cost =
-            MIN(0, prev_working_days - min_working_days) +
-            MAX(0, min_working_days - cur_working_days);
+    int cost = 0;
+    if (c1 >= 0)
+        cost += min_working_days_penalty_delta(sol, c1, d1, d2);
+    if (c2 >= 0)
+        cost += min_working_days_penalty_delta(sol, c2, d2, d1);
     cost *= MIN_WORKING_DAYS_COST_FACTOR;
 
     debug2("MinWorkingDays delta cost: %d", cost);
     return cost;
 }
 
+/* Change of the 'RoomStability' penalty of moving a lecture of c from room r1 to r2 */
+static inline int room_stability_penalty_delta(const solution *sol, int c, int r1, int r2) {
+    MODEL(sol->model);
+    const int prev_rooms = sol->used_rooms_c[c];
+    const int cur_rooms = prev_rooms -
+            (sol->sum_cr[INDEX2(c, C, r1, R)] == 1) +
+            (sol->sum_cr[INDEX2(c, C, r2, R)] == 0);
+    return MAX(0, cur_rooms - 1) - MAX(0, prev_rooms - 1);
+}
+
 /*
- * Compute 'RoomStability' cost of assigning c1
- * - from room r1
- * - to room r2 (previously occupied by c2)
+ * Compute 'RoomStability' cost of swapping c1
+ * - from room r1 to room r2
+ * and c2 (eventually)
+ * - from room r2 to room r1
  *
  * [All lectures of a course should be given in the same room. Each distinct
  *  room used for the lectures of a course, but the first, counts as 1 point of penalty]
  */
 static int compute_room_stability_cost(
         const solution *sol, int c1, int r1, int c2, int r2) {
-    if (c1 < 0)
+    if (c1 == c2 || r1 == r2)
         return 0;
-    if (r1 == r2)
-        return 0;
-    if (c1 == c2)
-        return 0;
-
-    MODEL(sol->model);
-
-    int prev_rooms = 0;
-    int cur_rooms = 0;
-    FOR_R {
-        prev_rooms += MIN(1, sol->sum_cr[INDEX2(c1, C, r, R)]);
-        cur_rooms += MIN(1, sol->sum_cr[INDEX2(c1, C, r, R)] - (r == r1) + (r == r2));
-    };
 
-    int cost = MAX(0, cur_rooms - 1) - MAX(0, prev_rooms - 1);
+    int cost = 0;
+    if (c1 >= 0)
+        cost += room_stability_penalty_delta(sol, c1, r1, r2);
+    if (c2 >= 0)
+        cost += room_stability_penalty_delta(sol, c2, r2, r1);
     cost *= ROOM_STABILITY_COST_FACTOR;
 
     debug2("RoomStability delta cost: %d", cost);
     return cost;
 }
 
+/* Slots of the mask `slots` holding a lecture with no lecture in the adjacent slots */
+static inline uint64_t isolated_slots(uint64_t slots) {
+    return slots & ~(slots << 1) & ~(slots >> 1);
+}
+
+/* Mask of the slots s - 1, s and s + 1 */
+static inline uint64_t slots_around(int s) {
+    return ((uint64_t) 7 << s) >> 1;
+}
+
 /*
  * Compute 'CurriculumCompactness' cost of assigning c1
  * - from (day=d1, slot=s1)
@@ -211,51 +270,28 @@ static int compute_curriculum_compactness_cost(
 
     MODEL(sol->model);
 
-#define QDS(q, d, s) \
-    ((s) >= 0 && (s) < S && sol->sum_qds[INDEX3(q, Q, d, D, s, S)])
-
-#define QDS_OUT_AFTER(q, d, s) \
-    (!((d) == d1 && (s) == s1) && \
-    ((QDS(q, d, s))))
-
-#define QDS_IN_BEFORE(q, d, s) \
-    (!((d) == d1 && (s) == s1) && \
-    ((QDS(q, d, s))))
-
-#define QDS_IN_AFTER(q, d, s) \
-    (((s) == s2 && (d) == d2) || \
-    (!((d) == d1 && (s) == s1) && \
-    ((QDS(q, d, s)))))
-
-#define ALONE_OUT_BEFORE(q, d, s) \
-    (QDS(q, d, s) && !QDS(q, d, (s) - 1) && !QDS(q, d, (s) + 1))
-
-#define ALONE_OUT_AFTER(q, d, s) \
-    (QDS_OUT_AFTER(q, d, s) && !QDS_OUT_AFTER(q, d, (s) - 1) && !QDS_OUT_AFTER(q, d, (s) + 1))
-
-#define ALONE_IN_BEFORE(q, d, s) \
-    (QDS_IN_BEFORE(q, d, s) && !QDS_IN_BEFORE(q, d, (s) - 1) && !QDS_IN_BEFORE(q, d, (s) + 1))
-
-#define ALONE_IN_AFTER(q, d, s) \
-    (QDS_IN_AFTER(q, d, s) && !QDS_IN_AFTER(q, d, (s) - 1) && !QDS_IN_AFTER(q, d, (s) + 1))
-    
-    
     int cost = 0;
 
     int c_n_curriculas;
     int *c_curriculas = model_curriculas_of_course(model, c1, &c_n_curriculas);
 
+    const uint64_t slot1 = (uint64_t) 1 << s1;
+    const uint64_t slot2 = (uint64_t) 1 << s2;
+    const uint64_t around1 = slots_around(s1);
+    const uint64_t around2 = slots_around(s2);
+
     /*
      * The logic for compute the compactness cost is the following:
      * for each curricula the course c1 belongs to:
      * - if c2 share a curriculum with c1, no cost is introduced
      * - otherwise:
-     *      the cost is given by summing the cost of taking c1 out
-     *      of (d1, s1), minus the bonus of placing c1 into (d2, s2);
-     *      the costs depend on whether the curriculum has any adjacent
-     *      lecture or not.
-     *  It might seems a little bit messy: it is.
-     *  By the way, what follows works, if the current solution if feasible.
+     *      the cost is given by the isolated lectures around (d1, s1)
+     *      after taking c1 out of it, minus the ones before, plus the
+     *      isolated lectures around (d2, s2) after placing c1 into it,
+     *      minus the ones before (but c1 itself).
+     *  Only the slots of each day of the curricula are considered
+     *  (slots_qd), not how many lectures there are in each one:
+     *  what follows works, if the current solution if feasible.
      */
     for (int cq = 0; cq < c_n_curriculas; cq++) {
         int q = c_curriculas[cq];
@@ -263,41 +299,23 @@ static int compute_curriculum_compactness_cost(
         if (c2 >= 0 && model_share_curricula(model, c2, c1, q))
             continue; // swap of courses of the same curriculum has no cost
 
-        int out_prev_cost_before = ALONE_OUT_BEFORE(q, d1, s1 - 1);
-        int out_itself_cost = ALONE_OUT_BEFORE(q, d1, s1);
-        int out_next_cost_before = ALONE_OUT_BEFORE(q, d1, s1 + 1);
-
-        int out_prev_cost_after = ALONE_OUT_AFTER(q, d1, s1 - 1);
-        int out_next_cost_after = ALONE_OUT_AFTER(q, d1, s1 + 1);
-
-        int in_prev_cost_before = ALONE_IN_BEFORE(q, d2, s2 - 1);
-        int in_next_cost_before = ALONE_IN_BEFORE(q, d2, s2 + 1);
-        int in_prev_cost_after = ALONE_IN_AFTER(q, d2, s2 - 1);
-        int in_next_cost_after = ALONE_IN_AFTER(q, d2, s2 + 1);
-
-        int in_itself_cost = ALONE_IN_AFTER(q, d2, s2);
+        const uint64_t out_before = sol->slots_qd[INDEX2(q, Q, d1, D)];
+        const uint64_t out_after = out_before & ~slot1;
+        const uint64_t in_before = sol->slots_qd[INDEX2(q, Q, d2, D)] & ~(d1 == d2 ? slot1 : 0);
+        const uint64_t in_after = in_before | slot2;
 
         int q_cost =
-            (out_prev_cost_after - out_prev_cost_before) +
-            (out_next_cost_after - out_next_cost_before) +
-            (in_prev_cost_after - in_prev_cost_before) +
-            (in_next_cost_after - in_next_cost_before) +
-            (in_itself_cost - out_itself_cost);
+            __builtin_popcountll(isolated_slots(out_after) & around1) -
+            __builtin_popcountll(isolated_slots(out_before) & around1) +
+            __builtin_popcountll(isolated_slots(in_after) & around2) -
+            __builtin_popcountll(isolated_slots(in_before) & around2 & ~slot2);
 
         debug2("compute_curriculum_compactness_cost q=%d:%s\n"
-                "   c1=%d, d1=%d, s1=%d, c2=%d, d2=%d, s2=%d\n"
-                "   (out_prev_cost_after %d   -  out_prev_cost_before %d) +\n"
-                "   (out_next_cost_after %d   -  out_next_cost_before %d) +\n"
-                "   (in_prev_cost_after  %d   -  in_prev_cost_before  %d) +\n"
-                "   (in_next_cost_after  %d   -  out_prev_cost_before %d) +\n"
-                "   (in_itself_cost      %d   -  out_itself_cost      %d) = %d",
+               "   c1=%d, d1=%d, s1=%d, c2=%d, d2=%d, s2=%d\n"
+               "   out (%#lx -> %#lx), in (%#lx -> %#lx) = %d",
                q, model->curriculas[q].id,
                c1, d1, s1, c2, d2, s2,
-               out_prev_cost_after, out_prev_cost_before,
-               out_next_cost_after, out_next_cost_before,
-               in_prev_cost_after, in_prev_cost_before,
-               in_next_cost_after, in_next_cost_before,
-               in_itself_cost, out_itself_cost,
+               out_before, out_after, in_before, in_after,
                q_cost
         );
         cost += q_cost;
@@ -307,18 +325,64 @@ static int compute_curriculum_compactness_cost(
 
     debug2("CurriculumCompactness delta cost: %d", cost);
 
-#undef QDS
-#undef QDS_OUT_AFTER
-#undef QDS_IN_BEFORE
-#undef QDS_IN_AFTER
-#undef ALONE_OUT_BEFORE
-#undef ALONE_OUT_AFTER
-#undef ALONE_IN_BEFORE
-#undef ALONE_IN_AFTER
-
     return cost;
 }
 
+/*
+ * compute_curriculum_compactness_cost split in the part that depends only
+ * on the source (d1, s1) of c1, computed once for all the moves of a lecture
+ * (the isolated lectures around (d1, s1) after taking c1 out of it, minus the
+ * ones before, for each curricula of c1), and the rest.
+ */
+static void compute_curriculum_compactness_out_costs(
+        const solution *sol, int c1, int d1, int s1, int *out_costs) {
+    MODEL(sol->model);
+
+    int c_n_curriculas;
+    int *c_curriculas = model_curriculas_of_course(model, c1, &c_n_curriculas);
+
+    const uint64_t slot1 = (uint64_t) 1 << s1;
+    const uint64_t around1 = slots_around(s1);
+
+    for (int cq = 0; cq < c_n_curriculas; cq++) {
+        const uint64_t out_before = sol->slots_qd[INDEX2(c_curriculas[cq], Q, d1, D)];
+        const uint64_t out_after = out_before & ~slot1;
+        out_costs[cq] =
+            __builtin_popcountll(isolated_slots(out_after) & around1) -
+            __builtin_popcountll(isolated_slots(out_before) & around1);
+    }
+}
+
+static int compute_curriculum_compactness_cost_from(
+        const solution *sol, int c1, int d1, int s1, int c2, int d2, int s2,
+        const int *out_costs) {
+    MODEL(sol->model);
+
+    int cost = 0;
+
+    int c_n_curriculas;
+    int *c_curriculas = model_curriculas_of_course(model, c1, &c_n_curriculas);
+
+    const uint64_t slot1 = (uint64_t) 1 << s1;
+    const uint64_t slot2 = (uint64_t) 1 << s2;
+    const uint64_t around2 = slots_around(s2);
+
+    for (int cq = 0; cq < c_n_curriculas; cq++) {
+        int q = c_curriculas[cq];
+
+        if (c2 >= 0 && model_share_curricula(model, c2, c1, q))
+            continue;
+
+        const uint64_t in_before = sol->slots_qd[INDEX2(q, Q, d2, D)] & ~(d1 == d2 ? slot1 : 0);
+        const uint64_t in_after = in_before | slot2;
+
+        cost += out_costs[cq] +
+            __builtin_popcountll(isolated_slots(in_after) & around2) -
+            __builtin_popcountll(isolated_slots(in_before) & around2 & ~slot2);
+    }
+
+    return cost * CURRICULUM_COMPACTNESS_COST_FACTOR;
+}
 
 static bool swap_move_check_hard_constraints(const solution *sol,
                                              const swap_move *mv) {
@@ -378,41 +442,22 @@ static void swap_move_compute_cost(
         const solution *sol,
         const swap_move *mv,
         swap_result *result) {
-    MODEL(sol->model);
-    static int non_gave_up = 0;
-    static int gave_up = 0;
-
-    result->delta.room_capacity_cost = 0;
-    result->delta.min_working_days_cost = 0;
-    result->delta.curriculum_compactness_cost = 0;
-    result->delta.room_stability_cost = 0;
-
-    // Room capacity
-    result->delta.room_capacity_cost +=
-            compute_room_capacity_cost(sol, mv->helper.c1, mv->helper.r1, mv->r2);
-    result->delta.room_capacity_cost +=
-            compute_room_capacity_cost(sol, mv->helper.c2, mv->r2, mv->helper.r1);
-
-    // MinWorkingDays
-    result->delta.min_working_days_cost +=
+    // Room capacity, MinWorkingDays and RoomStability: both the directions at once
+    result->delta.room_capacity_cost =
+            compute_room_capacity_cost(sol, mv->helper.c1, mv->helper.r1, mv->helper.c2, mv->r2);
+    result->delta.min_working_days_cost =
             compute_min_working_days_cost(sol, mv->helper.c1, mv->helper.d1, mv->helper.c2, mv->d2);
-    result->delta.min_working_days_cost +=
-            compute_min_working_days_cost(sol, mv->helper.c2, mv->d2, mv->helper.c1, mv->helper.d1);
+    result->delta.room_stability_cost =
+            compute_room_stability_cost(sol, mv->helper.c1, mv->helper.r1, mv->helper.c2, mv->r2);
 
     // CurriculumCompactness
-    result->delta.curriculum_compactness_cost +=
+    result->delta.curriculum_compactness_cost =
             compute_curriculum_compactness_cost(
                     sol, mv->helper.c1, mv->helper.d1, mv->helper.s1, mv->helper.c2, mv->d2, mv->s2);
     result->delta.curriculum_compactness_cost +=
             compute_curriculum_compactness_cost(
                     sol, mv->helper.c2, mv->d2, mv->s2, mv->helper.c1, mv->helper.d1, mv->helper.s1);
 
-    // RoomStability
-    result->delta.room_stability_cost +=
-            compute_room_stability_cost(sol, mv->helper.c1, mv->helper.r1, mv->helper.c2, mv->r2);
-    result->delta.room_stability_cost +=
-            compute_room_stability_cost(sol, mv->helper.c2, mv->r2, mv->helper.c1, mv->helper.r1);
-
     result->delta.cost =
             result->delta.room_capacity_cost +
             result->delta.min_working_days_cost +
@@ -427,6 +472,11 @@ static void swap_move_do(solution *sol, const swap_move *mv) {
     assert(sol->assignments[mv->l1].d == mv->helper.d1);
     assert(sol->assignments[mv->l1].s == mv->helper.s1);
 
+    if (mv->helper.l2 == mv->l1)
+        // Moving a lecture to its own (r,d,s): nothing to do
+        // (otherwise the lecture would be assigned twice)
+        return;
+
     solution_unassign_lecture(sol, mv->l1);
     if (mv->helper.l2 >= 0)
         solution_unassign_lecture(sol, mv->helper.l2);
@@ -438,16 +488,73 @@ static void swap_move_do(solution *sol, const swap_move *mv) {
 void swap_iter_init(swap_iter *iter, const solution *sol) {
     iter->solution = sol;
     iter->move.l1 = iter->move.r2 = iter->move.d2 = iter->move.s2 = -1;
+    iter->l_end = sol->model->n_lectures;
     iter->end = false;
     iter->i = 0;
+    iter->pruned = false;
+    iter->courses = NULL;
+    iter->n_duplicates = 0;
+    iter->periods = NULL;
+    iter->kinds = NULL;
+    iter->n_periods = iter->cursor = 0;
 }
 
-void swap_iter_destroy(swap_iter *iter) {}
+void swap_iter_init_pruned(swap_iter *iter, const solution *sol) {
+    swap_iter_init_pruned_range(iter, sol, 0, sol->model->n_lectures);
+}
+
+void swap_iter_init_pruned_range(swap_iter *iter, const solution *sol,
+                                 int l_begin, int l_end) {
+    MODEL(sol->model);
+    swap_iter_init(iter, sol);
+    iter->pruned = true;
+    iter->periods = mallocx(P, sizeof(int));
+    iter->kinds = mallocx(P, sizeof(char));
+    iter->move.l1 = l_begin - 1;
+    iter->move.r2 = R; // the first swap_iter_next goes to the first lecture
+    iter->move.helper.c1 = -1;
+    iter->l_end = l_end;
+}
+
+void swap_iter_destroy(swap_iter *iter) {
+    free(iter->periods);
+    free(iter->kinds);
+}
 
 bool swap_move_is_effective(const swap_move *mv) {
     return mv->helper.c1 != mv->helper.c2; // swap of the same course is not effective
 }
 
+/*
+ * Returns 'true' if the move has the same outcome (feasibility and cost)
+ * of a move that comes before it in the order of swap_iter, i.e. if
+ * - l1 goes to an empty room r2 not used by c1, while a previous room of
+ *   the same class (same capacity) is empty and not used by c1 as well
+ * - l1 is swapped with a lecture of an interchangeable course in the same
+ *   room and day (the outcome is the same solution, but for the names
+ *   of the two courses)
+ */
+bool swap_move_is_symmetric(const solution *sol, const swap_move *mv) {
+    MODEL(sol->model);
+    const int c1 = mv->helper.c1;
+    const int c2 = mv->helper.c2;
+
+    if (c2 >= 0)
+        return model->course_class[c1] == model->course_class[c2] &&
+               mv->r2 == mv->helper.r1 && mv->d2 == mv->helper.d1;
+
+    int r = model->room_class_prev[mv->r2];
+    if (r < 0 || sol->sum_cr[INDEX2(c1, C, mv->r2, R)])
+        return false;
+
+    for (; r >= 0; r = model->room_class_prev[r])
+        if (sol->l_rds[INDEX3(r, R, mv->d2, D, mv->s2, S)] < 0 &&
+            !sol->sum_cr[INDEX2(c1, C, r, R)])
+            return true;
+
+    return false;
+}
+
 /*
  * Compute the swap_move's data that depends on the current solution.
  * (Will be valid until the solution is touched).
@@ -455,7 +562,7 @@ bool swap_move_is_effective(const swap_move *mv) {
 void swap_move_compute_helper(const solution *sol, swap_move *mv) {
     MODEL(sol->model);
 
-    mv->helper.c1 = sol->model->lectures[mv->l1].course->index;
+    mv->helper.c1 = sol->model->course_of_lecture[mv->l1];
 
     const assignment *a = &sol->assignments[mv->l1];
     mv->helper.r1 = a->r;
@@ -464,7 +571,7 @@ void swap_move_compute_helper(const solution *sol, swap_move *mv) {
 
     mv->helper.l2 = sol->l_rds[INDEX3(mv->r2, R, mv->d2, D, mv->s2, S)];
     if (mv->helper.l2 >= 0)
-        mv->helper.c2 = sol->model->lectures[mv->helper.l2].course->index;
+        mv->helper.c2 = sol->model->course_of_lecture[mv->helper.l2];
     else
         mv->helper.c2 = -1;
 
@@ -495,7 +602,8 @@ void swap_move_generate_random_extended(const solution *sol, swap_move *mv,
     do {
         do {
             swap_move_generate_random_raw(sol, mv);
-        } while (require_effectiveness && !swap_move_is_effective(mv));
+        } while (require_effectiveness &&
+                 (!swap_move_is_effective(mv) || swap_move_is_symmetric(sol, mv)));
 
         if (require_feasibility)
             swap_predict(sol, mv,
@@ -524,13 +632,142 @@ void swap_move_reverse(const swap_move *mv, swap_move *reverse_mv) {
 }
 
 
+/*
+ * Compute the periods the lectures of course c1 might be moved to, once
+ * for all its lectures (which are indistinguishable but for their position).
+ * Since swap_iter enumerates only moves with c2 < c1, a period p2 is
+ * certainly infeasible for a lecture of c1 in p1 != p2 if
+ * - c1 is not available in p2
+ * - c1 has already a lecture in p2 (c2 != c1 does not free it)
+ * - the teacher of c1 has two lectures in p2 (c2 can free only one)
+ * - a curricula of c1 has two lectures in p2 (c2 can free only one)
+ * and it is infeasible for an empty target room (c2 = -1) if the teacher
+ * or a curricula of c1 has a lecture in p2.
+ */
+static inline int swap_compute_period_kind(const solution *sol, int c1, int t1,
+                                           const uint64_t *c1_curriculas, int p) {
+    MODEL(sol->model);
+    const int W = model->curriculas_bitset_words;
+
+    if (SUM_CDS(sol, c1, p) > 0)
+        return SWAP_ITER_PERIOD_OWN;
+
+    if (!model_course_is_available_on_period(model, c1, p / S, p % S) ||
+        SUM_TDS(sol, t1, p) > 1)
+        return -1;
+
+    const uint64_t *busy = &sol->busy_pq[INDEX2(p, P, 0, W)];
+    const uint64_t *crowded = &sol->crowded_pq[INDEX2(p, P, 0, W)];
+    bool conflict = false, busy_curricula = false;
+    for (int w = 0; w < W && !conflict; w++) {
+        conflict = (crowded[w] & c1_curriculas[w]) != 0;
+        busy_curricula |= (busy[w] & c1_curriculas[w]) != 0;
+    }
+    if (conflict)
+        return -1;
+    if (busy_curricula || SUM_TDS(sol, t1, p) > 0)
+        return SWAP_ITER_PERIOD_BUSY;
+    return SWAP_ITER_PERIOD_FREE;
+}
+
+static void swap_iter_compute_periods(swap_iter *iter, int c1) {
+    const solution *sol = iter->solution;
+    MODEL(sol->model);
+
+    const int t1 = model->teacher_of_course[c1];
+    const int W = model->curriculas_bitset_words;
+    const uint64_t *c1_curriculas = &model->curriculas_of_course_bitset[INDEX2(c1, C, 0, W)];
+
+    iter->n_periods = 0;
+    for (int p = 0; p < P; p++) {
+        const int kind = swap_compute_period_kind(sol, c1, t1, c1_curriculas, p);
+        if (kind < 0)
+            continue;
+        iter->kinds[iter->n_periods] = (char) kind;
+        iter->periods[iter->n_periods++] = p;
+    }
+}
+
+int swap_period_kind(const solution *sol, int c, int p) {
+    MODEL(sol->model);
+    const int W = model->curriculas_bitset_words;
+    return swap_compute_period_kind(
+            sol, c, model->teacher_of_course[c],
+            &model->curriculas_of_course_bitset[INDEX2(c, C, 0, W)], p);
+}
+
+/*
+ * Walk the occupied positions of each course (its lectures, in order)
+ * and, for each of them, the target cells in the periods of the course.
+ */
+static bool swap_iter_next_pruned(swap_iter *iter) {
+    const solution *sol = iter->solution;
+    MODEL(sol->model);
+    swap_move *mv = &iter->move;
+
+    while (true) {
+        if (++iter->cursor >= iter->n_periods) {
+            iter->cursor = 0;
+            if (++mv->r2 >= R) {
+                mv->r2 = 0;
+                do {
+                    if (++mv->l1 >= iter->l_end) {
+                        debug2("Iter exhausted after %d iters", iter->i);
+                        iter->end = true;
+                        return false;
+                    }
+                } while (iter->courses && !iter->courses[model->course_of_lecture[mv->l1]]);
+
+                const int c1 = model->course_of_lecture[mv->l1];
+                if (c1 != mv->helper.c1)
+                    swap_iter_compute_periods(iter, c1);
+
+                const assignment *a = &sol->assignments[mv->l1];
+                mv->helper.c1 = c1;
+                mv->helper.r1 = a->r;
+                mv->helper.d1 = a->d;
+                mv->helper.s1 = a->s;
+            }
+        }
+
+        const int p2 = iter->periods[iter->cursor];
+        mv->d2 = p2 / S;
+        mv->s2 = p2 % S;
+        mv->helper.l2 = sol->l_rds[INDEX3(mv->r2, R, mv->d2, D, mv->s2, S)];
+        mv->helper.c2 = mv->helper.l2 >= 0 ? model->course_of_lecture[mv->helper.l2] : -1;
+
+        if (mv->helper.c1 <= mv->helper.c2) {
+            iter->n_duplicates++;
+            continue;
+        }
+        if (iter->kinds[iter->cursor] == SWAP_ITER_PERIOD_OWN ?
+                mv->d2 != mv->helper.d1 || mv->s2 != mv->helper.s1 :
+                iter->kinds[iter->cursor] == SWAP_ITER_PERIOD_BUSY && mv->helper.c2 < 0)
+            continue;
+        if (swap_move_is_symmetric(sol, mv)) {
+            iter->n_duplicates++;
+            continue;
+        }
+        return true;
+    }
+}
+
 bool swap_iter_next(swap_iter *iter) {
     if (iter->end)
         return false;
 
+    if (iter->pruned) {
+        if (!swap_iter_next_pruned(iter))
+            return false;
+        debug2("swap_iter_next: l=%d -> (r=%d, d=%d, s=%d)",
+               iter->move.l1, iter->move.r2, iter->move.d2, iter->move.s2);
+        iter->i++;
+        return true;
+    }
+
     MODEL(iter->solution->model);
 
-    do {
+    while (true) {
         iter->move.s2 = (iter->move.s2 + 1) % S;
         if (!iter->move.s2) {
             iter->move.d2 = (iter->move.d2 + 1) % D;
@@ -538,7 +775,7 @@ bool swap_iter_next(swap_iter *iter) {
                 iter->move.r2 = (iter->move.r2 + 1) % R;
                 if (!iter->move.r2) {
                     iter->move.l1 = (iter->move.l1 + 1);
-                    if (!(iter->move.l1 < L)) {
+                    if (!(iter->move.l1 < iter->l_end)) {
                         debug2("Iter exhausted after %d iters", iter->i);
                         iter->end = true;
                         return false;
@@ -547,7 +784,11 @@ bool swap_iter_next(swap_iter *iter) {
             }
         }
         swap_move_compute_helper(iter->solution, &iter->move);
-    } while (iter->move.helper.c1 <= iter->move.helper.c2);
+        if (iter->move.helper.c1 > iter->move.helper.c2 &&
+            !swap_move_is_symmetric(iter->solution, &iter->move))
+            break;
+        iter->n_duplicates++;
+    }
 
     assert(swap_move_is_effective(&iter->move));
 
@@ -560,6 +801,304 @@ bool swap_iter_next(swap_iter *iter) {
 }
 
 
+int swap_iter_next_batch(swap_iter *iter, swap_moves *moves) {
+    int n = 0;
+    if (iter->pruned) {
+        // Inline the pruned iteration in the loop
+        while (n < moves->capacity && !iter->end && swap_iter_next_pruned(iter)) {
+            moves->l1[n] = iter->move.l1;
+            moves->r2[n] = iter->move.r2;
+            moves->d2[n] = iter->move.d2;
+            moves->s2[n] = iter->move.s2;
+            n++;
+        }
+        iter->i += n;
+        return n;
+    }
+
+    while (n < moves->capacity && swap_iter_next(iter)) {
+        moves->l1[n] = iter->move.l1;
+        moves->r2[n] = iter->move.r2;
+        moves->d2[n] = iter->move.d2;
+        moves->s2[n] = iter->move.s2;
+        n++;
+    }
+    return n;
+}
+
+void swap_moves_init(swap_moves *moves, int capacity) {
+    moves->l1 = mallocx(capacity, sizeof(int));
+    moves->r2 = mallocx(capacity, sizeof(int));
+    moves->d2 = mallocx(capacity, sizeof(int));
+    moves->s2 = mallocx(capacity, sizeof(int));
+    moves->capacity = capacity;
+}
+
+void swap_moves_destroy(swap_moves *moves) {
+    free(moves->l1);
+    free(moves->r2);
+    free(moves->d2);
+    free(moves->s2);
+}
+
+void swap_moves_get(const solution *sol, const swap_moves *moves, int i, swap_move *mv) {
+    mv->l1 = moves->l1[i];
+    mv->r2 = moves->r2[i];
+    mv->d2 = moves->d2[i];
+    mv->s2 = moves->s2[i];
+    swap_move_compute_helper(sol, mv);
+}
+
+void swap_results_init(swap_results *results, int capacity) {
+    results->feasible = mallocx(capacity, sizeof(bool));
+    results->cost = mallocx(capacity, sizeof(int));
+    results->lecture = NULL;
+}
+
+static void swap_lecture_data_destroy(struct swap_lecture_data *lec);
+
+void swap_results_destroy(swap_results *results) {
+    free(results->feasible);
+    free(results->cost);
+    if (results->lecture) {
+        swap_lecture_data_destroy(results->lecture);
+        free(results->lecture);
+    }
+}
+
+bool swap_vectorization_supported() {
+#ifdef SWAP_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+void swap_set_vectorization(bool enabled) {
+    swap_vectorization = enabled;
+}
+
+static bool courses_share_curricula(const model *model, int c1, int c2) {
+    const int W = model->curriculas_bitset_words;
+    const uint64_t *c1_curriculas = &model->curriculas_of_course_bitset[c1 * W];
+    const uint64_t *c2_curriculas = &model->curriculas_of_course_bitset[c2 * W];
+    for (int w = 0; w < W; w++)
+        if (c1_curriculas[w] & c2_curriculas[w])
+            return true;
+    return false;
+}
+
+/* Data of the lecture l1, shared by all its moves, for swap_predict_batch */
+typedef struct swap_lecture_data {
+    const model *model;
+    int l1, c1, r1, d1, s1, p1, t1;
+    int *out_costs;     // [cq] see compute_curriculum_compactness_out_costs
+    int *costs;         // [p] MinWorkingDays and CurriculumCompactness delta of c1
+                        //     moving to p, if c2 shares no curricula with c1
+                        //     (computed when needed, INT_MIN before)
+
+    /* Of the moves of l1 to the room r2 */
+    int r2;
+    int room_cost;      // RoomCapacity and RoomStability delta of c1
+    bool vectorized;    // c2 and candidate are loaded for all the periods,
+                        // otherwise just for the period of the current move
+    int *c2;            // [p] course in (r2, p), or -1
+    bool *candidate;    // [p] the checks of c1 alone pass (or c1 == c2)
+} swap_lecture_data;
+
+static void swap_lecture_data_init(swap_lecture_data *lec, const model *m) {
+    MODEL(m);
+    lec->model = m;
+    lec->out_costs = mallocx(Q, sizeof(int));
+    lec->costs = mallocx(P, sizeof(int));
+    lec->c2 = mallocx(P, sizeof(int));
+    lec->candidate = mallocx(P, sizeof(bool));
+}
+
+static void swap_lecture_data_destroy(swap_lecture_data *lec) {
+    free(lec->out_costs);
+    free(lec->costs);
+    free(lec->c2);
+    free(lec->candidate);
+}
+
+static void swap_lecture_data_load(swap_lecture_data *lec, const solution *sol, int l1) {
+    MODEL(sol->model);
+    const assignment *a = &sol->assignments[l1];
+    lec->l1 = l1;
+    lec->c1 = model->course_of_lecture[l1];
+    lec->r1 = a->r;
+    lec->d1 = a->d;
+    lec->s1 = a->s;
+    lec->p1 = PERIOD(a->d, a->s);
+    lec->t1 = model->teacher_of_course[lec->c1];
+    lec->r2 = -1;
+
+    compute_curriculum_compactness_out_costs(sol, lec->c1, lec->d1, lec->s1, lec->out_costs);
+    for (int p = 0; p < P; p++)
+        lec->costs[p] = INT_MIN;
+}
+
+static int swap_lecture_cost(swap_lecture_data *lec, const solution *sol, int d2, int s2) {
+    MODEL(sol->model);
+    int *cost = &lec->costs[PERIOD(d2, s2)];
+    if (*cost == INT_MIN)
+        *cost = compute_min_working_days_cost(sol, lec->c1, lec->d1, -1, d2) +
+                compute_curriculum_compactness_cost_from(
+                        sol, lec->c1, lec->d1, lec->s1, -1, d2, s2, lec->out_costs);
+    return *cost;
+}
+
+/*
+ * Checks of swap_move_check_hard_constraints that depend on c1 only
+ * (Lectures, Availabilities and Teacher Conflicts of c1 moving to p)
+ * for the move of l1 to (r2, p).
+ */
+static inline void swap_lecture_room_period(swap_lecture_data *lec, const solution *sol, int r2, int p) {
+    MODEL(sol->model);
+    const int l2 = sol->l_rds[INDEX2(r2, R, p, P)];
+    const int c2 = l2 >= 0 ? model->course_of_lecture[l2] : -1;
+    const bool same_period = p == lec->p1;
+    const bool same_teacher = c2 >= 0 && model->teacher_of_course[c2] == lec->t1;
+
+    lec->c2[p] = c2;
+    lec->candidate[p] = c2 == lec->c1 || (
+            SUM_CDS(sol, lec->c1, p) - same_period <= 0 &&
+            model->course_availabilities[INDEX2(lec->c1, C, p, P)] &&
+            SUM_TDS(sol, lec->t1, p) - same_period - same_teacher <= 0);
+}
+
+#ifdef SWAP_AVX2
+/* swap_lecture_room_period for all the periods, 8 at a time */
+__attribute__((target("avx2")))
+static void swap_lecture_room_load_avx2(swap_lecture_data *lec, const solution *sol, int r2) {
+    MODEL(sol->model);
+
+    const int *l2_row = &sol->l_rds[INDEX2(r2, R, 0, P)];
+    const int *c1_cds = &sol->sum_cds[COUNTER_INDEX(lec->c1, C, 0)];
+    const int *t1_tds = &sol->sum_tds[COUNTER_INDEX(lec->t1, T, 0)];
+    const bool *c1_availabilities = &model->course_availabilities[INDEX2(lec->c1, C, 0, P)];
+
+    const __m256i minus_one = _mm256_set1_epi32(-1);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i c1 = _mm256_set1_epi32(lec->c1);
+    const __m256i t1 = _mm256_set1_epi32(lec->t1);
+    const __m256i p1 = _mm256_set1_epi32(lec->p1);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    int p = 0;
+    for (; p + 8 <= P; p += 8) {
+        const __m256i l2 = _mm256_loadu_si256((const __m256i *) &l2_row[p]);
+        const __m256i occupied = _mm256_cmpgt_epi32(l2, minus_one);
+        const __m256i c2 = _mm256_mask_i32gather_epi32(
+                minus_one, model->course_of_lecture, l2, occupied, sizeof(int));
+        const __m256i t2 = _mm256_mask_i32gather_epi32(
+                minus_one, model->teacher_of_course, c2, occupied, sizeof(int));
+
+        // Comparisons give -1 for true, so x - same_period <= 0 is x + same_period < 1
+        const __m256i same_period = _mm256_cmpeq_epi32(
+                _mm256_add_epi32(_mm256_set1_epi32(p), lanes), p1);
+        const __m256i same_teacher = _mm256_cmpeq_epi32(t2, t1);
+        const __m256i cds = _mm256_loadu_si256((const __m256i *) &c1_cds[p]);
+        const __m256i tds = _mm256_loadu_si256((const __m256i *) &t1_tds[p]);
+        const __m256i available = _mm256_cmpgt_epi32(
+                _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) &c1_availabilities[p])),
+                _mm256_setzero_si256());
+
+        const __m256i lectures_ok = _mm256_cmpgt_epi32(one, _mm256_add_epi32(cds, same_period));
+        const __m256i teacher_ok = _mm256_cmpgt_epi32(
+                one, _mm256_add_epi32(_mm256_add_epi32(tds, same_period), same_teacher));
+        const __m256i candidate = _mm256_or_si256(
+                _mm256_cmpeq_epi32(c2, c1),
+                _mm256_and_si256(_mm256_and_si256(lectures_ok, teacher_ok), available));
+
+        _mm256_storeu_si256((__m256i *) &lec->c2[p], c2);
+        const int mask = _mm256_movemask_ps(_mm256_castsi256_ps(candidate));
+        for (int k = 0; k < 8; k++)
+            lec->candidate[p + k] = (mask >> k) & 1;
+    }
+
+    for (; p < P; p++)
+        swap_lecture_room_period(lec, sol, r2, p);
+}
+#endif
+
+static void swap_lecture_room_load(swap_lecture_data *lec, const solution *sol, int r2) {
+    lec->r2 = r2;
+    lec->room_cost =
+            compute_room_capacity_cost(sol, lec->c1, lec->r1, -1, r2) +
+            compute_room_stability_cost(sol, lec->c1, lec->r1, -1, r2);
+#ifdef SWAP_AVX2
+    lec->vectorized = swap_vectorization && __builtin_cpu_supports("avx2");
+    if (lec->vectorized)
+        swap_lecture_room_load_avx2(lec, sol, r2);
+#else
+    lec->vectorized = false;
+#endif
+}
+
+void swap_predict_batch(const solution *sol, const swap_moves *moves, int n,
+                        swap_results *results) {
+    MODEL(sol->model);
+
+    swap_lecture_data *lec = results->lecture;
+    if (!lec || lec->model != model) {
+        if (lec)
+            swap_lecture_data_destroy(lec);
+        else
+            lec = results->lecture = mallocx(1, sizeof(swap_lecture_data));
+        swap_lecture_data_init(lec, model);
+    }
+    lec->l1 = -1; // the solution might have changed since the last batch
+
+    for (int i = 0; i < n; i++) {
+        // Load the data of the lecture (and of the room) once for all its moves
+        if (moves->l1[i] != lec->l1)
+            swap_lecture_data_load(lec, sol, moves->l1[i]);
+        if (moves->r2[i] != lec->r2)
+            swap_lecture_room_load(lec, sol, moves->r2[i]);
+
+        const int c1 = lec->c1, r1 = lec->r1, d1 = lec->d1, s1 = lec->s1;
+        const int r2 = moves->r2[i], d2 = moves->d2[i], s2 = moves->s2[i];
+        if (!lec->vectorized)
+            swap_lecture_room_period(lec, sol, r2, PERIOD(d2, s2));
+        const int c2 = lec->c2[PERIOD(d2, s2)];
+
+        if (c1 == c2) {
+            // Swap of two lectures of the same course: always legal, no cost
+            results->feasible[i] = true;
+            results->cost[i] = 0;
+            continue;
+        }
+
+        // The rest of the checks of swap_move_check_hard_constraints
+        results->feasible[i] =
+                lec->candidate[PERIOD(d2, s2)] &&
+                check_lectures_constraint(sol, c2, d2, s2, c1, d1, s1) &&
+                check_availabilities_constraint(sol, c2, d1, s1) &&
+                check_conflicts_teacher_constraint(sol, c2, d2, s2, c1, d1, s1) &&
+                check_conflicts_curriculum_constraint(sol, c1, d1, s1, c2, d2, s2) &&
+                check_conflicts_curriculum_constraint(sol, c2, d2, s2, c1, d1, s1);
+
+        if (!results->feasible[i])
+            continue;
+
+        int cost = lec->room_cost;
+        if (c2 >= 0 && courses_share_curricula(model, c1, c2))
+            cost += compute_min_working_days_cost(sol, c1, d1, -1, d2) +
+                    compute_curriculum_compactness_cost_from(sol, c1, d1, s1, c2, d2, s2, lec->out_costs);
+        else
+            cost += swap_lecture_cost(lec, sol, d2, s2);
+
+        if (c2 >= 0)
+            cost += compute_room_capacity_cost(sol, -1, r1, c2, r2) +
+                    compute_min_working_days_cost(sol, -1, d1, c2, d2) +
+                    compute_room_stability_cost(sol, -1, r1, c2, r2) +
+                    compute_curriculum_compactness_cost(sol, c2, d2, s2, c1, d1, s1);
+        results->cost[i] = cost;
+    }
+}
+
 void swap_predict(const solution *sol, const swap_move *move,
                   neighbourhood_predict_feasibility_strategy predict_feasibility,
                   neighbourhood_predict_cost_strategy predict_cost,
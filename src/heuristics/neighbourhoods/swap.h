@@ -26,11 +26,28 @@ typedef struct swap_move {
     } helper;
 } swap_move;
 
+/*
+ * Symmetric moves (see swap_move_is_symmetric) are neither enumerated
+ * by swap_iter nor generated by swap_move_generate_random_extended
+ * (if require_effectiveness is true): an equivalent move is always
+ * enumerated in their place (before them).
+ */
 typedef struct swap_iter {
     const solution *solution;
     swap_move move;
     bool end;
+    int l_end;      // enumerates the moves of the lectures before l_end
     int i;
+    int n_duplicates; // moves skipped since equivalent to an enumerated one (or to none)
+
+    /* Pruned mode (see swap_iter_init_pruned). */
+    bool pruned;
+    const bool *courses;    // if not NULL, only the lectures of the courses
+                            // c with courses[c] are enumerated
+    int *periods;   // periods the lectures of c1 might be moved to
+    char *kinds;    // [i] kind of periods[i] (see swap.c)
+    int n_periods;
+    int cursor;     // position of d2,s2 in periods
 } swap_iter;
 
 typedef struct swap_result {
@@ -44,13 +61,56 @@ typedef struct swap_result {
     } delta;
 } swap_result;
 
+/*
+ * Batch of moves, as parallel arrays (structure of arrays), for
+ * predicting many moves at once with swap_predict_batch.
+ */
+#define SWAP_MOVES_BATCH_SIZE 256
+typedef struct swap_moves {
+    int *l1;            // [i]
+    int *r2, *d2, *s2;  // [i]
+    int capacity;
+} swap_moves;
+
+typedef struct swap_results {
+    bool *feasible;     // [i]
+    int *cost;          // [i] delta cost (only if feasible)
+    struct swap_lecture_data *lecture; // scratch of swap_predict_batch
+} swap_results;
+
 int swap_neighbourhood_maximum_size(const model *m);
 
 void swap_iter_init(swap_iter *iter, const solution *sol);
+/*
+ * Like swap_iter_init, but walks the positions of each course, since its
+ * lectures are indistinguishable: the periods a course can go to are
+ * computed once for all of its lectures.
+ * Skips (without computing their helper) the moves that are certainly
+ * infeasible because of the course of l1 alone:
+ * periods unavailable for it, already used by it, or in which its teacher
+ * or one of its curricula is busy beyond what the swapped lecture can free
+ * (or busy at all, if the target room is empty).
+ * The feasible moves are enumerated all and in the same order of swap_iter_init.
+ * The solution must not change while iterating.
+ */
+void swap_iter_init_pruned(swap_iter *iter, const solution *sol);
+/* Like swap_iter_init_pruned, but only for the lectures in [l_begin, l_end). */
+void swap_iter_init_pruned_range(swap_iter *iter, const solution *sol,
+                                 int l_begin, int l_end);
 void swap_iter_destroy(swap_iter *iter);
 bool swap_iter_next(swap_iter *iter);
+/* Fill moves with the next (at most moves->capacity) moves; returns their number. */
+int swap_iter_next_batch(swap_iter *iter, swap_moves *moves);
+
+void swap_moves_init(swap_moves *moves, int capacity);
+void swap_moves_destroy(swap_moves *moves);
+void swap_moves_get(const solution *sol, const swap_moves *moves, int i, swap_move *mv);
+
+void swap_results_init(swap_results *results, int capacity);
+void swap_results_destroy(swap_results *results);
 
 bool swap_move_is_effective(const swap_move *mv);
+bool swap_move_is_symmetric(const solution *sol, const swap_move *mv);
 void swap_move_compute_helper(const solution *sol, swap_move *mv);
 void swap_move_copy(swap_move *dest, const swap_move *src);
 void swap_move_reverse(const swap_move *mv, swap_move *reverse_mv);
@@ -60,10 +120,46 @@ void swap_move_generate_random_extended(const solution *sol, swap_move *mv,
                                         bool require_effectiveness, bool require_feasibility);
 void swap_move_generate_random_feasible_effective(const solution *sol, swap_move *mv);
 
+/* Kinds of the periods of swap_iter's pruned mode. */
+enum {
+    SWAP_ITER_PERIOD_FREE,      // feasible for c1 (as far as c1 alone is concerned)
+    SWAP_ITER_PERIOD_BUSY,      // feasible only if c2 frees the teacher/curricula of c1
+    SWAP_ITER_PERIOD_OWN        // c1 has a lecture here: feasible only for that lecture
+};
+
+/*
+ * Kind of the period p for the lectures of course c, or -1 if moving a
+ * lecture of c to p is certainly infeasible because of c alone: p is
+ * unavailable for c, or the teacher or a curricula of c has two lectures
+ * in p (see swap_iter_init_pruned).
+ */
+int swap_period_kind(const solution *sol, int c, int p);
+
 void swap_predict(const solution *sol, const swap_move *move,
                   neighbourhood_predict_feasibility_strategy predict_feasibility,
                   neighbourhood_predict_cost_strategy predict_cost,
                   swap_result *result);
+/*
+ * Predict the feasibility and, for the feasible ones, the delta cost of
+ * the first n moves (as swap_predict with NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS
+ * and NEIGHBOURHOOD_PREDICT_COST_IF_FEASIBLE would do).
+ * Consecutive moves of the same lecture (as swap_iter enumerates them)
+ * share the data of the lecture; for each run of moves of the same lecture
+ * and room, the checks of the lecture alone are computed for all the periods
+ * of the room at once (with AVX2, if supported by the CPU), and its cost
+ * once per period.
+ */
+void swap_predict_batch(const solution *sol, const swap_moves *moves, int n,
+                        swap_results *results);
+
+/*
+ * Whether the vectorized kernels of swap_predict_batch are built
+ * (cmake -DSWAP_AVX2=ON) and supported by the CPU.
+ */
+bool swap_vectorization_supported();
+/* Use the vectorized kernels, if supported (default: true). */
+void swap_set_vectorization(bool enabled);
+
 bool swap_perform(solution *sol, const swap_move *move,
                   neighbourhood_perform_strategy perform,
                   swap_result *result);
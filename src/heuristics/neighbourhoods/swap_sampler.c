@@ -0,0 +1,216 @@
+#include "swap_sampler.h"
+#include "utils/mem_utils.h"
+#include "utils/rand_utils.h"
+#include "utils/array_utils.h"
+
+/* Fenwick tree of the number of moves of the courses (1-based in tree) */
+
+static void swap_sampler_tree_add(swap_sampler *sampler, int c, int64_t delta) {
+    const int C = sampler->model->n_courses;
+    for (int i = c + 1; i <= C; i += i & -i)
+        sampler->tree[i - 1] += delta;
+}
+
+static int64_t swap_sampler_tree_total(const swap_sampler *sampler) {
+    const int C = sampler->model->n_courses;
+    int64_t total = 0;
+    for (int i = C; i > 0; i -= i & -i)
+        total += sampler->tree[i - 1];
+    return total;
+}
+
+/* The course c of the (cumulative) number of moves x, and x relative to c */
+static int swap_sampler_tree_find(const swap_sampler *sampler, int64_t *x) {
+    const int C = sampler->model->n_courses;
+    int i = 0;
+    for (int step = sampler->tree_top; step > 0; step >>= 1) {
+        if (i + step <= C && sampler->tree[i + step - 1] <= *x) {
+            i += step;
+            *x -= sampler->tree[i - 1];
+        }
+    }
+    return i;
+}
+
+/* Moves of a lecture of c: any room of the free periods and of its own one,
+ * and a room of the busy periods */
+static int swap_sampler_lecture_moves(const swap_sampler *sampler, int c) {
+    const int R = sampler->model->n_rooms;
+    return R * (sampler->n_periods[SWAP_ITER_PERIOD_FREE][c] + 1) +
+           sampler->n_periods[SWAP_ITER_PERIOD_BUSY][c];
+}
+
+static void swap_sampler_set_kind(swap_sampler *sampler, int c, int p, int kind) {
+    MODEL(sampler->model);
+    if (kind == SWAP_ITER_PERIOD_OWN)
+        kind = -1; // only the own period of each lecture
+    char *old_kind = &sampler->kinds[INDEX2(c, C, p, P)];
+    if (kind == *old_kind)
+        return;
+
+    const int old_moves = swap_sampler_lecture_moves(sampler, c);
+    int *position = &sampler->position[INDEX2(c, C, p, P)];
+
+    if (*old_kind >= 0) {
+        // Swap with the last one
+        int *periods = &sampler->periods[(int) *old_kind][INDEX2(c, C, 0, P)];
+        const int last = periods[--sampler->n_periods[(int) *old_kind][c]];
+        periods[*position] = last;
+        sampler->position[INDEX2(c, C, last, P)] = *position;
+    }
+    if (kind >= 0) {
+        *position = sampler->n_periods[kind][c]++;
+        sampler->periods[kind][INDEX2(c, C, *position, P)] = p;
+    }
+    *old_kind = (char) kind;
+
+    swap_sampler_tree_add(sampler, c, (int64_t) model->courses[c].n_lectures *
+                                      (swap_sampler_lecture_moves(sampler, c) - old_moves));
+}
+
+void swap_sampler_init(swap_sampler *sampler, const solution *sol) {
+    MODEL(sol->model);
+    sampler->model = model;
+    sampler->first_lecture = mallocx(C, sizeof(int));
+    sampler->kinds = mallocx(C * P, sizeof(char));
+    sampler->position = mallocx(C * P, sizeof(int));
+    for (int kind = 0; kind < 2; kind++) {
+        sampler->periods[kind] = mallocx(C * P, sizeof(int));
+        sampler->n_periods[kind] = callocx(C, sizeof(int));
+    }
+    sampler->tree = callocx(C, sizeof(int64_t));
+    sampler->n_draws = sampler->n_samples = 0;
+
+    sampler->tree_top = 1;
+    while (sampler->tree_top * 2 <= C)
+        sampler->tree_top *= 2;
+
+    // The lectures of a course are contiguous
+    for (int l = L - 1; l >= 0; l--)
+        sampler->first_lecture[model->course_of_lecture[l]] = l;
+
+    for (int i = 0; i < C * P; i++)
+        sampler->kinds[i] = -1;
+
+    FOR_C {
+        swap_sampler_tree_add(sampler, c, (int64_t) model->courses[c].n_lectures *
+                                          swap_sampler_lecture_moves(sampler, c));
+        for (int p = 0; p < P; p++)
+            swap_sampler_set_kind(sampler, c, p, swap_period_kind(sol, c, p));
+    }
+}
+
+void swap_sampler_destroy(swap_sampler *sampler) {
+    free(sampler->first_lecture);
+    free(sampler->kinds);
+    free(sampler->position);
+    for (int kind = 0; kind < 2; kind++) {
+        free(sampler->periods[kind]);
+        free(sampler->n_periods[kind]);
+    }
+    free(sampler->tree);
+}
+
+/* The room of a lecture in p of a course with the teacher or a curricula of c */
+static int swap_sampler_busy_room(const solution *sol, int c, int p) {
+    MODEL(sol->model);
+    const int W = model->curriculas_bitset_words;
+    const uint64_t *c_curriculas = &model->curriculas_of_course_bitset[INDEX2(c, C, 0, W)];
+
+    FOR_R {
+        const int l = sol->l_rds[INDEX2(r, R, p, P)];
+        if (l < 0)
+            continue;
+        const int c2 = model->course_of_lecture[l];
+        if (model->teacher_of_course[c2] == model->teacher_of_course[c])
+            return r;
+        const uint64_t *c2_curriculas = &model->curriculas_of_course_bitset[INDEX2(c2, C, 0, W)];
+        for (int w = 0; w < W; w++)
+            if (c_curriculas[w] & c2_curriculas[w])
+                return r;
+    }
+
+    return 0; // not reached
+}
+
+void swap_sampler_sample(swap_sampler *sampler, const solution *sol,
+                         swap_move *mv, swap_result *result) {
+    MODEL(sol->model);
+    const int64_t total = swap_sampler_tree_total(sampler);
+
+    do {
+        sampler->n_draws++;
+
+        // A lecture and one of its moves, uniformly
+        int64_t y = rand_range64(0, total);
+        const int c = swap_sampler_tree_find(sampler, &y);
+        const int n_free = sampler->n_periods[SWAP_ITER_PERIOD_FREE][c];
+        const int lecture_moves = swap_sampler_lecture_moves(sampler, c);
+        mv->l1 = sampler->first_lecture[c] + (int) (y / lecture_moves);
+        const int x = (int) (y % lecture_moves);
+
+        int p;
+        if (x < R * n_free) {
+            p = sampler->periods[SWAP_ITER_PERIOD_FREE][INDEX2(c, C, x / R, P)];
+            mv->r2 = x % R;
+        } else if (x < R * (n_free + 1)) {
+            const assignment *a = &sol->assignments[mv->l1];
+            p = a->d * S + a->s;
+            mv->r2 = x - R * n_free;
+        } else {
+            p = sampler->periods[SWAP_ITER_PERIOD_BUSY][INDEX2(c, C, x - R * (n_free + 1), P)];
+            mv->r2 = swap_sampler_busy_room(sol, c, p);
+        }
+        mv->d2 = p / S;
+        mv->s2 = p % S;
+        swap_move_compute_helper(sol, mv);
+
+        if (!swap_move_is_effective(mv) || swap_move_is_symmetric(sol, mv)) {
+            result->feasible = false;
+            continue;
+        }
+
+        swap_predict(sol, mv,
+                     NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
+                     NEIGHBOURHOOD_PREDICT_COST_IF_FEASIBLE,
+                     result);
+    } while (!result->feasible);
+
+    sampler->n_samples++;
+}
+
+static void swap_sampler_update_course(swap_sampler *sampler, const solution *sol,
+                                       int c, int p1, int p2) {
+    swap_sampler_set_kind(sampler, c, p1, swap_period_kind(sol, c, p1));
+    swap_sampler_set_kind(sampler, c, p2, swap_period_kind(sol, c, p2));
+}
+
+void swap_sampler_update(swap_sampler *sampler, const solution *sol, const swap_move *mv) {
+    MODEL(sol->model);
+    const int p1 = mv->helper.d1 * S + mv->helper.s1;
+    const int p2 = mv->d2 * S + mv->s2;
+    if (p1 == p2)
+        return; // only the rooms changed
+
+    // Only the periods p1 and p2 of the courses of the teachers
+    // and of the curriculas of c1 and c2 might have changed
+    const int courses[2] = {mv->helper.c1, mv->helper.c2};
+    for (int i = 0; i < 2; i++) {
+        const int c = courses[i];
+        if (c < 0)
+            continue;
+
+        const int t = model->teacher_of_course[c];
+        for (int k = model->courses_of_teacher_offsets[t];
+             k < model->courses_of_teacher_offsets[t + 1]; k++)
+            swap_sampler_update_course(sampler, sol, model->courses_of_teacher[k], p1, p2);
+
+        for (int k = model->curriculas_of_course_offsets[c];
+             k < model->curriculas_of_course_offsets[c + 1]; k++) {
+            const int q = model->curriculas_of_course[k];
+            for (int j = model->courses_of_curricula_offsets[q];
+                 j < model->courses_of_curricula_offsets[q + 1]; j++)
+                swap_sampler_update_course(sampler, sol, model->courses_of_curricula[j], p1, p2);
+        }
+    }
+}
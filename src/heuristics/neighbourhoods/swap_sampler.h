@@ -0,0 +1,55 @@
+#ifndef SWAP_SAMPLER_H
+#define SWAP_SAMPLER_H
+
+#include "swap.h"
+
+/*
+ * Sampler of random feasible and effective swap moves, with the same
+ * distribution of swap_move_generate_random_feasible_effective (uniform
+ * among the feasible, effective and non symmetric moves) but without
+ * drawing the moves that are certainly infeasible because of c1.
+ *
+ * The free and busy periods of each course (see swap_period_kind) are kept
+ * up to date with the solution (see swap_sampler_update); the moves drawn
+ * are, uniformly, the ones of a lecture to
+ * - any room of a free period of its course, or of its own period
+ * - the room of the (only) lecture that makes busy a busy period
+ * thus a course is drawn with a probability proportional to its number
+ * of such moves (kept in a Fenwick tree).
+ * Only the moves that are infeasible because of c2, or that are not
+ * effective or are symmetric, are still rejected.
+ */
+
+typedef struct swap_sampler {
+    const model *model;
+    int *first_lecture;     // [c]
+    char *kinds;            // [c,p] kind of p for c (SWAP_ITER_PERIOD_*, or -1)
+    int *periods[2];        // [kind][c,k] free/busy periods of c (the first n_periods[kind][c])
+    int *n_periods[2];      // [kind][c]
+    int *position;          // [c,p] position of p in periods[kinds[c,p]] of c
+    int64_t *tree;          // [c] Fenwick tree of the moves of c (up to ~L*R*P)
+    int tree_top;           // greatest power of 2 <= C
+    long n_draws;           // moves drawn...
+    long n_samples;         // ...for sampling n_samples feasible ones
+} swap_sampler;
+
+/* Build the periods of all the courses of sol. */
+void swap_sampler_init(swap_sampler *sampler, const solution *sol);
+void swap_sampler_destroy(swap_sampler *sampler);
+
+/*
+ * Sample a random feasible and effective move, and predict its cost
+ * (result is as swap_predict with NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS
+ * and NEIGHBOURHOOD_PREDICT_COST_IF_FEASIBLE).
+ */
+void swap_sampler_sample(swap_sampler *sampler, const solution *sol,
+                         swap_move *mv, swap_result *result);
+
+/*
+ * Update the periods after mv has been performed on sol
+ * (the helper of mv must be the one before the move).
+ * The solution must not be changed in other ways between the samples.
+ */
+void swap_sampler_update(swap_sampler *sampler, const solution *sol, const swap_move *mv);
+
+#endif // SWAP_SAMPLER_H
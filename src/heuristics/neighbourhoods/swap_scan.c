@@ -0,0 +1,187 @@
+#include "swap_scan.h"
+#include <unistd.h>
+#include "utils/mem_utils.h"
+
+static void swap_scan_work(swap_scan_worker *worker) {
+    swap_scan *scan = worker->scan;
+    worker->n_moves = worker->n_duplicates = 0;
+
+    int b;
+    while ((b = __atomic_fetch_add(&scan->next_block, 1, __ATOMIC_RELAXED)) < scan->n_run_blocks) {
+        if (b > __atomic_load_n(&scan->last_block, __ATOMIC_RELAXED))
+            break;
+
+        swap_iter iter;
+        swap_iter_init_pruned_range(&iter, scan->solution, scan->run_begin[b], scan->run_end[b]);
+        iter.courses = scan->courses;
+
+        int n;
+        while ((n = swap_iter_next_batch(&iter, &worker->moves)) > 0) {
+            swap_predict_batch(scan->solution, &worker->moves, n, &worker->results);
+            if (!scan->visit(worker->index, b, &worker->moves, n, &worker->results, scan->arg) ||
+                b > __atomic_load_n(&scan->last_block, __ATOMIC_RELAXED))
+                break;
+        }
+
+        worker->n_moves += iter.i;
+        worker->n_duplicates += iter.n_duplicates;
+        swap_iter_destroy(&iter);
+    }
+}
+
+static void *swap_scan_thread_run(void *arg) {
+    swap_scan_worker *worker = arg;
+    swap_scan *scan = worker->scan;
+    long generation = 0;
+
+    pthread_mutex_lock(&scan->mutex);
+    while (true) {
+        while (!scan->quit && scan->generation == generation)
+            pthread_cond_wait(&scan->start, &scan->mutex);
+        if (scan->quit)
+            break;
+        generation = scan->generation;
+        pthread_mutex_unlock(&scan->mutex);
+
+        swap_scan_work(worker);
+
+        pthread_mutex_lock(&scan->mutex);
+        if (--scan->n_busy == 0)
+            pthread_cond_signal(&scan->done);
+    }
+    pthread_mutex_unlock(&scan->mutex);
+
+    return NULL;
+}
+
+void swap_scan_init(swap_scan *scan, const model *m, int n_threads) {
+    MODEL(m);
+    scan->model = model;
+
+    if (n_threads <= 0)
+        n_threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    scan->n_threads = MAX(n_threads, 1);
+
+    // Split the lectures in blocks of whole courses (and about the same size)
+    int n_blocks = scan->n_threads == 1 ? 1 : MIN(C, scan->n_threads * SWAP_SCAN_BLOCKS_PER_THREAD);
+    scan->block_begin = mallocx(n_blocks + 1, sizeof(int));
+    int b = 0;
+    scan->block_begin[0] = 0;
+    for (int l = 1; l < L && b + 1 < n_blocks; l++) {
+        if (model->course_of_lecture[l] != model->course_of_lecture[l - 1] &&
+            (long) l * n_blocks >= (long) (b + 1) * L)
+            scan->block_begin[++b] = l;
+    }
+    scan->n_blocks = b + 1;
+    scan->block_begin[scan->n_blocks] = L;
+    scan->run_begin = mallocx(scan->n_blocks + 1, sizeof(int));
+    scan->run_end = mallocx(scan->n_blocks + 1, sizeof(int));
+
+    scan->workers = mallocx(scan->n_threads, sizeof(swap_scan_worker));
+    for (int t = 0; t < scan->n_threads; t++) {
+        swap_scan_worker *worker = &scan->workers[t];
+        worker->scan = scan;
+        worker->index = t;
+        swap_moves_init(&worker->moves, SWAP_MOVES_BATCH_SIZE);
+        swap_results_init(&worker->results, SWAP_MOVES_BATCH_SIZE);
+    }
+
+    pthread_mutex_init(&scan->mutex, NULL);
+    pthread_cond_init(&scan->start, NULL);
+    pthread_cond_init(&scan->done, NULL);
+    scan->generation = 0;
+    scan->n_busy = 0;
+    scan->quit = false;
+    scan->n_moves = scan->n_duplicates = 0;
+
+    scan->threads = mallocx(scan->n_threads, sizeof(pthread_t));
+    for (int t = 1; t < scan->n_threads; t++)
+        pthread_create(&scan->threads[t], NULL, swap_scan_thread_run, &scan->workers[t]);
+}
+
+void swap_scan_destroy(swap_scan *scan) {
+    pthread_mutex_lock(&scan->mutex);
+    scan->quit = true;
+    pthread_cond_broadcast(&scan->start);
+    pthread_mutex_unlock(&scan->mutex);
+    for (int t = 1; t < scan->n_threads; t++)
+        pthread_join(scan->threads[t], NULL);
+
+    pthread_mutex_destroy(&scan->mutex);
+    pthread_cond_destroy(&scan->start);
+    pthread_cond_destroy(&scan->done);
+
+    for (int t = 0; t < scan->n_threads; t++) {
+        swap_moves_destroy(&scan->workers[t].moves);
+        swap_results_destroy(&scan->workers[t].results);
+    }
+    free(scan->workers);
+    free(scan->threads);
+    free(scan->block_begin);
+    free(scan->run_begin);
+    free(scan->run_end);
+}
+
+void swap_scan_run(swap_scan *scan, const solution *sol,
+                   swap_scan_visit visit, void *arg) {
+    swap_scan_run_from(scan, sol, 0, NULL, visit, arg);
+}
+
+void swap_scan_run_from(swap_scan *scan, const solution *sol,
+                        int l_start, const bool *courses,
+                        swap_scan_visit visit, void *arg) {
+    // Blocks from the one of l_start, around (its head, if any, is the last)
+    int k = 0;
+    while (scan->block_begin[k + 1] <= l_start)
+        k++;
+    int n = 0;
+    for (int i = 0; i < scan->n_blocks; i++) {
+        const int b = (k + i) % scan->n_blocks;
+        scan->run_begin[n] = i ? scan->block_begin[b] : l_start;
+        scan->run_end[n++] = scan->block_begin[b + 1];
+    }
+    if (l_start > scan->block_begin[k]) {
+        scan->run_begin[n] = scan->block_begin[k];
+        scan->run_end[n++] = l_start;
+    }
+    scan->n_run_blocks = n;
+
+    scan->solution = sol;
+    scan->courses = courses;
+    scan->visit = visit;
+    scan->arg = arg;
+    scan->next_block = 0;
+    scan->last_block = scan->n_run_blocks - 1;
+
+    if (scan->n_threads > 1) {
+        pthread_mutex_lock(&scan->mutex);
+        scan->n_busy = scan->n_threads - 1;
+        scan->generation++;
+        pthread_cond_broadcast(&scan->start);
+        pthread_mutex_unlock(&scan->mutex);
+    }
+
+    // The caller's thread works too
+    swap_scan_work(&scan->workers[0]);
+
+    if (scan->n_threads > 1) {
+        pthread_mutex_lock(&scan->mutex);
+        while (scan->n_busy > 0)
+            pthread_cond_wait(&scan->done, &scan->mutex);
+        pthread_mutex_unlock(&scan->mutex);
+    }
+
+    scan->n_moves = scan->n_duplicates = 0;
+    for (int t = 0; t < scan->n_threads; t++) {
+        scan->n_moves += scan->workers[t].n_moves;
+        scan->n_duplicates += scan->workers[t].n_duplicates;
+    }
+}
+
+void swap_scan_stop_after(swap_scan *scan, int block) {
+    int last = __atomic_load_n(&scan->last_block, __ATOMIC_RELAXED);
+    while (block < last &&
+           !__atomic_compare_exchange_n(&scan->last_block, &last, block, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
@@ -0,0 +1,100 @@
+#ifndef SWAP_SCAN_H
+#define SWAP_SCAN_H
+
+#include <pthread.h>
+#include "swap.h"
+
+/*
+ * Scan of the whole swap neighbourhood, split among a pool of threads.
+ *
+ * The lectures are split in blocks (of whole courses), taken in order by
+ * the threads and enumerated with swap_iter_init_pruned_range; the moves
+ * of a block are predicted with swap_predict_batch and passed, one batch
+ * at a time, to a callback that accumulates its results per block.
+ * Since the blocks concatenated give the moves in the order of a
+ * sequential swap_iter, reducing the results in block order gives the
+ * outcome of a sequential scan, whatever the number of threads.
+ *
+ * The solution is only read by the threads, and must not change during
+ * the scan.
+ */
+
+/*
+ * Called with the batch of n predicted moves of the block `block` of the
+ * run (see run_begin), scanned by the thread `thread`; returns false for
+ * stop scanning the block.
+ * Calls for the same block are never concurrent.
+ */
+typedef bool (*swap_scan_visit)(int thread, int block,
+                                const swap_moves *moves, int n,
+                                const swap_results *results, void *arg);
+
+#define SWAP_SCAN_BLOCKS_PER_THREAD 8
+
+typedef struct swap_scan_worker {
+    struct swap_scan *scan;
+    int index;
+    swap_moves moves;
+    swap_results results;
+    int n_moves;        // moves enumerated during the last run
+    int n_duplicates;   // moves skipped during the last run
+} swap_scan_worker;
+
+typedef struct swap_scan {
+    const model *model;
+    int n_threads;
+    int n_blocks;
+    int *block_begin;           // [b] first lecture of block b ([n_blocks] = L)
+    swap_scan_worker *workers;  // [t] (0 is the caller's thread)
+    pthread_t *threads;         // [t] (only for t > 0)
+
+    pthread_mutex_t mutex;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    long generation;            // number of runs started
+    int n_busy;                 // threads still working on the current run
+    bool quit;
+
+    /* Current run */
+    const solution *solution;
+    const bool *courses;        // see swap_scan_run_from
+    swap_scan_visit visit;
+    void *arg;
+    int n_run_blocks;           // blocks of the run, in scan order:
+    int *run_begin;             // [b] first lecture of block b
+    int *run_end;               // [b] lecture after the last of block b
+    int next_block;
+    int last_block;             // blocks after it are not scanned
+
+    /* Totals of the last run (as swap_iter's) */
+    int n_moves;
+    int n_duplicates;
+} swap_scan;
+
+/* Start the pool of `n_threads` threads (0: as many as the cores). */
+void swap_scan_init(swap_scan *scan, const model *m, int n_threads);
+void swap_scan_destroy(swap_scan *scan);
+
+/* Scan the neighbourhood of sol, calling visit for each batch of moves. */
+void swap_scan_run(swap_scan *scan, const solution *sol,
+                   swap_scan_visit visit, void *arg);
+
+/*
+ * Like swap_scan_run, but in circular order, starting from l_start (the
+ * first lecture of a course), and only for the lectures of the courses c
+ * with courses[c] (all, if NULL).
+ * The block of l_start is split in two, scanned first and last; thus the
+ * blocks of the run (run_begin, run_end) are up to n_blocks + 1.
+ */
+void swap_scan_run_from(swap_scan *scan, const solution *sol,
+                        int l_start, const bool *courses,
+                        swap_scan_visit visit, void *arg);
+
+/*
+ * Don't scan the blocks after `block`, e.g. once the move searched for has
+ * been found in it (the blocks before it are scanned anyway).
+ * Can be called by the callback.
+ */
+void swap_scan_stop_after(swap_scan *scan, int block);
+
+#endif // SWAP_SCAN_H
@@ -81,6 +81,7 @@ RoomStability: All lectures of a course should be given in the same room. Each d
 #include "utils/time_utils.h"
 #include "args/args_parser.h"
 #include "model/model_parser.h"
+#include "model/model_cache.h"
 #include "solution/solution.h"
 #include "solution/solution_parser.h"
 #include "renderer/renderer.h"
@@ -144,10 +145,12 @@ static void handle_new_best_solution(const solution *sol,
     // <seed> <feasible> <cycles> <moves> <rc> <mwd> <cc> <rs> <cost>
     if (do_print_stats || do_write_stats) {
         char stats_output[128];
-        int rc = solution_room_capacity_cost(sol);
-        int mwd = solution_min_working_days_cost(sol);
-        int cc = solution_curriculum_compactness_cost(sol);
-        int rs = solution_room_stability_cost(sol);
+        solution_costs costs;
+        solution_cost_breakdown(sol, &costs);
+        int rc = costs.room_capacity;
+        int mwd = costs.min_working_days;
+        int cc = costs.curriculum_compactness;
+        int rs = costs.room_stability;
         int cost = rc + mwd + cc + rs;
         bool feasible = solution_satisfy_hard_constraints(sol);
         long ending_time = stats->ending_time != LONG_MAX ? stats->ending_time : ms();
@@ -241,7 +244,10 @@ int main (int argc, char **argv) {
     model model;
     model_init(&model);
 
-    if (!parse_model(&model, args.input_file))
+    bool model_parsed = args.model_cache ?
+            parse_model_cached(&model, args.input_file) :
+            parse_model(&model, args.input_file);
+    if (!model_parsed)
         exit(EXIT_FAILURE);
 
     solution sol;
@@ -263,6 +269,9 @@ int main (int argc, char **argv) {
     solver_conf.starting_solution = solution_loaded ? &sol : NULL;
     solver_conf.multistart = cfg.solver.multistart;
     solver_conf.restore_best_after_cycles = cfg.solver.restore_best_after_cycles;
+    solver_conf.best_snapshot = cfg.solver.best_snapshot;
+    solver_conf.decomposition = cfg.solver.decomposition;
+    solver_conf.threads = cfg.solver.threads;
     solver_conf.dont_solve = args.dont_solve;
     solver_conf.max_cycles = cfg.solver.max_cycles;
     solver_conf.max_time = cfg.solver.max_time;
@@ -2,6 +2,7 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <utils/str_utils.h>
 #include "utils/mem_utils.h"
 #include "utils/array_utils.h"
@@ -29,6 +30,17 @@ static void teacher_destroy(const teacher *t) {
     free(t->id);
 }
 
+static void model_destroy_lookup_tables(const model *model) {
+    if (model->course_by_id)
+        g_hash_table_destroy(model->course_by_id);
+    if (model->room_by_id)
+        g_hash_table_destroy(model->room_by_id);
+    if (model->curricula_by_id)
+        g_hash_table_destroy(model->curricula_by_id);
+    if (model->teacher_by_id)
+        g_hash_table_destroy(model->teacher_by_id);
+}
+
 void model_init(model *model) {
     static int model_id = 0;
     model->_id = model_id++;
@@ -55,19 +67,40 @@ void model_init(model *model) {
     model->room_by_id = NULL;
     model->curricula_by_id = NULL;
     model->teacher_by_id = NULL;
-    model->course_belongs_to_curricula = NULL;
+    model->course_of_lecture = NULL;
+    model->teacher_of_course = NULL;
+    model->students_of_course = NULL;
+    model->capacity_of_room = NULL;
+    model->room_capacity_penalty = NULL;
     model->curriculas_of_course = NULL;
+    model->curriculas_of_course_offsets = NULL;
     model->courses_of_curricula = NULL;
+    model->courses_of_curricula_offsets = NULL;
     model->courses_of_teacher = NULL;
-    model->course_taught_by_teacher = NULL;
+    model->courses_of_teacher_offsets = NULL;
+    model->curriculas_of_course_bitset = NULL;
+    model->curriculas_bitset_words = 0;
     model->course_availabilities = NULL;
-    model->courses_share_curricula = NULL;
-    model->courses_same_teacher = NULL;
+    model->n_room_classes = 0;
+    model->room_class = NULL;
+    model->room_class_prev = NULL;
+    model->n_course_classes = 0;
+    model->course_class = NULL;
+    model->_filename = NULL;
+    model->_mmap = NULL;
+    model->_mmap_size = 0;
 }
 
 void model_destroy(const model *model) {
     debug("Destroying model '%s'", model->name);
 
+    if (model->_mmap) {
+        // Loaded from the cache: everything but the lookup tables is within the mapping
+        model_destroy_lookup_tables(model);
+        munmap(model->_mmap, model->_mmap_size);
+        return;
+    }
+
     free(model->name);
 
     for (int i = 0; i < model->n_courses; i++)
@@ -92,38 +125,26 @@ void model_destroy(const model *model) {
         teacher_destroy(&model->teachers[i]);
     free(model->teachers);
 
-    if (model->curriculas_of_course) {
-        for (int c = 0; c < model->n_courses; c++)
-            g_array_free(model->curriculas_of_course[c], true);
-        free(model->curriculas_of_course);
-    }
-
-    if (model->courses_of_teacher) {
-        for (int t = 0; t < model->n_teachers; t++)
-            g_array_free(model->courses_of_teacher[t], true);
-        free(model->courses_of_teacher);
-    }
-
-    if (model->courses_of_curricula) {
-        for (int q = 0; q < model->n_curriculas; q++)
-            free(model->courses_of_curricula[q]);
-        free(model->courses_of_curricula);
-    }
-
-    free(model->course_belongs_to_curricula);
-    free(model->course_taught_by_teacher);
+    free(model->course_of_lecture);
+    free(model->teacher_of_course);
+    free(model->students_of_course);
+    free(model->capacity_of_room);
+    free(model->room_capacity_penalty);
+    free(model->curriculas_of_course);
+    free(model->curriculas_of_course_offsets);
+    free(model->courses_of_teacher);
+    free(model->courses_of_teacher_offsets);
+    free(model->courses_of_curricula);
+    free(model->courses_of_curricula_offsets);
+
+    free(model->curriculas_of_course_bitset);
     free(model->course_availabilities);
-    free(model->courses_share_curricula);
-    free(model->courses_same_teacher);
 
-    if (model->course_by_id)
-        g_hash_table_destroy(model->course_by_id);
-    if (model->room_by_id)
-        g_hash_table_destroy(model->room_by_id);
-    if (model->curricula_by_id)
-        g_hash_table_destroy(model->curricula_by_id);
-    if (model->teacher_by_id)
-        g_hash_table_destroy(model->teacher_by_id);
+    free(model->room_class);
+    free(model->room_class_prev);
+    free(model->course_class);
+
+    model_destroy_lookup_tables(model);
 }
 
 void model_finalize(model *model) {
@@ -163,59 +184,90 @@ void model_finalize(model *model) {
     g_hash_table_destroy(teachers_set);
 
     // model->course_by_id
-    model->course_by_id = g_hash_table_new(g_str_hash, g_str_equal);
-    for (int c = 0; c < C; c++)
-        g_hash_table_insert(model->course_by_id, model->courses[c].id, &model->courses[c]);
-
     // model->room_by_id
-    model->room_by_id = g_hash_table_new(g_str_hash, g_str_equal);
-    for (int r = 0; r < R; r++)
-        g_hash_table_insert(model->room_by_id, model->rooms[r].id, &model->rooms[r]);
-
     // model->curricula_by_id
-    model->curricula_by_id = g_hash_table_new(g_str_hash, g_str_equal);
-    for (int q = 0; q < Q; q++)
-        g_hash_table_insert(model->curricula_by_id, model->curriculas[q].id, &model->curriculas[q]);
-
     // model->teacher_by_id
-    model->teacher_by_id = g_hash_table_new(g_str_hash, g_str_equal);
-    for (int t = 0; t < T; t++)
-        g_hash_table_insert(model->teacher_by_id, model->teachers[t].id, &model->teachers[t]);
+    model_build_lookup_tables(model);
 
-    // model->curriculas_of_course
-    model->curriculas_of_course = mallocx(C, sizeof(GArray *));
+    // model->courses[c].teacher
+    // model->teacher_of_course
+    // model->students_of_course
+    model->teacher_of_course = mallocx(C, sizeof(int));
+    model->students_of_course = mallocx(C, sizeof(int));
     for (int c = 0; c < C; c++) {
-        model->curriculas_of_course[c] = g_array_new(false, false, sizeof(int));
+        model->courses[c].teacher =
+                model_teacher_by_id(model, model->courses[c].teacher_id);
+        model->teacher_of_course[c] = model->courses[c].teacher->index;
+        model->students_of_course[c] = model->courses[c].n_students;
     }
 
-    // model->course_belongs_to_curricula
-    model->course_belongs_to_curricula = mallocx(Q * C, sizeof(bool));
+    // model->capacity_of_room
+    model->capacity_of_room = mallocx(R, sizeof(int));
+    for (int r = 0; r < R; r++)
+        model->capacity_of_room[r] = model->rooms[r].capacity;
+
+    // model->room_capacity_penalty
+    model->room_capacity_penalty = mallocx(MAX(1, C * R), sizeof(int));
+    for (int c = 0; c < C; c++)
+        for (int r = 0; r < R; r++)
+            model->room_capacity_penalty[INDEX2(c, C, r, R)] =
+                    MAX(0, model->students_of_course[c] - model->capacity_of_room[r]);
+
+    // model->courses_of_curricula
+    model->courses_of_curricula_offsets = mallocx(Q + 1, sizeof(int));
+    int n_courses_of_curriculas = 0;
     for (int q = 0; q < Q; q++) {
-        const curricula *curricula = &model->curriculas[q];
+        model->courses_of_curricula_offsets[q] = n_courses_of_curriculas;
+        n_courses_of_curriculas += model->curriculas[q].n_courses;
+    }
+    model->courses_of_curricula_offsets[Q] = n_courses_of_curriculas;
 
-        for (int c = 0; c < C; c++) {
-            const course *course = &model->courses[c];
-            model->course_belongs_to_curricula[INDEX2(q, Q, c, C)] = 0;
+    model->courses_of_curricula = mallocx(n_courses_of_curriculas, sizeof(int));
+    i = 0;
+    for (int q = 0; q < Q; q++) {
+        const curricula *curricula = &model->curriculas[q];
+        for (int qc = 0; qc < curricula->n_courses; qc++) {
+            model->courses_of_curricula[i++] =
+                    model_course_by_id(model, curricula->courses_ids[qc])->index;
+        }
+    }
 
-            for (int qc = 0; qc < curricula->n_courses; qc++) {
-                if (streq(course->id, curricula->courses_ids[qc])) {
-                    model->course_belongs_to_curricula[INDEX2(q, Q, c, C)] = 1;
-                    g_array_append_val(model->curriculas_of_course[c], q);
-                    break;
-                }
+    // model->curriculas_of_course_bitset
+    // (from courses_of_curricula, a course listed twice counts once)
+    const int W = (Q + 63) / 64;
+    model->curriculas_bitset_words = W;
+    model->curriculas_of_course_bitset = callocx(MAX(1, C * W), sizeof(uint64_t));
+    model->curriculas_of_course_offsets = callocx(C + 1, sizeof(int));
+    for (int q = 0; q < Q; q++) {
+        for (int x = model->courses_of_curricula_offsets[q];
+             x < model->courses_of_curricula_offsets[q + 1]; x++) {
+            int c = model->courses_of_curricula[x];
+            if (!model_course_belongs_to_curricula(model, c, q)) {
+                model->curriculas_of_course_bitset[INDEX2(c, C, q / 64, W)] |=
+                        (uint64_t) 1 << (q % 64);
+                model->curriculas_of_course_offsets[c + 1]++;
             }
         }
     }
 
-    // model->course_taught_by_teacher
-    model->course_taught_by_teacher = mallocx(C * T, sizeof(bool));
-    for (int c = 0; c < C; c++) {
-        const char *course_teacher = model->courses[c].teacher_id;
-        for (int t = 0; t < T; t++) {
-            model->course_taught_by_teacher[INDEX2(c, C, t, T)] =
-                    streq(course_teacher, model->teachers[t].id);
+    // model->curriculas_of_course
+    // (counting sort by course: the curriculas of each course stay sorted)
+    for (int c = 0; c < C; c++)
+        model->curriculas_of_course_offsets[c + 1] += model->curriculas_of_course_offsets[c];
+
+    model->curriculas_of_course = mallocx(model->curriculas_of_course_offsets[C], sizeof(int));
+    int *course_cursor = mallocx(C, sizeof(int));
+    memcpy(course_cursor, model->curriculas_of_course_offsets, C * sizeof(int));
+    for (int q = 0; q < Q; q++) {
+        for (int x = model->courses_of_curricula_offsets[q];
+             x < model->courses_of_curricula_offsets[q + 1]; x++) {
+            int c = model->courses_of_curricula[x];
+            if (course_cursor[c] == model->curriculas_of_course_offsets[c] ||
+                model->curriculas_of_course[course_cursor[c] - 1] != q)
+                model->curriculas_of_course[course_cursor[c]++] = q;
         }
     }
+    free(course_cursor);
 
     // model->course_availabilities
     model->course_availabilities = mallocx(C * D * S, sizeof(bool));
@@ -228,85 +280,138 @@ void model_finalize(model *model) {
     }
 
     // model->courses_of_teacher
-    model->courses_of_teacher = mallocx(T, sizeof(GArray *));
-    for (int t = 0; t < T; t++) {
-        model->courses_of_teacher[t] = g_array_new(false, false, sizeof(int));
-    }
-
-    for (int t = 0; t < T; t++) {
-        const teacher *teacher = &model->teachers[t];
-        for (int c = 0; c < C; c++) {
-            const course *course = &model->courses[c];
-            if (streq(teacher->id, course->teacher_id)) {
-                g_array_append_val(model->courses_of_teacher[t], c);
-            }
-        }
-    }
-
-    // model->courses_of_curricula
-    model->courses_of_curricula = mallocx(Q, sizeof(int *));
-    for (int q = 0; q < Q; q++) {
-        const curricula *curricula = &model->curriculas[q];
-        model->courses_of_curricula[q] = mallocx(curricula->n_courses, sizeof(int));
-
-        for (int qc = 0; qc < curricula->n_courses; qc++) {
-            model->courses_of_curricula[q][qc] = model_course_by_id(model, curricula->courses_ids[qc])->index;
-        }
-    }
-
-    // model->courses_share_curricula
-    model->courses_share_curricula = mallocx(C * C * Q, sizeof(bool));
-    for (int c1 = 0; c1 < C; c1++) {
-        for (int c2 = 0; c2 < C; c2++) {
-            int c1_n_curriculas, c2_n_curriculas;
-            int *c1_curriculas = model_curriculas_of_course(model, c1, &c1_n_curriculas);
-            int *c2_curriculas = model_curriculas_of_course(model, c2, &c2_n_curriculas);
-            for (int q = 0; q < Q; q++) {
-                bool in_c1 = false;
-                bool in_c2 = false;
-
-                for (int c1_qi = 0; c1_qi < c1_n_curriculas && !in_c1; c1_qi++)
-                    in_c1 = q == c1_curriculas[c1_qi];
-
-                for (int c2_qi = 0; c2_qi < c2_n_curriculas && !in_c2; c2_qi++)
-                    in_c2 = q == c2_curriculas[c2_qi];
-
-                model->courses_share_curricula[INDEX3(c1, C, c2, C, q, Q)] = in_c1 && in_c2;
-            }
-        }
-    }
-
-    // model->courses_same_teacher
-    model->courses_same_teacher = mallocx(C * C, sizeof(bool));
-    for (int c1 = 0; c1 < C; c1++) {
-        for (int c2 = 0; c2 < C; c2++) {
-            model->courses_same_teacher[INDEX2(c1, C, c2, C)] =
-                    streq(model->courses[c1].teacher_id,
-                          model->courses[c2].teacher_id);
-        }
-    }
+    model->courses_of_teacher_offsets = callocx(T + 1, sizeof(int));
+    for (int c = 0; c < C; c++)
+        model->courses_of_teacher_offsets[model->teacher_of_course[c] + 1]++;
+    for (int t = 0; t < T; t++)
+        model->courses_of_teacher_offsets[t + 1] += model->courses_of_teacher_offsets[t];
 
-    // model->courses[c].teacher
-    for (int c = 0; c < C; c++) {
-        model->courses[c].teacher =
-                model_teacher_by_id(model, model->courses[c].teacher_id);
-    }
+    model->courses_of_teacher = mallocx(C, sizeof(int));
+    int *teacher_cursor = mallocx(T, sizeof(int));
+    memcpy(teacher_cursor, model->courses_of_teacher_offsets, T * sizeof(int));
+    for (int c = 0; c < C; c++)
+        model->courses_of_teacher[teacher_cursor[model->teacher_of_course[c]]++] = c;
+    free(teacher_cursor);
 
     // model->n_lectures
     // model->lectures
+    // model->course_of_lecture
     for (int c = 0; c < C; c++)
         model->n_lectures += model->courses[c].n_lectures;
 
     int l = 0;
     model->lectures = mallocx(model->n_lectures, sizeof(lecture));
+    model->course_of_lecture = mallocx(model->n_lectures, sizeof(int));
     for (int c = 0; c < C; c++) {
         const course *course = &model->courses[c];
         for (int n = 0; n < course->n_lectures; n++) {
             model->lectures[l].index = l;
             model->lectures[l].course = course;
+            model->course_of_lecture[l] = c;
             l++;
         }
     }
+
+    model_detect_symmetries(model);
+}
+
+typedef struct room_capacity {
+    int capacity;
+    int r;
+} room_capacity;
+
+static int room_capacity_compare(const void *a, const void *b) {
+    const room_capacity *rc1 = a, *rc2 = b;
+    if (rc1->capacity != rc2->capacity)
+        return rc1->capacity - rc2->capacity;
+    return rc1->r - rc2->r;
+}
+
+static bool courses_are_interchangeable(const model *model, int c1, int c2) {
+    const int P = model->n_days * model->n_slots;
+    const course *course1 = &model->courses[c1];
+    const course *course2 = &model->courses[c2];
+
+    if (course1->n_lectures != course2->n_lectures ||
+        course1->min_working_days != course2->min_working_days ||
+        course1->n_students != course2->n_students ||
+        model->teacher_of_course[c1] != model->teacher_of_course[c2])
+        return false;
+
+    int n1, n2;
+    const int *q1 = model_curriculas_of_course(model, c1, &n1);
+    const int *q2 = model_curriculas_of_course(model, c2, &n2);
+    if (n1 != n2 || memcmp(q1, q2, n1 * sizeof(int)) != 0)
+        return false;
+
+    return memcmp(&model->course_availabilities[c1 * P],
+                  &model->course_availabilities[c2 * P], P * sizeof(bool)) == 0;
+}
+
+void model_detect_symmetries(model *model) {
+    const int C = model->n_courses;
+    const int R = model->n_rooms;
+
+    // Rooms: sorted by capacity, the ones with the same capacity are a class
+    room_capacity *rooms = mallocx(R, sizeof(room_capacity));
+    for (int r = 0; r < R; r++) {
+        rooms[r].capacity = model->capacity_of_room[r];
+        rooms[r].r = r;
+    }
+    qsort(rooms, R, sizeof(room_capacity), room_capacity_compare);
+
+    model->room_class = mallocx(R, sizeof(int));
+    model->room_class_prev = mallocx(R, sizeof(int));
+    model->n_room_classes = 0;
+    for (int i = 0; i < R; i++) {
+        bool same_class = i > 0 && rooms[i].capacity == rooms[i - 1].capacity;
+        if (!same_class)
+            model->n_room_classes++;
+        model->room_class[rooms[i].r] = model->n_room_classes - 1;
+        model->room_class_prev[rooms[i].r] = same_class ? rooms[i - 1].r : -1;
+    }
+    free(rooms);
+
+    // Courses: interchangeable courses have the same teacher,
+    // thus only the courses of each teacher have to be compared
+    model->course_class = mallocx(C, sizeof(int));
+    for (int c = 0; c < C; c++)
+        model->course_class[c] = -1;
+    model->n_course_classes = 0;
+    for (int c = 0; c < C; c++) {
+        if (model->course_class[c] >= 0)
+            continue;
+        int k = model->n_course_classes++;
+        model->course_class[c] = k;
+
+        int n_courses;
+        const int *courses = model_courses_of_teacher(model, model->teacher_of_course[c], &n_courses);
+        for (int i = 0; i < n_courses; i++)
+            if (courses[i] > c && model->course_class[courses[i]] < 0 &&
+                courses_are_interchangeable(model, c, courses[i]))
+                model->course_class[courses[i]] = k;
+    }
+
+    debug("Model '%s' symmetries: %d room classes (of %d rooms), %d course classes (of %d courses)",
+          model->name, model->n_room_classes, R, model->n_course_classes, C);
+}
+
+void model_build_lookup_tables(model *model) {
+    model->course_by_id = g_hash_table_new(g_str_hash, g_str_equal);
+    for (int c = 0; c < model->n_courses; c++)
+        g_hash_table_insert(model->course_by_id, model->courses[c].id, &model->courses[c]);
+
+    model->room_by_id = g_hash_table_new(g_str_hash, g_str_equal);
+    for (int r = 0; r < model->n_rooms; r++)
+        g_hash_table_insert(model->room_by_id, model->rooms[r].id, &model->rooms[r]);
+
+    model->curricula_by_id = g_hash_table_new(g_str_hash, g_str_equal);
+    for (int q = 0; q < model->n_curriculas; q++)
+        g_hash_table_insert(model->curricula_by_id, model->curriculas[q].id, &model->curriculas[q]);
+
+    model->teacher_by_id = g_hash_table_new(g_str_hash, g_str_equal);
+    for (int t = 0; t < model->n_teachers; t++)
+        g_hash_table_insert(model->teacher_by_id, model->teachers[t].id, &model->teachers[t]);
 }
 
 course *model_course_by_id(const model *model, char *id) {
@@ -325,46 +430,7 @@ teacher *model_teacher_by_id(const model *model, char *id) {
     return g_hash_table_lookup(model->teacher_by_id, id);
 }
 
-bool model_course_belongs_to_curricula(const model *model, int c, int q) {
-    return model->course_belongs_to_curricula[
-            INDEX2(q, model->n_curriculas, c, model->n_courses)];
-}
-
-bool model_course_is_taught_by_teacher(const model *model, int c, int t) {
-    return model->course_taught_by_teacher[
-            INDEX2(c, model->n_courses, t, model->n_teachers)];
-}
-
 bool model_course_is_available_on_period(const model *model, int c, int d, int s) {
     return model->course_availabilities[
             INDEX3(c, model->n_courses, d, model->n_days, s, model->n_slots)];
 }
-
-int *model_curriculas_of_course(const model *model, int c, int *n_curriculas) {
-    if (n_curriculas)
-        *n_curriculas = model->curriculas_of_course[c]->len;
-    return (int *) model->curriculas_of_course[c]->data;
-}
-
-int *model_courses_of_curricula(const model *model, int q, int *n_courses) {
-    if (n_courses)
-        *n_courses = model->curriculas[q].n_courses;
-    return model->courses_of_curricula[q];
-}
-
-int *model_courses_of_teacher(const model *model, int t, int *n_courses) {
-    if (n_courses)
-        *n_courses = model->courses_of_teacher[t]->len;
-    return (int *) model->courses_of_teacher[t]->data;
-}
-
-bool model_share_curricula(const model *model, int c1, int c2, int q) {
-    return model->courses_share_curricula[INDEX3(c1, model->n_courses,
-                                                 c2, model->n_courses,
-                                                 q, model->n_curriculas)];
-}
-
-bool model_same_teacher(const model *model, int c1, int c2) {
-    return model->courses_same_teacher[INDEX2(c1, model->n_courses,
-                                              c2, model->n_courses)];
-}
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <glib.h>
 
 /*
@@ -18,6 +19,7 @@
     const int T = (m)->n_teachers; \
     const int Q = (m)->n_curriculas; \
     const int L = (m)->n_lectures; \
+    const int P = (m)->n_days * (m)->n_slots; \
     const model *model = (m)
 
 // Macros for iterate the model's structure easily
@@ -111,18 +113,57 @@ typedef struct model {
     GHashTable *curricula_by_id;
     GHashTable *teacher_by_id;
 
-    GArray **curriculas_of_course;      // [c]
-    GArray **courses_of_teacher;        // [t]
-    int **courses_of_curricula;         // [q]
+    /*
+     * Hot data, read by the neighbourhoods and the solution for each move:
+     * flat arrays, and CSR (compressed sparse row) for the relations,
+     * e.g. the curriculas of course c are
+     *      curriculas_of_course[curriculas_of_course_offsets[c]]
+     *      ...
+     *      curriculas_of_course[curriculas_of_course_offsets[c + 1] - 1]
+     */
+    int *course_of_lecture;             // [l]
+    int *teacher_of_course;             // [c]
+    int *students_of_course;            // [c]
+    int *capacity_of_room;              // [r]
+    int *room_capacity_penalty;         // [c,r] students of c exceeding the capacity of r
+
+    int *curriculas_of_course;          // CSR
+    int *curriculas_of_course_offsets;  // [c + 1]
+    int *courses_of_teacher;            // CSR
+    int *courses_of_teacher_offsets;    // [t + 1]
+    int *courses_of_curricula;          // CSR
+    int *courses_of_curricula_offsets;  // [q + 1]
+
+    /*
+     * Curriculas of each course as a bitset of Q bits, of
+     * curriculas_bitset_words 64 bits words per course.
+     */
+    uint64_t *curriculas_of_course_bitset;  // [c,w]
+    int curriculas_bitset_words;
 
-    bool *course_belongs_to_curricula;  // [q,c]
-    bool *course_taught_by_teacher;     // [c,t]
     bool *course_availabilities;        // [c,d,s]
-    bool *courses_share_curricula;      // [c,c,q]
-    bool *courses_same_teacher;         // [c,c]
+
+    /*
+     * Symmetries (see model_detect_symmetries).
+     * Rooms with the same capacity belong to the same class: they are
+     * interchangeable, but for the room stability;
+     * room_class_prev[r] is the previous room of the class of r (or -1).
+     * Courses with the same teacher, curriculas, unavailabilities, lectures,
+     * min working days and students belong to the same class: they are
+     * interchangeable.
+     */
+    int n_room_classes;
+    int *room_class;                    // [r]
+    int *room_class_prev;               // [r]
+    int n_course_classes;
+    int *course_class;                  // [c]
 
     const char *_filename;
     int _id;
+
+    // Mapping of the model cache, if the model has been loaded from it
+    void *_mmap;
+    size_t _mmap_size;
 } model;
 
 void model_init(model *model);
@@ -131,18 +172,59 @@ void model_destroy(const model *model);
 /* Compute the redundant data: must be called by the parser */
 void model_finalize(model *model);
 
+/* Compute the classes of interchangeable rooms and courses:
+ * called by model_finalize */
+void model_detect_symmetries(model *model);
+
+/* Build course_by_id, room_by_id, curricula_by_id and teacher_by_id */
+void model_build_lookup_tables(model *model);
+
 course *model_course_by_id(const model *model, char *id);
 room *model_room_by_id(const model *model, char *id);
 curricula *model_curricula_by_id(const model *model, char *id);
 teacher *model_teacher_by_id(const model *model, char *id);
 
-bool model_course_belongs_to_curricula(const model *model, int c, int q);
-bool model_course_is_taught_by_teacher(const model *model, int c, int t);
 bool model_course_is_available_on_period(const model *model, int c, int d, int s);
-int *model_curriculas_of_course(const model *model, int c, int *n_curriculas);
-int *model_courses_of_curricula(const model *model, int q, int *n_courses);
-int *model_courses_of_teacher(const model *model, int t, int *n_courses);
-bool model_share_curricula(const model *model, int c1, int c2, int q);
-bool model_same_teacher(const model *model, int c1, int c2);
+
+/* Relations between courses (inlined, since used in the hot path) */
+static inline bool model_course_belongs_to_curricula(const model *model, int c, int q) {
+    return (model->curriculas_of_course_bitset[
+            c * model->curriculas_bitset_words + q / 64] >> (q % 64)) & 1;
+}
+
+static inline bool model_course_is_taught_by_teacher(const model *model, int c, int t) {
+    return model->teacher_of_course[c] == t;
+}
+
+static inline bool model_share_curricula(const model *model, int c1, int c2, int q) {
+    return model_course_belongs_to_curricula(model, c1, q) &&
+           model_course_belongs_to_curricula(model, c2, q);
+}
+
+static inline bool model_same_teacher(const model *model, int c1, int c2) {
+    return model->teacher_of_course[c1] == model->teacher_of_course[c2];
+}
+
+/* Accessors of the CSR relations (inlined, since used in the hot path) */
+static inline int *model_curriculas_of_course(const model *model, int c, int *n_curriculas) {
+    const int *offsets = model->curriculas_of_course_offsets;
+    if (n_curriculas)
+        *n_curriculas = offsets[c + 1] - offsets[c];
+    return &model->curriculas_of_course[offsets[c]];
+}
+
+static inline int *model_courses_of_curricula(const model *model, int q, int *n_courses) {
+    const int *offsets = model->courses_of_curricula_offsets;
+    if (n_courses)
+        *n_courses = offsets[q + 1] - offsets[q];
+    return &model->courses_of_curricula[offsets[q]];
+}
+
+static inline int *model_courses_of_teacher(const model *model, int t, int *n_courses) {
+    const int *offsets = model->courses_of_teacher_offsets;
+    if (n_courses)
+        *n_courses = offsets[t + 1] - offsets[t];
+    return &model->courses_of_teacher[offsets[t]];
+}
 
 #endif // MODEL_H
\ No newline at end of file
@@ -0,0 +1,375 @@
+#include "model_cache.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "model_parser.h"
+#include "log/verbose.h"
+#include "utils/io_utils.h"
+#include "utils/str_utils.h"
+#include "utils/mem_utils.h"
+#include "utils/array_utils.h"
+
+/*
+ * Layout of a .cttb file:
+ *      header
+ *      model
+ *      entities (courses, rooms, curriculas, ...) and their strings
+ *      redundant arrays (course_of_lecture, CSR, bitset, ...)
+ * Each pointer within the file is stored as the offset of the pointed
+ * data from the beginning of the file (0 stands for NULL).
+ */
+
+#define MODEL_CACHE_MAGIC "ITCCTTB"
+#define MODEL_CACHE_VERSION 3
+#define MODEL_CACHE_ALIGNMENT 64 // arrays start at a cache line
+
+typedef struct model_cache_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t layout[10];    // sizes of the types the file is made of
+
+    // Instance the cache has been built from
+    uint64_t source_size;
+    int64_t source_mtime_sec;
+    int64_t source_mtime_nsec;
+
+    uint64_t size;          // size of the whole file
+    uint64_t model_offset;
+} model_cache_header;
+
+static void model_cache_layout(uint32_t *layout) {
+    layout[0] = sizeof(void *);
+    layout[1] = sizeof(int);
+    layout[2] = sizeof(bool);
+    layout[3] = sizeof(model);
+    layout[4] = sizeof(course);
+    layout[5] = sizeof(room);
+    layout[6] = sizeof(curricula);
+    layout[7] = sizeof(unavailability_constraint);
+    layout[8] = sizeof(lecture);
+    layout[9] = sizeof(teacher);
+}
+
+typedef struct model_cache_writer {
+    char *data;
+    size_t size;
+    size_t capacity;
+} model_cache_writer;
+
+/* Append `n` bytes of `src` (or zeros if `src` is NULL), returns their offset */
+static size_t model_cache_put(model_cache_writer *w, const void *src, size_t n, size_t alignment) {
+    size_t offset = (w->size + alignment - 1) / alignment * alignment;
+    if (offset + n > w->capacity) {
+        w->capacity = MAX(2 * w->capacity, offset + n);
+        w->data = reallocx(w->data, w->capacity, 1);
+    }
+    memset(w->data + w->size, 0, offset - w->size);
+    if (src)
+        memcpy(w->data + offset, src, n);
+    else
+        memset(w->data + offset, 0, n);
+    w->size = offset + n;
+    return offset;
+}
+
+static size_t model_cache_put_str(model_cache_writer *w, const char *str) {
+    return str ? model_cache_put(w, str, strlen(str) + 1, 1) : 0;
+}
+
+#define PUT_ARRAY(w, ptr, n) \
+    model_cache_put(w, ptr, (size_t) (n) * sizeof(*(ptr)), MODEL_CACHE_ALIGNMENT)
+#define AT(w, type, offset) ((type *) ((w)->data + (offset)))
+#define OFFSET(offset) ((void *) (uintptr_t) (offset))
+
+char *model_cache_filename(const char *filename) {
+    size_t len = strlen(filename);
+    if (len >= 4 && streq(filename + len - 4, ".ctt"))
+        return strmake("%sb", filename);
+    return strmake("%s.cttb", filename);
+}
+
+bool model_cache_write(const model *model, const char *filename, const char *cache_filename) {
+    const int C = model->n_courses;
+    const int R = model->n_rooms;
+    const int Q = model->n_curriculas;
+    const int U = model->n_unavailability_constraints;
+    const int D = model->n_days;
+    const int S = model->n_slots;
+    const int T = model->n_teachers;
+    const int L = model->n_lectures;
+
+    struct stat source_st;
+    if (stat(filename, &source_st) != 0)
+        return false;
+
+    model_cache_writer writer = {NULL, 0, 0};
+    model_cache_writer *w = &writer;
+
+    model_cache_put(w, NULL, sizeof(model_cache_header), MODEL_CACHE_ALIGNMENT);
+    size_t model_offset = model_cache_put(w, NULL, sizeof(struct model), MODEL_CACHE_ALIGNMENT);
+
+    // Entities: copied as they are, then their pointers are replaced by offsets
+    size_t courses = PUT_ARRAY(w, model->courses, C);
+    size_t rooms = PUT_ARRAY(w, model->rooms, R);
+    size_t curriculas = PUT_ARRAY(w, model->curriculas, Q);
+    size_t ucs = PUT_ARRAY(w, model->unavailability_constraints, U);
+    size_t lectures = PUT_ARRAY(w, model->lectures, L);
+    size_t teachers = PUT_ARRAY(w, model->teachers, T);
+
+    for (int c = 0; c < C; c++) {
+        const course *src = &model->courses[c];
+        size_t id = model_cache_put_str(w, src->id);
+        size_t teacher_id = model_cache_put_str(w, src->teacher_id);
+        course *dst = AT(w, course, courses) + c;
+        dst->id = OFFSET(id);
+        dst->teacher_id = OFFSET(teacher_id);
+        dst->teacher = OFFSET(teachers + src->teacher->index * sizeof(teacher));
+    }
+
+    for (int r = 0; r < R; r++) {
+        size_t id = model_cache_put_str(w, model->rooms[r].id);
+        AT(w, room, rooms)[r].id = OFFSET(id);
+    }
+
+    for (int q = 0; q < Q; q++) {
+        const curricula *src = &model->curriculas[q];
+        size_t id = model_cache_put_str(w, src->id);
+        size_t courses_ids = model_cache_put(w, NULL, src->n_courses * sizeof(char *), sizeof(char *));
+        for (int i = 0; i < src->n_courses; i++) {
+            size_t course_id = model_cache_put_str(w, src->courses_ids[i]);
+            AT(w, char *, courses_ids)[i] = OFFSET(course_id);
+        }
+        curricula *dst = AT(w, curricula, curriculas) + q;
+        dst->id = OFFSET(id);
+        dst->courses_ids = OFFSET(courses_ids);
+    }
+
+    for (int u = 0; u < U; u++) {
+        const unavailability_constraint *src = &model->unavailability_constraints[u];
+        size_t course_id = model_cache_put_str(w, src->course_id);
+        unavailability_constraint *dst = AT(w, unavailability_constraint, ucs) + u;
+        dst->course_id = OFFSET(course_id);
+        dst->course = OFFSET(courses + src->course->index * sizeof(course));
+    }
+
+    for (int l = 0; l < L; l++) {
+        AT(w, lecture, lectures)[l].course =
+                OFFSET(courses + model->lectures[l].course->index * sizeof(course));
+    }
+
+    for (int t = 0; t < T; t++) {
+        size_t id = model_cache_put_str(w, model->teachers[t].id);
+        AT(w, teacher, teachers)[t].id = OFFSET(id);
+    }
+
+    // Model (with the redundant arrays)
+    struct model m = *model;
+    m.name = OFFSET(model_cache_put_str(w, model->name));
+    m.courses = OFFSET(courses);
+    m.rooms = OFFSET(rooms);
+    m.curriculas = OFFSET(curriculas);
+    m.unavailability_constraints = OFFSET(ucs);
+    m.lectures = OFFSET(lectures);
+    m.teachers = OFFSET(teachers);
+    m.course_by_id = NULL;
+    m.room_by_id = NULL;
+    m.curricula_by_id = NULL;
+    m.teacher_by_id = NULL;
+    m.course_of_lecture = OFFSET(PUT_ARRAY(w, model->course_of_lecture, L));
+    m.teacher_of_course = OFFSET(PUT_ARRAY(w, model->teacher_of_course, C));
+    m.students_of_course = OFFSET(PUT_ARRAY(w, model->students_of_course, C));
+    m.capacity_of_room = OFFSET(PUT_ARRAY(w, model->capacity_of_room, R));
+    m.room_capacity_penalty = OFFSET(PUT_ARRAY(w, model->room_capacity_penalty, C * R));
+    m.curriculas_of_course = OFFSET(PUT_ARRAY(w, model->curriculas_of_course,
+                                              model->curriculas_of_course_offsets[C]));
+    m.curriculas_of_course_offsets = OFFSET(PUT_ARRAY(w, model->curriculas_of_course_offsets, C + 1));
+    m.courses_of_teacher = OFFSET(PUT_ARRAY(w, model->courses_of_teacher,
+                                            model->courses_of_teacher_offsets[T]));
+    m.courses_of_teacher_offsets = OFFSET(PUT_ARRAY(w, model->courses_of_teacher_offsets, T + 1));
+    m.courses_of_curricula = OFFSET(PUT_ARRAY(w, model->courses_of_curricula,
+                                              model->courses_of_curricula_offsets[Q]));
+    m.courses_of_curricula_offsets = OFFSET(PUT_ARRAY(w, model->courses_of_curricula_offsets, Q + 1));
+    m.curriculas_of_course_bitset = OFFSET(PUT_ARRAY(w, model->curriculas_of_course_bitset,
+                                                     MAX(1, C * model->curriculas_bitset_words)));
+    m.course_availabilities = OFFSET(PUT_ARRAY(w, model->course_availabilities, C * D * S));
+    m.room_class = OFFSET(PUT_ARRAY(w, model->room_class, R));
+    m.room_class_prev = OFFSET(PUT_ARRAY(w, model->room_class_prev, R));
+    m.course_class = OFFSET(PUT_ARRAY(w, model->course_class, C));
+    m._filename = NULL;
+    m._mmap = NULL;
+    m._mmap_size = 0;
+    memcpy(w->data + model_offset, &m, sizeof(m));
+
+    model_cache_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MODEL_CACHE_MAGIC, sizeof(header.magic));
+    header.version = MODEL_CACHE_VERSION;
+    model_cache_layout(header.layout);
+    header.source_size = source_st.st_size;
+    header.source_mtime_sec = source_st.st_mtim.tv_sec;
+    header.source_mtime_nsec = source_st.st_mtim.tv_nsec;
+    header.size = w->size;
+    header.model_offset = model_offset;
+    memcpy(w->data, &header, sizeof(header));
+
+    // Write to a temporary file and then rename it, so that
+    // concurrent runs never see a partially written cache
+    char *tmp_filename = strmake("%s.%d.tmp", cache_filename, getpid());
+    bool success = false;
+    FILE *f = fopen(tmp_filename, "wb");
+    if (f) {
+        success = fwrite(w->data, 1, w->size, f) == w->size;
+        success = (fclose(f) == 0) && success;
+        success = success && rename(tmp_filename, cache_filename) == 0;
+        if (!success)
+            remove(tmp_filename);
+    }
+
+    if (success)
+        verbose("Model cache written to '%s' (%zu bytes)", cache_filename, w->size);
+    else
+        verbose("WARN: failed to write model cache '%s' (%s)", cache_filename, strerror(errno));
+
+    free(tmp_filename);
+    free(w->data);
+
+    return success;
+}
+
+static bool model_cache_header_check(const model_cache_header *header, size_t size,
+                                     const struct stat *source_st) {
+    uint32_t layout[LENGTH(header->layout)];
+    model_cache_layout(layout);
+
+    return memcmp(header->magic, MODEL_CACHE_MAGIC, sizeof(header->magic)) == 0 &&
+           header->version == MODEL_CACHE_VERSION &&
+           memcmp(header->layout, layout, sizeof(layout)) == 0 &&
+           header->size == size &&
+           header->model_offset + sizeof(model) <= size &&
+           header->source_size == (uint64_t) source_st->st_size &&
+           header->source_mtime_sec == (int64_t) source_st->st_mtim.tv_sec &&
+           header->source_mtime_nsec == (int64_t) source_st->st_mtim.tv_nsec;
+}
+
+bool model_cache_load(model *model, const char *filename, const char *cache_filename) {
+    struct stat source_st, st;
+    if (stat(filename, &source_st) != 0)
+        return false;
+
+    int fd = open(cache_filename, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(model_cache_header)) {
+        close(fd);
+        return false;
+    }
+
+    const size_t size = st.st_size;
+    char *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return false;
+
+    const model_cache_header *header = (const model_cache_header *) base;
+    if (!model_cache_header_check(header, size, &source_st)) {
+        verbose("Model cache '%s' is stale or invalid", cache_filename);
+        munmap(base, size);
+        return false;
+    }
+
+#define RELOCATE(ptr) do { \
+    uintptr_t offset = (uintptr_t) (ptr); \
+    if (offset > size) \
+        goto FAIL; \
+    (ptr) = offset ? (void *) (base + offset) : NULL; \
+} while (0)
+
+    struct model m = *(struct model *) (base + header->model_offset);
+    RELOCATE(m.name);
+    RELOCATE(m.courses);
+    RELOCATE(m.rooms);
+    RELOCATE(m.curriculas);
+    RELOCATE(m.unavailability_constraints);
+    RELOCATE(m.lectures);
+    RELOCATE(m.teachers);
+    RELOCATE(m.course_of_lecture);
+    RELOCATE(m.teacher_of_course);
+    RELOCATE(m.students_of_course);
+    RELOCATE(m.capacity_of_room);
+    RELOCATE(m.room_capacity_penalty);
+    RELOCATE(m.curriculas_of_course);
+    RELOCATE(m.curriculas_of_course_offsets);
+    RELOCATE(m.courses_of_teacher);
+    RELOCATE(m.courses_of_teacher_offsets);
+    RELOCATE(m.courses_of_curricula);
+    RELOCATE(m.courses_of_curricula_offsets);
+    RELOCATE(m.curriculas_of_course_bitset);
+    RELOCATE(m.course_availabilities);
+    RELOCATE(m.room_class);
+    RELOCATE(m.room_class_prev);
+    RELOCATE(m.course_class);
+
+    for (int c = 0; c < m.n_courses; c++) {
+        RELOCATE(m.courses[c].id);
+        RELOCATE(m.courses[c].teacher_id);
+        RELOCATE(m.courses[c].teacher);
+    }
+    for (int r = 0; r < m.n_rooms; r++)
+        RELOCATE(m.rooms[r].id);
+    for (int q = 0; q < m.n_curriculas; q++) {
+        RELOCATE(m.curriculas[q].id);
+        RELOCATE(m.curriculas[q].courses_ids);
+        for (int i = 0; i < m.curriculas[q].n_courses; i++)
+            RELOCATE(m.curriculas[q].courses_ids[i]);
+    }
+    for (int u = 0; u < m.n_unavailability_constraints; u++) {
+        RELOCATE(m.unavailability_constraints[u].course_id);
+        RELOCATE(m.unavailability_constraints[u].course);
+    }
+    for (int l = 0; l < m.n_lectures; l++)
+        RELOCATE(m.lectures[l].course);
+    for (int t = 0; t < m.n_teachers; t++)
+        RELOCATE(m.teachers[t].id);
+
+#undef RELOCATE
+
+    // From now on the model is never written
+    mprotect(base, size, PROT_READ);
+
+    m._id = model->_id;
+    m._filename = filename;
+    m._mmap = base;
+    m._mmap_size = size;
+    *model = m;
+
+    model_build_lookup_tables(model);
+
+    return true;
+
+FAIL:
+    verbose("Model cache '%s' is corrupted", cache_filename);
+    munmap(base, size);
+    return false;
+}
+
+bool parse_model_cached(model *model, const char *filename) {
+    char *cache_filename = model_cache_filename(filename);
+
+    bool success = model_cache_load(model, filename, cache_filename);
+    if (success) {
+        verbose("Model '%s' loaded from cache '%s'", filename, cache_filename);
+    } else {
+        success = parse_model(model, filename);
+        if (success && !model_cache_write(model, filename, cache_filename))
+            eprint("WARN: failed to write model cache '%s'", cache_filename);
+    }
+
+    free(cache_filename);
+
+    return success;
+}
@@ -0,0 +1,39 @@
+#ifndef MODEL_CACHE_H
+#define MODEL_CACHE_H
+
+#include "model.h"
+#include <stdbool.h>
+
+/*
+ * Binary cache of a finalized model (.cttb).
+ *
+ * The model, its entities and all the redundant arrays are laid out in
+ * a single file, which is mmap-ed read-only and used in place: at load
+ * only the pointers of the entities are relocated and the lookup
+ * tables (course_by_id, ...) are rebuilt, nothing is parsed or finalized.
+ *
+ * The cache records size and modification time of the .ctt it has been
+ * built from: if they don't match anymore, the cache is stale and
+ * it is not loaded.
+ * The layout depends on the build (e.g. sizeof(int), pointers width),
+ * thus a cache is valid only for the build that has written it.
+ */
+
+/* Returns the (malloc-ed) name of the cache of the instance `filename`
+ * (e.g. comp01.ctt -> comp01.cttb). */
+char *model_cache_filename(const char *filename);
+
+/* Write the cache `cache_filename` of a finalized model parsed from `filename`. */
+bool model_cache_write(const model *model, const char *filename, const char *cache_filename);
+
+/* Load the model from `cache_filename`, only if it is the up to date cache
+ * of the instance `filename`. */
+bool model_cache_load(model *model, const char *filename, const char *cache_filename);
+
+/*
+ * As parse_model, but load the model from its cache if it is up to date;
+ * otherwise parse the instance and (re)build the cache.
+ */
+bool parse_model_cached(model *model, const char *filename);
+
+#endif // MODEL_CACHE_H
@@ -61,15 +61,32 @@ typedef enum model_parser_section {
 typedef struct model_parser_state {
     model_parser_section section;
     int section_cursor;
+
+    // Fields of the current line (reused among lines)
+    char **fields;
+    int fields_capacity;
 } model_parser_state;
 
 
 static void solution_parser_state_init(model_parser_state *state) {
     state->section = MODEL_PARSER_SECTION_NONE;
     state->section_cursor = 0;
+    state->fields = NULL;
+    state->fields_capacity = 0;
 }
 
-static void solution_parser_state_destroy(model_parser_state *state) {}
+static void solution_parser_state_destroy(model_parser_state *state) {
+    free(state->fields);
+}
+
+/* Returns an array able to hold at least n fields */
+static char **model_parser_state_fields(model_parser_state *state, int n) {
+    if (n > state->fields_capacity) {
+        state->fields_capacity = MAX(n, 2 * state->fields_capacity);
+        state->fields = reallocx(state->fields, state->fields_capacity, sizeof(char *));
+    }
+    return state->fields;
+}
 
 bool parse_model(model *model, const char *filename) {
     model_parser parser;
@@ -99,10 +116,28 @@ typedef struct model_parser_line_handler_arg {
     model *model;
 } model_parser_line_handler_arg;
 
+/*
+ * Whether `line` is "<key>: <value>"; if so, `value` points to the value
+ * (already trimmed, since the line is).
+ */
+static bool model_parser_key(char *line, const char *key, char **value) {
+    size_t key_len = strlen(key);
+    if (strncmp(line, key, key_len) != 0)
+        return false;
+
+    char *sep = strltrim(&line[key_len]);
+    if (*sep != ':')
+        return false;
+
+    *value = strltrim(sep + 1);
+    return true;
+}
+
 /*
  * `fileparse` callback: real parsing logic.
+ * The line is tokenized in place.
  */
-static char * model_parser_line_handler(const char *line, void *arg) {
+static char * model_parser_line_handler(char *line, void *arg) {
 
 #define ABORT_PARSE(str, ...) do { \
     error = strmake(str, ##__VA_ARGS__); \
@@ -121,73 +156,63 @@ static char * model_parser_line_handler(const char *line, void *arg) {
     model_parser_state *state = (model_parser_state *) parser->_state;
     model *model = m_arg->model;
 
-    char **fields = NULL;
+    char **fields;
     char *error = NULL;
-    char *line_copy1 = strdup(line);
-    char *line_copy2 = strdup(line);
-
-    // Outside section?
-    fields = mallocx(2, sizeof(char *));
-    int n_fields = strsplit(line_copy1, ":", fields, 2);
-    if (n_fields > 2)
-        ABORT_PARSE("unexpected line syntax '%s'", line);
-
-    const char *key = n_fields >= 1 ? strtrim(fields[0]) : "";
-    const char *value = n_fields == 2 ? strtrim(fields[1]) : "";
+    char *value;
 
     // Header?
-    if (streq("END.", key)) {
+    if (streq("END.", line)) {
         goto QUIT;
     }
-    if (streq("Name", key)) {
+    if (model_parser_key(line, "Name", &value)) {
         PARSE_STR(value, &model->name);
         goto QUIT;
     }
-    if (streq("Courses", key)) {
+    if (model_parser_key(line, "Courses", &value)) {
         PARSE_INT(value, &model->n_courses);
         goto QUIT;
     }
-    if (streq("Rooms", key)) {
+    if (model_parser_key(line, "Rooms", &value)) {
         PARSE_INT(value, &model->n_rooms);
         goto QUIT;
     }
-    if (streq("Days", key)) {
+    if (model_parser_key(line, "Days", &value)) {
         PARSE_INT(value, &model->n_days);
         goto QUIT;
     }
-    if (streq("Periods_per_day", key)) {
+    if (model_parser_key(line, "Periods_per_day", &value)) {
         PARSE_INT(value, &model->n_slots);
         goto QUIT;
     }
-    if (streq("Curricula", key)) {
+    if (model_parser_key(line, "Curricula", &value)) {
         PARSE_INT(value, &model->n_curriculas);
         goto QUIT;
     }
-    if (streq("Constraints", key)) {
+    if (model_parser_key(line, "Constraints", &value)) {
         PARSE_INT(value, &model->n_unavailability_constraints);
         goto QUIT;
     }
 
     // Sections begin?
-    if (streq("COURSES", key) && strempty(value)) {
+    if (model_parser_key(line, "COURSES", &value) && strempty(value)) {
         state->section = MODEL_PARSER_SECTION_COURSES;
         state->section_cursor = 0;
         model->courses = mallocx(model->n_courses, sizeof(course));
         goto QUIT;
     }
-    if (streq("ROOMS", key) && strempty(value)) {
+    if (model_parser_key(line, "ROOMS", &value) && strempty(value)) {
         state->section = MODEL_PARSER_SECTION_ROOMS;
         state->section_cursor = 0;
         model->rooms = mallocx(model->n_rooms, sizeof(course));
         goto QUIT;
     }
-    if (streq("CURRICULA", key) && strempty(value)) {
+    if (model_parser_key(line, "CURRICULA", &value) && strempty(value)) {
         state->section = MODEL_PARSER_SECTION_CURRICULAS;
         state->section_cursor = 0;
         model->curriculas = mallocx(model->n_curriculas, sizeof(course));
         goto QUIT;
     }
-    if (streq("UNAVAILABILITY_CONSTRAINTS", key) && strempty(value)) {
+    if (model_parser_key(line, "UNAVAILABILITY_CONSTRAINTS", &value) && strempty(value)) {
         state->section = MODEL_PARSER_SECTION_CONSTRAINTS;
         state->section_cursor = 0;
         model->unavailability_constraints =
@@ -195,17 +220,14 @@ static char * model_parser_line_handler(const char *line, void *arg) {
         goto QUIT;
     }
 
-    free(fields);
-    fields = NULL;
-
     // Inside section?
     if (state->section == MODEL_PARSER_SECTION_COURSES) {
         if (state->section_cursor >= model->n_courses)
             ABORT_PARSE("unexpected courses count");
 
-        fields = mallocx(COURSE_FIELDS, sizeof(char *));
-        if (strsplit(line_copy2, FIELDS_SEPARATORS, fields, COURSE_FIELDS) != COURSE_FIELDS)
-            ABORT_PARSE("unexpected course entry syntax ('%s')", line);
+        fields = model_parser_state_fields(state, COURSE_FIELDS);
+        if (strsplit(line, FIELDS_SEPARATORS, fields, COURSE_FIELDS) != COURSE_FIELDS)
+            ABORT_PARSE("unexpected course entry syntax");
 
         int f = 0;
 
@@ -224,9 +246,9 @@ static char * model_parser_line_handler(const char *line, void *arg) {
         if (state->section_cursor >= model->n_rooms)
             ABORT_PARSE("unexpected rooms count");
 
-        fields = mallocx(ROOM_FIELDS, sizeof(char *));
-        if (strsplit(line_copy2, FIELDS_SEPARATORS, fields, ROOM_FIELDS) != ROOM_FIELDS)
-            ABORT_PARSE("unexpected room entry syntax ('%s')", line);
+        fields = model_parser_state_fields(state, ROOM_FIELDS);
+        if (strsplit(line, FIELDS_SEPARATORS, fields, ROOM_FIELDS) != ROOM_FIELDS)
+            ABORT_PARSE("unexpected room entry syntax");
 
         int f = 0;
 
@@ -242,14 +264,14 @@ static char * model_parser_line_handler(const char *line, void *arg) {
         if (state->section_cursor >= model->n_curriculas)
             ABORT_PARSE("unexpected curriculas count");
 
-        // Don't know in advance how many fields we will have
-        // Therefore alloc at least 2 + n_courses
-        fields = mallocx(CURRICULA_FIXED_FIELDS + model->n_courses, sizeof(char *));
-        n_fields = strsplit(line_copy2, FIELDS_SEPARATORS, fields,
-                                CURRICULA_FIXED_FIELDS + model->n_courses);
+        // Don't know in advance how many fields we will have, but
+        // each one takes at least two chars (separator included)
+        const int max_fields = (int) strlen(line) / 2 + 1;
+        fields = model_parser_state_fields(state, max_fields);
+        int n_fields = strsplit(line, FIELDS_SEPARATORS, fields, max_fields);
 
         if (n_fields < CURRICULA_FIXED_FIELDS) 
-            ABORT_PARSE("unexpected course entry syntax ('%s')", line);
+            ABORT_PARSE("unexpected curricula entry syntax");
         
         int f = 0;
         
@@ -272,10 +294,10 @@ static char * model_parser_line_handler(const char *line, void *arg) {
         if (state->section_cursor >= model->n_unavailability_constraints)
             ABORT_PARSE("unexpected constraints count");
 
-        fields = mallocx(UNAVAILABILITY_CONSTRAINTS_FIELDS, sizeof(char *));
-        if (strsplit(line_copy2, FIELDS_SEPARATORS, fields, UNAVAILABILITY_CONSTRAINTS_FIELDS)
+        fields = model_parser_state_fields(state, UNAVAILABILITY_CONSTRAINTS_FIELDS);
+        if (strsplit(line, FIELDS_SEPARATORS, fields, UNAVAILABILITY_CONSTRAINTS_FIELDS)
                 != UNAVAILABILITY_CONSTRAINTS_FIELDS)
-            ABORT_PARSE("unexpected constraint entry syntax ('%s')", line);
+            ABORT_PARSE("unexpected constraint entry syntax");
 
 
         int f = 0;
@@ -293,9 +315,6 @@ static char * model_parser_line_handler(const char *line, void *arg) {
     eprint("WARN: unexpected line '%s'", line);
 
 QUIT:
-    free(line_copy1);
-    free(line_copy2);
-    free(fields);
 
 #undef ABORT_PARSE
 #undef PARSE_STR
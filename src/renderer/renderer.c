@@ -1,6 +1,7 @@
 #include "renderer.h"
 #include <cairo.h>
 #include <errno.h>
+#include <string.h>
 #include "log/debug.h"
 #include "log/verbose.h"
 #include "utils/rand_utils.h"
@@ -366,65 +367,51 @@ bool renderer_render_curriculum_timetable(renderer *renderer, const renderer_con
                   model->n_courses, &red, &green, &blue))
         return false;
 
+    int *slot_assignments = callocx(D * S, sizeof(int));
     int max_slot_assignments = 0;
 
-    FOR_D {
-        FOR_S {
-            int slot_assignments = 0;
-            FOR_C {
-                if (!model_course_belongs_to_curricula(model, c, q->index))
-                    continue;
-
-                FOR_R {
-                    slot_assignments += solution->timetable_crds[
-                            INDEX4(c, model->n_courses,
-                                   r, model->n_rooms,
-                                   d, model->n_days,
-                                   s, model->n_slots)];
-                }
-            }
-            max_slot_assignments = MAX(max_slot_assignments, slot_assignments);
-        }
+    FOR_L {
+        const assignment *a = &solution->assignments[l];
+        const int c = model->lectures[l].course->index;
+        if (a->r < 0 || !(model_course_belongs_to_curricula(model, c, q->index)))
+            continue;
+
+        int *n = &slot_assignments[INDEX2(a->d, D, a->s, S)];
+        (*n)++;
+        max_slot_assignments = MAX(max_slot_assignments, *n);
     }
 
     double H = ((double) row_height / max_slot_assignments);
 
-    FOR_D {
-        FOR_S {
-            int slot_index = 0;
-            FOR_C {
-                if (!model_course_belongs_to_curricula(model, c, q->index))
-                    continue;
-
-                FOR_R {
-                    if(solution->timetable_crds[
-                            INDEX4(c, model->n_courses,
-                                   r, model->n_rooms,
-                                   d, model->n_days,
-                                   s, model->n_slots)]) {
-                        double text_r, text_g, text_b;
-                        if (slot_index == 0) {
-                            text_r = text_g = text_b = 0;
-                        } else {
-                            text_r = 1;  text_g = 0; text_b = 0;
-                        }
-                        draw_box_text(
-                                renderer, cr,
-                                (d + 1) * col_width,
-                                (s + 1) * row_height + H * slot_index,
-                                col_width,
-                                H,
-                                red[c], green[c], blue[c],
-                                config->font_size_small, false, false,
-                                text_r, text_g, text_b,
-                                "%s (%s)", model->courses[c].id, model->rooms[r].id);
-                        slot_index++;
-                    }
-                }
-            }
+    memset(slot_assignments, 0, D * S * sizeof(int));
+
+    FOR_L {
+        const assignment *a = &solution->assignments[l];
+        const int c = model->lectures[l].course->index;
+        if (a->r < 0 || !(model_course_belongs_to_curricula(model, c, q->index)))
+            continue;
+
+        int slot_index = slot_assignments[INDEX2(a->d, D, a->s, S)]++;
+        double text_r, text_g, text_b;
+        if (slot_index == 0) {
+            text_r = text_g = text_b = 0;
+        } else {
+            text_r = 1;  text_g = 0; text_b = 0;
         }
+        draw_box_text(
+                renderer, cr,
+                (a->d + 1) * col_width,
+                (a->s + 1) * row_height + H * slot_index,
+                col_width,
+                H,
+                red[c], green[c], blue[c],
+                config->font_size_small, false, false,
+                text_r, text_g, text_b,
+                "%s (%s)", model->courses[c].id, model->rooms[a->r].id);
     }
 
+    free(slot_assignments);
+
     return epilogue(renderer, config, solution,
                     cr, surface,
                     path,
@@ -450,57 +437,51 @@ bool renderer_render_course_timetable(renderer *renderer, const renderer_config
                   model->n_rooms, &red, &green, &blue))
         return false;
 
+    int *slot_assignments = callocx(D * S, sizeof(int));
     int max_slot_assignments = 0;
 
-    FOR_D {
-        FOR_S {
-            int slot_assignments = 0;
+    FOR_L {
+        const assignment *a = &solution->assignments[l];
+        const int c = model->lectures[l].course->index;
+        if (a->r < 0 || !(c == course->index))
+            continue;
 
-            FOR_R {
-                slot_assignments += solution->timetable_crds[
-                        INDEX4(course->index, model->n_courses,
-                               r, model->n_rooms,
-                               d, model->n_days,
-                               s, model->n_slots)];
-            }
-            max_slot_assignments = MAX(max_slot_assignments, slot_assignments);
-        }
+        int *n = &slot_assignments[INDEX2(a->d, D, a->s, S)];
+        (*n)++;
+        max_slot_assignments = MAX(max_slot_assignments, *n);
     }
 
     double H = ((double) row_height / max_slot_assignments);
 
-    FOR_D {
-        FOR_S {
-            int slot_index = 0;
-
-            FOR_R {
-                if(solution->timetable_crds[
-                        INDEX4(course->index, model->n_courses,
-                               r, model->n_rooms,
-                               d, model->n_days,
-                               s, model->n_slots)]) {
-                    double text_r, text_g, text_b;
-                    if (slot_index == 0) {
-                        text_r = text_g = text_b = 0;
-                    } else {
-                        text_r = 1;  text_g = 0; text_b = 0;
-                    }
-                    draw_box_text(
-                            renderer, cr,
-                            (d + 1) * col_width,
-                            (s + 1) * row_height + H * slot_index,
-                            col_width,
-                            H,
-                            red[r], green[r], blue[r],
-                            config->font_size_small, false, false,
-                            text_r, text_g, text_b,
-                            "%s", model->rooms[r].id);
-                    slot_index++;
-                }
-            }
+    memset(slot_assignments, 0, D * S * sizeof(int));
+
+    FOR_L {
+        const assignment *a = &solution->assignments[l];
+        const int c = model->lectures[l].course->index;
+        if (a->r < 0 || !(c == course->index))
+            continue;
+
+        int slot_index = slot_assignments[INDEX2(a->d, D, a->s, S)]++;
+        double text_r, text_g, text_b;
+        if (slot_index == 0) {
+            text_r = text_g = text_b = 0;
+        } else {
+            text_r = 1;  text_g = 0; text_b = 0;
         }
+        draw_box_text(
+                renderer, cr,
+                (a->d + 1) * col_width,
+                (a->s + 1) * row_height + H * slot_index,
+                col_width,
+                H,
+                red[a->r], green[a->r], blue[a->r],
+                config->font_size_small, false, false,
+                text_r, text_g, text_b,
+                "%s", model->rooms[a->r].id);
     }
 
+    free(slot_assignments);
+
     return epilogue(renderer, config, solution,
                     cr, surface,
                     path,
@@ -525,57 +506,50 @@ bool renderer_render_room_timetable(renderer *renderer, const renderer_config *c
                   model->n_courses, &red, &green, &blue))
         return false;
 
+    int *slot_assignments = callocx(D * S, sizeof(int));
     int max_slot_assignments = 0;
 
-    FOR_D {
-        FOR_S {
-            int slot_assignments = 0;
-            FOR_C {
+    FOR_L {
+        const assignment *a = &solution->assignments[l];
+        if (a->r < 0 || a->r != room->index)
+            continue;
 
-                slot_assignments += solution->timetable_crds[
-                        INDEX4(c, model->n_courses,
-                               room->index, model->n_rooms,
-                               d, model->n_days,
-                               s, model->n_slots)];
-            }
-            max_slot_assignments = MAX(max_slot_assignments, slot_assignments);
-        }
+        int *n = &slot_assignments[INDEX2(a->d, D, a->s, S)];
+        (*n)++;
+        max_slot_assignments = MAX(max_slot_assignments, *n);
     }
 
     double H = ((double) row_height / max_slot_assignments);
 
-    FOR_D {
-        FOR_S {
-            int slot_index = 0;
-            FOR_C {
-
-                if(solution->timetable_crds[
-                        INDEX4(c, model->n_courses,
-                               room->index, model->n_rooms,
-                               d, model->n_days,
-                               s, model->n_slots)]) {
-                    double text_r, text_g, text_b;
-                    if (slot_index == 0) {
-                        text_r = text_g = text_b = 0;
-                    } else {
-                        text_r = 1;  text_g = 0; text_b = 0;
-                    }
-                    draw_box_text(
-                            renderer, cr,
-                            (d + 1) * col_width,
-                            (s + 1) * row_height + H * slot_index,
-                            col_width,
-                            H,
-                            red[c], green[c], blue[c],
-                            config->font_size_small, false, false,
-                            text_r, text_g, text_b,
-                            "%s", model->courses[c].id);
-                    slot_index++;
-                }
-            }
+    memset(slot_assignments, 0, D * S * sizeof(int));
+
+    FOR_L {
+        const assignment *a = &solution->assignments[l];
+        const int c = model->lectures[l].course->index;
+        if (a->r < 0 || !(a->r == room->index))
+            continue;
+
+        int slot_index = slot_assignments[INDEX2(a->d, D, a->s, S)]++;
+        double text_r, text_g, text_b;
+        if (slot_index == 0) {
+            text_r = text_g = text_b = 0;
+        } else {
+            text_r = 1;  text_g = 0; text_b = 0;
         }
+        draw_box_text(
+                renderer, cr,
+                (a->d + 1) * col_width,
+                (a->s + 1) * row_height + H * slot_index,
+                col_width,
+                H,
+                red[c], green[c], blue[c],
+                config->font_size_small, false, false,
+                text_r, text_g, text_b,
+                "%s", model->courses[c].id);
     }
 
+    free(slot_assignments);
+
     return epilogue(renderer, config, solution,
                     cr, surface,
                     path,
@@ -600,65 +574,51 @@ bool renderer_render_teacher_timetable(renderer *renderer, const renderer_config
                   model->n_courses, &red, &green, &blue))
         return false;
 
+    int *slot_assignments = callocx(D * S, sizeof(int));
     int max_slot_assignments = 0;
 
-    FOR_D {
-        FOR_S {
-            int slot_assignments = 0;
-            FOR_C {
-                if (!model_course_is_taught_by_teacher(model, c, teacher->index))
-                    continue;
-
-                FOR_R {
-                    slot_assignments += solution->timetable_crds[
-                            INDEX4(c, model->n_courses,
-                                   r, model->n_rooms,
-                                   d, model->n_days,
-                                   s, model->n_slots)];
-                }
-            }
-            max_slot_assignments = MAX(max_slot_assignments, slot_assignments);
-        }
+    FOR_L {
+        const assignment *a = &solution->assignments[l];
+        const int c = model->lectures[l].course->index;
+        if (a->r < 0 || !(model_course_is_taught_by_teacher(model, c, teacher->index)))
+            continue;
+
+        int *n = &slot_assignments[INDEX2(a->d, D, a->s, S)];
+        (*n)++;
+        max_slot_assignments = MAX(max_slot_assignments, *n);
     }
 
     double H = ((double) row_height / max_slot_assignments);
 
-    FOR_D {
-        FOR_S {
-            int slot_index = 0;
-            FOR_C {
-                if (!model_course_is_taught_by_teacher(model, c, teacher->index))
-                    continue;
-
-                FOR_R {
-                    if (solution->timetable_crds[
-                            INDEX4(c, model->n_courses,
-                                   r, model->n_rooms,
-                                   d, model->n_days,
-                                   s, model->n_slots)]) {
-                        double text_r, text_g, text_b;
-                        if (slot_index == 0) {
-                            text_r = text_g = text_b = 0;
-                        } else {
-                            text_r = 1; text_g = 0; text_b = 0;
-                        }
-                        draw_box_text(
-                                renderer, cr,
-                                (d + 1) * col_width,
-                                (s + 1) * row_height + H * slot_index,
-                                col_width,
-                                H,
-                                red[c], green[c], blue[c],
-                                config->font_size_small, false, false,
-                                text_r, text_g, text_b,
-                                "%s (%s)", model->courses[c].id, model->rooms[r].id);
-                        slot_index++;
-                    }
-                }
-            }
+    memset(slot_assignments, 0, D * S * sizeof(int));
+
+    FOR_L {
+        const assignment *a = &solution->assignments[l];
+        const int c = model->lectures[l].course->index;
+        if (a->r < 0 || !(model_course_is_taught_by_teacher(model, c, teacher->index)))
+            continue;
+
+        int slot_index = slot_assignments[INDEX2(a->d, D, a->s, S)]++;
+        double text_r, text_g, text_b;
+        if (slot_index == 0) {
+            text_r = text_g = text_b = 0;
+        } else {
+            text_r = 1;  text_g = 0; text_b = 0;
         }
+        draw_box_text(
+                renderer, cr,
+                (a->d + 1) * col_width,
+                (a->s + 1) * row_height + H * slot_index,
+                col_width,
+                H,
+                red[c], green[c], blue[c],
+                config->font_size_small, false, false,
+                text_r, text_g, text_b,
+                "%s (%s)", model->courses[c].id, model->rooms[a->r].id);
     }
 
+    free(slot_assignments);
+
     return epilogue(renderer, config, solution,
                     cr, surface,
                     path,
@@ -690,29 +650,22 @@ bool renderer_render_overview_timetable(renderer *renderer, const renderer_confi
     
     double H = ((double) row_height / model->n_rooms);
 
-    FOR_D {
-        FOR_S {
-            FOR_C {
-                FOR_R {
-                    if(solution->timetable_crds[
-                            INDEX4(c, model->n_courses,
-                                   r, model->n_rooms,
-                                   d, model->n_days,
-                                   s, model->n_slots)]) {
-                        draw_box_text(
-                                renderer, cr,
-                                (d + 1) * col_width,
-                                (s + 1) * row_height + H * r,
-                                col_width,
-                                H,
-                                red[c], green[c], blue[c],
-                                font_size, false, false,
-                                BLACK,
-                                "%s (%s)", model->courses[c].id, model->rooms[r].id);
-                    }
-                }
-            }
-        }
+    FOR_L {
+        const assignment *a = &solution->assignments[l];
+        const int c = model->lectures[l].course->index;
+        if (a->r < 0)
+            continue;
+
+        draw_box_text(
+                renderer, cr,
+                (a->d + 1) * col_width,
+                (a->s + 1) * row_height + H * a->r,
+                col_width,
+                H,
+                red[c], green[c], blue[c],
+                font_size, false, false,
+                BLACK,
+                "%s (%s)", model->courses[c].id, model->rooms[a->r].id);
     }
 
     return epilogue(renderer, config, solution,
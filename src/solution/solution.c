@@ -1,5 +1,6 @@
 #include "solution.h"
 #include <errno.h>
+#include <sys/mman.h>
 #include "utils/str_utils.h"
 #include "utils/io_utils.h"
 #include "utils/assert_utils.h"
@@ -12,29 +13,138 @@ const int MIN_WORKING_DAYS_COST_FACTOR = 5;
 const int CURRICULUM_COMPACTNESS_COST_FACTOR = 2;
 const int ROOM_STABILITY_COST_FACTOR = 1;
 
+#define SOLUTION_ARENA_ALIGNMENT 64 // cache line
+#define SOLUTION_ARENA_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+/* Reserve `size` bytes (cache line aligned) within the arena, returns the offset */
+static size_t solution_arena_reserve(size_t *arena_size, size_t size) {
+    size_t offset = *arena_size;
+    *arena_size += (size + SOLUTION_ARENA_ALIGNMENT - 1) /
+            SOLUTION_ARENA_ALIGNMENT * SOLUTION_ARENA_ALIGNMENT;
+    return offset;
+}
+
+/*
+ * Allocate the arena.
+ * Big arenas are aligned to the huge page size and advised
+ * for being backed by transparent huge pages (if supported).
+ */
+static void *solution_arena_alloc(size_t *size) {
+#ifdef MADV_HUGEPAGE
+    if (*size >= SOLUTION_ARENA_HUGE_PAGE_SIZE) {
+        *size = (*size + SOLUTION_ARENA_HUGE_PAGE_SIZE - 1) /
+                SOLUTION_ARENA_HUGE_PAGE_SIZE * SOLUTION_ARENA_HUGE_PAGE_SIZE;
+        void *arena = aligned_mallocx(SOLUTION_ARENA_HUGE_PAGE_SIZE, *size);
+        madvise(arena, *size, MADV_HUGEPAGE);
+        return arena;
+    }
+#endif
+    return aligned_mallocx(SOLUTION_ARENA_ALIGNMENT, *size);
+}
+
+#if SOLUTION_COUNTER_BITS < 32
+/*
+ * Exit if a counter could overflow: the upper bound of each counter
+ * is the number of lectures of its course/curriculum/teacher.
+ */
+static void solution_check_counters_width(const model *m) {
+    MODEL(m);
+    int max_lectures = 0;
+    int *lectures_of_teacher = callocx(T, sizeof(int));
+
+    FOR_C {
+        max_lectures = MAX(max_lectures, model->courses[c].n_lectures);
+        lectures_of_teacher[model->teacher_of_course[c]] += model->courses[c].n_lectures;
+    }
+    FOR_T {
+        max_lectures = MAX(max_lectures, lectures_of_teacher[t]);
+    }
+    FOR_Q {
+        int n_courses;
+        int *courses = model_courses_of_curricula(model, q, &n_courses);
+        int lectures_of_curricula = 0;
+        for (int i = 0; i < n_courses; i++)
+            lectures_of_curricula += model->courses[courses[i]].n_lectures;
+        max_lectures = MAX(max_lectures, lectures_of_curricula);
+    }
+
+    free(lectures_of_teacher);
+
+    if (max_lectures > SOLUTION_COUNTER_MAX) {
+        eprint("ERROR: %d lectures can't be counted by %d bits counters "
+               "(build with a greater SOLUTION_COUNTER_BITS)",
+               max_lectures, SOLUTION_COUNTER_BITS);
+        exit(EXIT_FAILURE);
+    }
+}
+#endif
+
 void solution_init(solution *sol, const model *m) {
     MODEL(m);
     static int solution_id = 0;
-    sol->_id = solution_id++;
+    sol->_id = __atomic_fetch_add(&solution_id, 1, __ATOMIC_RELAXED); // (also from the threads of decomposition)
 
     debug2("Initializing solution {%d}", sol->_id);
 
     sol->model = model;
 
-    sol->timetable_crds = mallocx(C * R * D * S, sizeof(bool));
-
-    sol->c_rds = mallocx(R * D * S, sizeof(int));
-    sol->r_cds = mallocx(C * D * S, sizeof(int));
-    sol->l_rds = mallocx(R * D * S, sizeof(int));
+#if SOLUTION_COUNTER_BITS < 32
+    solution_check_counters_width(model);
+#endif
 
-    sol->sum_cr = mallocx(C * R, sizeof(int));
-    sol->sum_cds = mallocx(C * D * S, sizeof(int));
-    sol->sum_cd = mallocx(C * D, sizeof(int));
-    sol->sum_rds = mallocx(R * D * S, sizeof(int));
-    sol->sum_qds = mallocx(Q * D * S, sizeof(int));
-    sol->sum_tds = mallocx(T * D * S, sizeof(int));
+    if (S > 64) {
+        eprint("ERROR: no more than 64 slots per day are supported (%d given)", S);
+        exit(EXIT_FAILURE);
+    }
 
-    sol->assignments = mallocx(model->n_lectures, sizeof(assignment));
+    size_t size = 0;
+
+    // Cleared to -1
+    size_t c_rds = solution_arena_reserve(&size, R * D * S * sizeof(int));
+    size_t r_cds = solution_arena_reserve(&size, C * D * S * sizeof(int));
+    size_t l_rds = solution_arena_reserve(&size, R * D * S * sizeof(int));
+    size_t assignments = solution_arena_reserve(&size, L * sizeof(assignment));
+    sol->_arena_unassigned_size = size;
+
+    // Cleared to 0
+    size_t sum_cr = solution_arena_reserve(&size, C * R * sizeof(int));
+    size_t sum_cds = solution_arena_reserve(&size, C * P * sizeof(solution_counter));
+    size_t sum_cd = solution_arena_reserve(&size, C * D * sizeof(int));
+    size_t sum_rds = solution_arena_reserve(&size, R * D * S * sizeof(int));
+    size_t sum_qds = solution_arena_reserve(&size, Q * P * sizeof(solution_counter));
+    size_t sum_tds = solution_arena_reserve(&size, T * P * sizeof(solution_counter));
+    size_t working_days_c = solution_arena_reserve(&size, C * sizeof(int));
+    size_t used_rooms_c = solution_arena_reserve(&size, C * sizeof(int));
+    const int W = model->curriculas_bitset_words;
+    size_t busy_pq = solution_arena_reserve(&size, P * W * sizeof(uint64_t));
+    size_t crowded_pq = solution_arena_reserve(&size, P * W * sizeof(uint64_t));
+    size_t slots_qd = solution_arena_reserve(&size, Q * D * sizeof(uint64_t));
+
+    char *arena = solution_arena_alloc(&size);
+    sol->_arena = arena;
+    sol->_arena_size = size;
+
+    sol->c_rds = (int *) (arena + c_rds);
+    sol->r_cds = (int *) (arena + r_cds);
+    sol->l_rds = (int *) (arena + l_rds);
+    sol->assignments = (assignment *) (arena + assignments);
+
+    sol->sum_cr = (int *) (arena + sum_cr);
+    sol->sum_cds = (solution_counter *) (arena + sum_cds);
+    sol->sum_cd = (int *) (arena + sum_cd);
+    sol->sum_rds = (int *) (arena + sum_rds);
+    sol->sum_qds = (solution_counter *) (arena + sum_qds);
+    sol->sum_tds = (solution_counter *) (arena + sum_tds);
+    sol->working_days_c = (int *) (arena + working_days_c);
+    sol->used_rooms_c = (int *) (arena + used_rooms_c);
+    sol->busy_pq = (uint64_t *) (arena + busy_pq);
+    sol->crowded_pq = (uint64_t *) (arena + crowded_pq);
+    sol->slots_qd = (uint64_t *) (arena + slots_qd);
+
+    sol->_transaction = false;
+    sol->_undo_log = NULL;
+    sol->_undo_log_len = 0;
+    sol->_undo_log_capacity = 0;
 
     solution_clear(sol);
 }
@@ -42,78 +152,237 @@ void solution_init(solution *sol, const model *m) {
 void solution_clear(solution *sol) {
     MODEL(sol->model);
     debug2("Clearing solution {%d}", sol->_id);
+    assert(!sol->_transaction);
 
-    memset(sol->timetable_crds, 0, C * R * D * S * sizeof(bool));
+    memset(sol->_arena, -1, sol->_arena_unassigned_size);
+    memset((char *) sol->_arena + sol->_arena_unassigned_size, 0,
+           sol->_arena_size - sol->_arena_unassigned_size);
 
-    memset(sol->c_rds, -1, R * D * S * sizeof(int));
-    memset(sol->r_cds, -1, C * D * S * sizeof(int));
-    memset(sol->l_rds, -1, R * D * S * sizeof(int));
-
-    memset(sol->sum_cr, 0, C * R * sizeof(int));
-    memset(sol->sum_cds, 0, C * D * S * sizeof(int));
-    memset(sol->sum_cd, 0, C * D * sizeof(int));
-    memset(sol->sum_rds, 0, R * D * S * sizeof(int));
-    memset(sol->sum_qds, 0, Q * D * S * sizeof(int));
-    memset(sol->sum_tds, 0, T * D * S * sizeof(int));
+    // Each course has no working days at all
+    sol->costs.room_capacity = 0;
+    sol->costs.min_working_days = 0;
+    sol->costs.curriculum_compactness = 0;
+    sol->costs.room_stability = 0;
+    FOR_C {
+        sol->costs.min_working_days +=
+            model->courses[c].min_working_days * MIN_WORKING_DAYS_COST_FACTOR;
+    }
 
-    memset(sol->assignments, -1, model->n_lectures * sizeof(assignment));
+    sol->fingerprint = 0;
 }
 
 void solution_destroy(solution *sol) {
     debug2("Destroying solution {%d}", sol->_id);
+    free(sol->_arena);
+    free(sol->_undo_log);
+}
 
-    free(sol->timetable_crds);
+void solution_copy(solution *sol_dest, const solution *sol_src) {
+    debug2("Copying solution {%d} -> %d", sol_src->_id, sol_dest->_id);
+    assert(sol_dest->_arena_size == sol_src->_arena_size);
+    assert(!sol_dest->_transaction);
 
-    free(sol->c_rds);
-    free(sol->r_cds);
-    free(sol->l_rds);
+    sol_dest->model = sol_src->model; // should already be the same
+    memcpy(sol_dest->_arena, sol_src->_arena, sol_src->_arena_size);
+    sol_dest->costs = sol_src->costs;
+    sol_dest->fingerprint = sol_src->fingerprint;
+}
 
-    free(sol->sum_cr);
-    free(sol->sum_cds);
-    free(sol->sum_cd);
-    free(sol->sum_rds);
-    free(sol->sum_qds);
-    free(sol->sum_tds);
+void solution_pool_init(solution_pool *pool, const model *model) {
+    pool->model = model;
+    pool->solutions = g_array_new(false, false, sizeof(solution *));
+}
 
-    free(sol->assignments);
+void solution_pool_destroy(solution_pool *pool) {
+    for (int i = 0; i < pool->solutions->len; i++) {
+        solution *sol = g_array_index(pool->solutions, solution *, i);
+        solution_destroy(sol);
+        free(sol);
+    }
+    g_array_free(pool->solutions, true);
 }
 
-void solution_copy(solution *sol_dest, const solution *sol_src) {
-    MODEL(sol_src->model);
-    debug2("Copying solution {%d} -> %d", sol_src->_id, sol_dest->_id);
+solution *solution_pool_acquire(solution_pool *pool) {
+    if (!pool->solutions->len) {
+        solution *sol = mallocx(1, sizeof(solution));
+        solution_init(sol, pool->model);
+        return sol;
+    }
+
+    int last = pool->solutions->len - 1;
+    solution *sol = g_array_index(pool->solutions, solution *, last);
+    g_array_set_size(pool->solutions, last);
+    return sol;
+}
 
-    sol_dest->model = model; // should already be the same
+void solution_pool_release(solution_pool *pool, solution *sol) {
+    assert(sol->model == pool->model);
+    g_array_append_val(pool->solutions, sol);
+}
 
-    memcpy(sol_dest->timetable_crds, sol_src->timetable_crds,
-           C * R * D * S * sizeof(bool));
+void solution_snapshot_init(solution_snapshot *snapshot, const model *model) {
+    snapshot->model = model;
+    snapshot->assignments = mallocx(model->n_lectures, sizeof(assignment));
+    memset(snapshot->assignments, -1, model->n_lectures * sizeof(assignment));
+}
 
-    memcpy(sol_dest->c_rds, sol_src->c_rds,
-           R * D * S * sizeof(int));
-    memcpy(sol_dest->r_cds, sol_src->r_cds,
-           C * D * S * sizeof(int));
-    memcpy(sol_dest->l_rds, sol_src->l_rds,
-           R * D * S * sizeof(int));
+void solution_snapshot_destroy(solution_snapshot *snapshot) {
+    free(snapshot->assignments);
+}
 
-    memcpy(sol_dest->sum_cds, sol_src->sum_cds,
-           C * D * S * sizeof(int));
-    memcpy(sol_dest->sum_rds, sol_src->sum_rds,
-           R * D * S * sizeof(int));
-    memcpy(sol_dest->sum_qds, sol_src->sum_qds,
-           Q * D * S * sizeof(int));
-    memcpy(sol_dest->sum_tds, sol_src->sum_tds,
-           T * D * S * sizeof(int));
-    memcpy(sol_dest->sum_cr, sol_src->sum_cr,
-           C * R * sizeof(int));
-    memcpy(sol_dest->sum_cd, sol_src->sum_cd,
-           C * D * sizeof(int));
+void solution_take_snapshot(solution_snapshot *snapshot, const solution *sol) {
+    debug2("Taking snapshot of solution {%d}", sol->_id);
+    memcpy(snapshot->assignments, sol->assignments,
+           sol->model->n_lectures * sizeof(assignment));
+}
 
-    memcpy(sol_dest->assignments, sol_src->assignments,
-           model->n_lectures * sizeof(assignment));
+static bool assignment_equal(const assignment *a1, const assignment *a2) {
+    return a1->r == a2->r && a1->d == a2->d && a1->s == a2->s;
+}
+
+/*
+ * Replay the snapshot on the solution: only the lectures whose
+ * assignment differs are touched, thus restoring a snapshot of a
+ * solution close to `sol` is much cheaper than a full solution_copy.
+ */
+void solution_restore_snapshot(solution *sol, const solution_snapshot *snapshot) {
+    MODEL(sol->model);
+    debug2("Restoring snapshot into solution {%d}", sol->_id);
+
+    // Unassign all the changed lectures before, otherwise
+    // a lecture could be assigned to a still occupied room
+    FOR_L {
+        if (!assignment_equal(&sol->assignments[l], &snapshot->assignments[l]) &&
+            sol->assignments[l].r >= 0)
+            solution_unassign_lecture(sol, l);
+    }
+
+    FOR_L {
+        const assignment *a = &snapshot->assignments[l];
+        if (!assignment_equal(&sol->assignments[l], a) && a->r >= 0)
+            solution_assign_lecture(sol, l, a->r, a->d, a->s);
+    }
+}
+
+/*
+ * Zobrist key of course c assigned to (r,d,s).
+ * The keys are derived from the cell index (splitmix64 finalizer)
+ * instead of being stored, since a table would be C*R*D*S large.
+ * The key depends on the course, not on the lecture, thus equal
+ * timetables have the same fingerprint.
+ */
+static unsigned long long solution_zobrist_key(const model *model, int c, int r, int d, int s) {
+    unsigned long long x = INDEX4((unsigned long long) c, model->n_courses,
+                                  r, model->n_rooms, d, model->n_days, s, model->n_slots);
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/*
+ * Penalty (without factor) of the isolated lectures of curricula q
+ * on day d, considering only the slots s-1, s and s+1, which are the
+ * only ones affected by a change of sum_qds[q,d,s].
+ */
+static int solution_curriculum_compactness_local_penalty(const solution *sol,
+                                                         int q, int d, int s) {
+    MODEL(sol->model);
+    int penalty = 0;
+
+#define SLOT(x) SUM_QDS(sol, q, PERIOD(d, x))
+    for (int x = MAX(0, s - 1); x <= MIN(S - 1, s + 1); x++) {
+        bool prev = x > 0 && SLOT(x - 1);
+        bool next = x < S - 1 && SLOT(x + 1);
+        if (SLOT(x) && !prev && !next)
+            penalty += SLOT(x);
+    }
+#undef SLOT
+
+    return penalty;
+}
+
+/* Begin a transaction, which can be committed or rolled back */
+void solution_begin(solution *sol) {
+    debug2("Beginning transaction on solution {%d}", sol->_id);
+    assert(!sol->_transaction);
+    sol->_transaction = true;
+    sol->_undo_log_len = 0;
+    sol->_undo_costs = sol->costs;
+    sol->_undo_fingerprint = sol->fingerprint;
+}
+
+void solution_commit(solution *sol) {
+    debug2("Committing transaction on solution {%d} (%d entries)",
+           sol->_id, sol->_undo_log_len);
+    assert(sol->_transaction);
+    sol->_transaction = false;
+}
+
+void solution_rollback(solution *sol) {
+    debug2("Rolling back transaction on solution {%d} (%d entries)",
+           sol->_id, sol->_undo_log_len);
+    assert(sol->_transaction);
+
+    // Restore in reverse order, since the same location may appear more times
+    for (int i = sol->_undo_log_len - 1; i >= 0; i--) {
+        const solution_undo_entry *entry = &sol->_undo_log[i];
+        if (entry->kind == SOLUTION_UNDO_COUNTER)
+            *(solution_counter *) entry->ptr = (solution_counter) entry->value;
+        else if (entry->kind == SOLUTION_UNDO_WORD)
+            *(uint64_t *) entry->ptr = entry->value;
+        else
+            *(int *) entry->ptr = (int) entry->value;
+    }
+
+    sol->costs = sol->_undo_costs;
+    sol->fingerprint = sol->_undo_fingerprint;
+    sol->_transaction = false;
+
+    solution_assert_consistency(sol);
+}
+
+static inline void solution_undo_record(solution *sol, void *ptr, uint64_t value,
+                                        solution_undo_kind kind) {
+    if (sol->_undo_log_len == sol->_undo_log_capacity) {
+        sol->_undo_log_capacity = MAX(64, sol->_undo_log_capacity * 2);
+        sol->_undo_log = reallocx(sol->_undo_log, sol->_undo_log_capacity,
+                                  sizeof(solution_undo_entry));
+    }
+    solution_undo_entry *entry = &sol->_undo_log[sol->_undo_log_len++];
+    entry->ptr = ptr;
+    entry->value = value;
+    entry->kind = kind;
+}
+
+/* Set *ptr to value, recording the old value if within a transaction */
+static inline void solution_set(solution *sol, int *ptr, int value) {
+    if (sol->_transaction)
+        solution_undo_record(sol, ptr, (uint64_t) *ptr, SOLUTION_UNDO_INT);
+    *ptr = value;
+}
+
+/* Add delta to the counter *ptr, recording the old value if within a transaction */
+static inline void solution_add_counter(solution *sol, solution_counter *ptr, int delta) {
+    if (sol->_transaction)
+        solution_undo_record(sol, ptr, (uint64_t) *ptr, SOLUTION_UNDO_COUNTER);
+    *ptr += delta;
+}
+
+/* Set or clear the bit `bit` of the bitset `words`, recording the old word if within a transaction */
+static inline void solution_set_bit(solution *sol, uint64_t *words, int bit, bool value) {
+    uint64_t *word = &words[bit / 64];
+    if (sol->_transaction)
+        solution_undo_record(sol, word, *word, SOLUTION_UNDO_WORD);
+    if (value)
+        *word |= (uint64_t) 1 << (bit % 64);
+    else
+        *word &= ~((uint64_t) 1 << (bit % 64));
 }
 
 /*
  * Core method that modifies the solution,
- * keeping the redundant data consistent.
+ * keeping the redundant data (and the costs) consistent.
  * if yes is true: assigns (r,d,s) to lecture l (of course c, even if it is implicit).
  * if yes is false: unassigns (r,d,s) from lecture l (of course c, even if it is implicit).
  */
@@ -125,28 +394,71 @@ static void solution_update(solution *sol, int l, int c, int r, int d, int s, bo
 
     int n_curriculas;
     int *curriculas = model_curriculas_of_course(sol->model, c, &n_curriculas);
-    int t = sol->model->courses[c].teacher->index;
+    const course *course = &sol->model->courses[c];
+    int t = model->teacher_of_course[c];
+    const int delta = yes ? 1 : -1;
+    const int W = model->curriculas_bitset_words;
+
+    // S1: RoomCapacity
+    sol->costs.room_capacity += delta *
+            model->room_capacity_penalty[INDEX2(c, C, r, R)] *
+            ROOM_CAPACITY_COST_FACTOR;
+
+    // S2: MinWorkingDays (changes only if the day becomes used/unused)
+    int cd = sol->sum_cd[INDEX2(c, C, d, D)];
+    if ((yes && cd == 0) || (!yes && cd == 1)) {
+        int wd_before = sol->working_days_c[c];
+        int wd_after = wd_before + delta;
+        sol->costs.min_working_days +=
+                (MAX(0, course->min_working_days - wd_after) -
+                 MAX(0, course->min_working_days - wd_before)) *
+                MIN_WORKING_DAYS_COST_FACTOR;
+        solution_set(sol, &sol->working_days_c[c], wd_after);
+    }
 
-    sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)] = yes;
+    // S4: RoomStability (changes only if the room becomes used/unused)
+    int cr = sol->sum_cr[INDEX2(c, C, r, R)];
+    if ((yes && cr == 0) || (!yes && cr == 1)) {
+        int rooms_before = sol->used_rooms_c[c];
+        int rooms_after = rooms_before + delta;
+        sol->costs.room_stability +=
+                (MAX(0, rooms_after - 1) - MAX(0, rooms_before - 1)) *
+                ROOM_STABILITY_COST_FACTOR;
+        solution_set(sol, &sol->used_rooms_c[c], rooms_after);
+    }
+
+    sol->fingerprint ^= solution_zobrist_key(model, c, r, d, s);
 
-    sol->c_rds[INDEX3(r, R, d, D, s, S)] = yes ? c : -1;
-    sol->r_cds[INDEX3(c, C, d, D, s, S)] = yes ? r : -1;
-    sol->l_rds[INDEX3(r, R, d, D, s, S)] = yes ? l : -1;
+    solution_set(sol, &sol->c_rds[INDEX3(r, R, d, D, s, S)], yes ? c : -1);
+    solution_set(sol, &sol->r_cds[INDEX3(c, C, d, D, s, S)], yes ? r : -1);
+    solution_set(sol, &sol->l_rds[INDEX3(r, R, d, D, s, S)], yes ? l : -1);
 
-    sol->sum_cr[INDEX2(c, C, r, R)] += yes ? 1 : -1;
-    sol->sum_cd[INDEX2(c, C, d, D)] += yes ? 1 : -1;
-    sol->sum_cds[INDEX3(c, C, d, D, s, S)] += yes ? 1 : -1;
-    sol->sum_rds[INDEX3(r, R, d, D, s, S)] += yes ? 1 : -1;
-    sol->sum_tds[INDEX3(t, T, d, D, s, S)] += yes ? 1 : -1;
+    const int p = PERIOD(d, s);
+    int *sum;
+    sum = &sol->sum_cr[INDEX2(c, C, r, R)]; solution_set(sol, sum, *sum + delta);
+    sum = &sol->sum_cd[INDEX2(c, C, d, D)]; solution_set(sol, sum, *sum + delta);
+    sum = &sol->sum_rds[INDEX3(r, R, d, D, s, S)]; solution_set(sol, sum, *sum + delta);
+    solution_add_counter(sol, &SUM_CDS(sol, c, p), delta);
+    solution_add_counter(sol, &SUM_TDS(sol, t, p), delta);
 
+    // S3: CurriculumCompactness
     for (int i = 0; i < n_curriculas; i++) {
         int q = curriculas[i];
-        sol->sum_qds[INDEX3(q, Q, d, D, s, S)] += yes ? 1 : -1;
-        debug2("sum_qds[%d][%d][%d]=%d", q, d, s, sol->sum_qds[INDEX3(q, Q, d, D, s, S)]);
+        int penalty_before = solution_curriculum_compactness_local_penalty(sol, q, d, s);
+        solution_add_counter(sol, &SUM_QDS(sol, q, p), delta);
+        // The busy and crowded bits change only when the counter crosses 1 or 2
+        int qp = SUM_QDS(sol, q, p);
+        if (qp == (yes ? 1 : 0)) {
+            solution_set_bit(sol, &sol->busy_pq[p * W], q, yes);
+            solution_set_bit(sol, &sol->slots_qd[INDEX2(q, Q, d, D)], s, yes);
+        } else if (qp == (yes ? 2 : 1))
+            solution_set_bit(sol, &sol->crowded_pq[p * W], q, yes);
+        int penalty_after = solution_curriculum_compactness_local_penalty(sol, q, d, s);
+        sol->costs.curriculum_compactness +=
+                (penalty_after - penalty_before) * CURRICULUM_COMPACTNESS_COST_FACTOR;
+        debug2("sum_qds[%d][%d][%d]=%d", q, d, s, SUM_QDS(sol, q, p));
     }
 
-    debug2("tt_crds[%d][%d][%d][%d]=%d", c, r, d, s, sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)]);
-    debug2("tt_cdsr[%d][%d][%d][%d]=%d", c, d, s, r, sol->timetable_cdsr[INDEX4(c, C, d, D, s, S, r, R)]);
     debug2("c_rds[%d][%d][%d]=%d", r, d, s, sol->c_rds[INDEX3(r, R, d, D, s, S)]);
     debug2("r_cds[%d][%d][%d]=%d", c, d, s, sol->r_cds[INDEX3(c, c, d, D, s, S)]);
     debug2("sum_rds[%d][%d][%d]=%d", r, d, s, sol->sum_rds[INDEX3(r, R, d, D, s, S)]);
@@ -156,7 +468,7 @@ void solution_assign_lecture(solution *sol, int l1, int r2, int d2, int s2) {
     assert(l1 >= 0 && l1 < sol->model->n_lectures && r2 >= 0 && r2 < sol->model->n_rooms &&
            d2 >= 0 && d2 < sol->model->n_days && s2 >= 0 && s2 < sol->model->n_slots);
 
-    int c1 = sol->model->lectures[l1].course->index;
+    int c1 = sol->model->course_of_lecture[l1];
     assignment *a1 = &sol->assignments[l1];
 
     debug2("Updating solution {%d}: assigning [lecture %d (%d:%s)] to (r=%d:%s, d=%d, s=%d)",
@@ -166,9 +478,9 @@ void solution_assign_lecture(solution *sol, int l1, int r2, int d2, int s2) {
            d2, s2);
 
     solution_update(sol, l1, c1, r2, d2, s2, true);
-    a1->r = r2;
-    a1->d = d2;
-    a1->s = s2;
+    solution_set(sol, &a1->r, r2);
+    solution_set(sol, &a1->d, d2);
+    solution_set(sol, &a1->s, s2);
 
     solution_assert_consistency(sol);
 }
@@ -176,7 +488,7 @@ void solution_assign_lecture(solution *sol, int l1, int r2, int d2, int s2) {
 void solution_unassign_lecture(solution *sol, int l) {
     assert(l >= 0 && l < sol->model->n_lectures);
 
-    int c = sol->model->lectures[l].course->index;
+    int c = sol->model->course_of_lecture[l];
     assignment *a = &sol->assignments[l];
 
     debug2("Updating solution {%d}: unassigning [lecture %d (%d:%s)] previously in (r=%d:%s, d=%d, s=%d)",
@@ -186,9 +498,9 @@ void solution_unassign_lecture(solution *sol, int l) {
            a->d, a->s);
 
     solution_update(sol, l, c, a->r, a->d, a->s, false);
-    a->r = -1;
-    a->d = -1;
-    a->s = -1;
+    solution_set(sol, &a->r, -1);
+    solution_set(sol, &a->d, -1);
+    solution_set(sol, &a->s, -1);
 
     solution_assert_consistency(sol);
 }
@@ -249,25 +561,51 @@ bool solution_satisfy_conflicts(const solution *sol) {
 /*
  * Hard constraints checkers.
  *
- * Implementation note: these use only timetable_crds instead of the
+ * Implementation note: these use only the assignments instead of the
  * helpers (even if it should be faster with the helpers) for being more easy debug.
  * It's not a problem since these checkers are used only a few times, not frequently.
  */
 
+static bool solution_lecture_is_assigned(const solution *sol, int l) {
+    const assignment *a = &sol->assignments[l];
+    return a->r >= 0 && a->d >= 0 && a->s >= 0;
+}
+
+/* Number of lectures of each curricula assigned on each period: [q,d,s] */
+static int *solution_curricula_usage(const solution *sol) {
+    MODEL(sol->model);
+    int *curricula_usage = callocx(Q * D * S, sizeof(int));
+
+    FOR_L {
+        if (!solution_lecture_is_assigned(sol, l))
+            continue;
+
+        const assignment *a = &sol->assignments[l];
+        int n_curriculas;
+        int *curriculas = model_curriculas_of_course(
+                model, model->course_of_lecture[l], &n_curriculas);
+
+        for (int i = 0; i < n_curriculas; i++)
+            curricula_usage[INDEX3(curriculas[i], Q, a->d, D, a->s, S)]++;
+    }
+
+    return curricula_usage;
+}
+
 static int solution_hard_constraint_lectures_violations_a(const solution *sol,
                                                           char **strout, size_t *strsize) {
     MODEL(sol->model);
     int violations = 0;
 
+    int *lectures = callocx(C, sizeof(int));
+
+    FOR_L {
+        if (solution_lecture_is_assigned(sol, l))
+            lectures[model->course_of_lecture[l]]++;
+    }
+
     FOR_C {
-        int n = 0;
-        FOR_R {
-            FOR_D {
-                FOR_S {
-                    n += sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)];
-                }
-            }
-        }
+        int n = lectures[c];
         const course *course = &sol->model->courses[c];
         int delta = course->n_lectures - n;
         if (delta > 0) {
@@ -282,6 +620,7 @@ static int solution_hard_constraint_lectures_violations_a(const solution *sol,
             violations += delta;
         }
     }
+    free(lectures);
 
     return violations;
 }
@@ -293,15 +632,11 @@ static int solution_hard_constraint_lectures_violations_b(const solution *sol,
     int violations = 0;
     int *room_usage = callocx(C * D * S, sizeof(int));
 
-    FOR_C {
-        FOR_R {
-            FOR_D {
-                FOR_S {
-                    room_usage[INDEX3(c, C, d, D, s, S)] +=
-                            sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)];
-                }
-            }
-        }
+    FOR_L {
+        if (!solution_lecture_is_assigned(sol, l))
+            continue;
+        const assignment *a = &sol->assignments[l];
+        room_usage[INDEX3(model->course_of_lecture[l], C, a->d, D, a->s, S)]++;
     }
 
     FOR_C {
@@ -343,14 +678,19 @@ static int solution_room_occupancy_violations_dump(const solution *sol,
     MODEL(sol->model);
 
     int violations = 0;
+    int *room_usage = callocx(R * D * S, sizeof(int));
+
+    FOR_L {
+        if (!solution_lecture_is_assigned(sol, l))
+            continue;
+        const assignment *a = &sol->assignments[l];
+        room_usage[INDEX3(a->r, R, a->d, D, a->s, S)]++;
+    }
 
     FOR_R {
         FOR_D {
             FOR_S {
-                int n = 0;
-                FOR_C {
-                    n += sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)];
-                }
+                int n = room_usage[INDEX3(r, R, d, D, s, S)];
                 if (!(n <= 1)) {
                     debug2("H2 [RoomOccupancy] violation: %d courses in room '%s' "
                           "at (day=%d, slot=%d)",
@@ -365,6 +705,7 @@ static int solution_room_occupancy_violations_dump(const solution *sol,
             };
         }
     }
+    free(room_usage);
 
     return violations;
 }
@@ -378,20 +719,12 @@ static int solution_hard_constraint_conflicts_violations_a(const solution *sol,
     MODEL(sol->model);
 
     int violations = 0;
+    int *curricula_usage = solution_curricula_usage(sol);
 
     FOR_Q {
-        int q_n_courses;
-        int *q_courses = model_courses_of_curricula(sol->model, q, &q_n_courses);
-
         FOR_D {
             FOR_S {
-                int n = 0;
-
-                for (int qc = 0; qc < q_n_courses; qc++) {
-                    for (int r = 0; r < sol->model->n_rooms; r++) {
-                        n += sol->timetable_crds[INDEX4(q_courses[qc], C, r, R, d, D, s, S)];
-                    }
-                }
+                int n = curricula_usage[INDEX3(q, Q, d, D, s, S)];
 
                 if (!(n <= 1)) {
                     debug2("H3 [Conflicts] violation: %d courses of curriculum '%s' "
@@ -407,6 +740,7 @@ static int solution_hard_constraint_conflicts_violations_a(const solution *sol,
             }
         }
     }
+    free(curricula_usage);
 
     return violations;
 }
@@ -416,19 +750,19 @@ static int solution_hard_constraint_conflicts_violations_b(const solution *sol,
     MODEL(sol->model);
 
     int violations = 0;
+    int *teacher_usage = callocx(T * D * S, sizeof(int));
 
-    FOR_T {
-        int t_n_courses;
-        int *t_courses = model_courses_of_teacher(sol->model, t, &t_n_courses);
+    FOR_L {
+        if (!solution_lecture_is_assigned(sol, l))
+            continue;
+        const assignment *a = &sol->assignments[l];
+        teacher_usage[INDEX3(model->teacher_of_course[model->course_of_lecture[l]], T, a->d, D, a->s, S)]++;
+    }
 
+    FOR_T {
         FOR_D {
             FOR_S {
-                int n = 0;
-                for (int tc = 0; tc < t_n_courses; tc++) {
-                    FOR_R {
-                        n += sol->timetable_crds[INDEX4(t_courses[tc], C, r, R, d, D, s, S)];
-                    }
-                }
+                int n = teacher_usage[INDEX3(t, T, d, D, s, S)];
 
                 if (!(n <= 1)) {
                     debug2("H3 [Conflicts] violation: %d courses taught by "
@@ -444,6 +778,7 @@ static int solution_hard_constraint_conflicts_violations_b(const solution *sol,
             }
         }
     }
+    free(teacher_usage);
 
     return violations;
 }
@@ -464,14 +799,19 @@ static int solution_availabilities_violations_dump(const solution *sol,
     MODEL(sol->model);
 
     int violations = 0;
+    int *course_usage = callocx(C * D * S, sizeof(int));
+
+    FOR_L {
+        if (!solution_lecture_is_assigned(sol, l))
+            continue;
+        const assignment *a = &sol->assignments[l];
+        course_usage[INDEX3(model->course_of_lecture[l], C, a->d, D, a->s, S)]++;
+    }
 
     FOR_C {
         FOR_D {
             FOR_S {
-                int n = 0;
-                FOR_R {
-                    n += sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)];
-                }
+                int n = course_usage[INDEX3(c, C, d, D, s, S)];
                 if (!(n <= model_course_is_available_on_period(sol->model, c, d, s))) {
                     debug2("H4 [Availabilities] violation: course '%s' scheduled %d time(s) on "
                           "(day=%d, slot=%d) but breaks unavailability constraint",
@@ -486,6 +826,7 @@ static int solution_availabilities_violations_dump(const solution *sol,
             };
         }
     }
+    free(course_usage);
 
     return violations;
 }
@@ -496,10 +837,14 @@ int solution_availabilities_violations(const solution *sol) {
 
 int solution_cost(const solution *sol) {
     return
-            solution_room_capacity_cost(sol) +
-            solution_min_working_days_cost(sol) +
-            solution_curriculum_compactness_cost(sol) +
-            solution_room_stability_cost(sol);
+            sol->costs.room_capacity +
+            sol->costs.min_working_days +
+            sol->costs.curriculum_compactness +
+            sol->costs.room_stability;
+}
+
+void solution_cost_breakdown(const solution *sol, solution_costs *costs) {
+    *costs = sol->costs;
 }
 
 static int solution_room_capacity_cost_dump(const solution *sol,
@@ -508,42 +853,41 @@ static int solution_room_capacity_cost_dump(const solution *sol,
 
     int penalties = 0;
 
-    FOR_C {
-        FOR_R {
-            FOR_D {
-                FOR_S {
-                    if (sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)]) {
-                        int delta = sol->model->courses[c].n_students - sol->model->rooms[r].capacity;
-                        if (delta > 0) {
-                            debug2("S1(%d) [RoomCapacity] penalty: course '%s' has %d"
-                                  " students but it's scheduled in room '%s' with %d "
-                                  "seats at (day=%d, slot=%d)",
-                                   delta * ROOM_CAPACITY_COST_FACTOR,
-                                  sol->model->courses[c].id, sol->model->courses[c].n_students,
-                                  sol->model->rooms[r].id, sol->model->rooms[r].capacity,
-                                  d, s);
-                            if (strout && *strout)
-                                strappend_realloc(strout, strsize,
-                                    "S1(%d) [RoomCapacity] penalty: course '%s' has %d"
-                                    " students but it's scheduled in room '%s' with %d "
-                                    "seats at (day=%d, slot=%d)\n",
-                                                  delta * ROOM_CAPACITY_COST_FACTOR,
-                                    sol->model->courses[c].id, sol->model->courses[c].n_students,
-                                    sol->model->rooms[r].id, sol->model->rooms[r].capacity,
-                                    d, s);
-                            penalties += delta;
-                        }
-                    }
-                }
-            }
+    FOR_L {
+        if (!solution_lecture_is_assigned(sol, l))
+            continue;
+
+        const assignment *a = &sol->assignments[l];
+        const course *course = model->lectures[l].course;
+        const room *room = &model->rooms[a->r];
+
+        int delta = course->n_students - room->capacity;
+        if (delta > 0) {
+            debug2("S1(%d) [RoomCapacity] penalty: course '%s' has %d"
+                  " students but it's scheduled in room '%s' with %d "
+                  "seats at (day=%d, slot=%d)",
+                   delta * ROOM_CAPACITY_COST_FACTOR,
+                  course->id, course->n_students,
+                  room->id, room->capacity,
+                  a->d, a->s);
+            if (strout && *strout)
+                strappend_realloc(strout, strsize,
+                    "S1(%d) [RoomCapacity] penalty: course '%s' has %d"
+                    " students but it's scheduled in room '%s' with %d "
+                    "seats at (day=%d, slot=%d)\n",
+                                  delta * ROOM_CAPACITY_COST_FACTOR,
+                    course->id, course->n_students,
+                    room->id, room->capacity,
+                    a->d, a->s);
+            penalties += delta;
         }
-    };
+    }
 
     return penalties * ROOM_CAPACITY_COST_FACTOR;
 }
 
 int solution_room_capacity_cost(const solution *sol) {
-    return solution_room_capacity_cost_dump(sol, NULL, NULL);
+    return sol->costs.room_capacity;
 }
 
 static int solution_min_working_days_cost_dump(const solution *sol,
@@ -551,20 +895,19 @@ static int solution_min_working_days_cost_dump(const solution *sol,
     MODEL(sol->model);
 
     int penalties = 0;
+    bool *y_cd = callocx(C * D, sizeof(bool));
+
+    FOR_L {
+        if (solution_lecture_is_assigned(sol, l))
+            y_cd[INDEX2(model->course_of_lecture[l], C,
+                        sol->assignments[l].d, D)] = true;
+    }
 
     FOR_C {
         int sum_y_cd = 0;
 
         FOR_D {
-            int y_cd = 0;
-
-            FOR_R {
-                FOR_S {
-                    y_cd = y_cd || sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)];
-                }
-            }
-
-            sum_y_cd += y_cd;
+            sum_y_cd += y_cd[INDEX2(c, C, d, D)];
         }
 
         int delta = sol->model->courses[c].min_working_days - sum_y_cd;
@@ -585,12 +928,13 @@ static int solution_min_working_days_cost_dump(const solution *sol,
             penalties += delta;
         }
     };
+    free(y_cd);
 
     return penalties * MIN_WORKING_DAYS_COST_FACTOR;
 }
 
 int solution_min_working_days_cost(const solution *sol) {
-    return solution_min_working_days_cost_dump(sol, NULL, NULL);
+    return sol->costs.min_working_days;
 }
 
 static int solution_curriculum_compactness_cost_dump(const solution *sol,
@@ -599,24 +943,11 @@ static int solution_curriculum_compactness_cost_dump(const solution *sol,
 
     int penalties = 0;
 
-    int *slots = mallocx(sol->model->n_slots, sizeof(int));
+    int *curricula_usage = solution_curricula_usage(sol);
 
     FOR_Q {
-        int q_n_courses;
-        int *q_courses = model_courses_of_curricula(sol->model, q, &q_n_courses);
-
         FOR_D {
-            FOR_S {
-                int qds = 0;
-
-                for (int qc = 0; qc < q_n_courses; qc++) {
-                    for (int r = 0; r < sol->model->n_rooms; r++) {
-                        qds += sol->timetable_crds[INDEX4(q_courses[qc], C, r, R, d, D, s, S)];
-                    }
-                }
-
-                slots[s] = qds;
-            }
+            const int *slots = &curricula_usage[INDEX3(q, Q, d, D, 0, S)];
 
             FOR_S {
                 bool prev = s > 0 && slots[s - 1];
@@ -641,12 +972,12 @@ static int solution_curriculum_compactness_cost_dump(const solution *sol,
         }
     };
 
-    free(slots);
+    free(curricula_usage);
     return penalties * CURRICULUM_COMPACTNESS_COST_FACTOR;
 }
 
 int solution_curriculum_compactness_cost(const solution *sol) {
-    return solution_curriculum_compactness_cost_dump(sol, NULL, NULL);
+    return sol->costs.curriculum_compactness;
 }
 
 static int solution_room_stability_cost_dump(const solution *sol,
@@ -654,20 +985,19 @@ static int solution_room_stability_cost_dump(const solution *sol,
     MODEL(sol->model);
 
     int penalties = 0;
+    bool *z_cr = callocx(C * R, sizeof(bool));
+
+    FOR_L {
+        if (solution_lecture_is_assigned(sol, l))
+            z_cr[INDEX2(model->course_of_lecture[l], C,
+                        sol->assignments[l].r, R)] = true;
+    }
 
     FOR_C {
         int sum_z_cr = 0;
 
         FOR_R {
-            int z_cr = 0;
-
-            FOR_D {
-                FOR_S {
-                    z_cr = z_cr || sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)];
-                }
-            };
-
-            sum_z_cr += z_cr;
+            sum_z_cr += z_cr[INDEX2(c, C, r, R)];
         }
 
         int delta = sum_z_cr - 1;
@@ -684,12 +1014,20 @@ static int solution_room_stability_cost_dump(const solution *sol,
             penalties += delta;
         }
     };
+    free(z_cr);
 
     return penalties * ROOM_STABILITY_COST_FACTOR;
 }
 
 int solution_room_stability_cost(const solution *sol) {
-    return solution_room_stability_cost_dump(sol, NULL, NULL);
+    return sol->costs.room_stability;
+}
+
+void solution_compute_cost_breakdown(const solution *sol, solution_costs *costs) {
+    costs->room_capacity = solution_room_capacity_cost_dump(sol, NULL, NULL);
+    costs->min_working_days = solution_min_working_days_cost_dump(sol, NULL, NULL);
+    costs->curriculum_compactness = solution_curriculum_compactness_cost_dump(sol, NULL, NULL);
+    costs->room_stability = solution_room_stability_cost_dump(sol, NULL, NULL);
 }
 
 char *solution_quality_to_string(const solution *sol, bool verbose) {
@@ -756,17 +1094,47 @@ bool write_solution(const solution *sol, const char *filename) {
 /* Debug purposes */
 
 
-/* Compute an unique identifier (~hash) of this solution. */
+/* Unique identifier (~hash) of this solution, kept up to date by the solution. */
 unsigned long long solution_fingerprint(const solution *sol) {
+    return sol->fingerprint;
+}
+
+/* Compute the fingerprint from scratch, walking all the (r,d,s) cells. */
+unsigned long long solution_compute_fingerprint(const solution *sol) {
     MODEL(sol->model);
     unsigned long long h = 0;
-    for (int i = 0; i < C * R * D * S; i++) {
-        h += sol->timetable_crds[i];
-        h *= 85637481940593;
+    FOR_R {
+        FOR_D {
+            FOR_S {
+                int c = sol->c_rds[INDEX3(r, R, d, D, s, S)];
+                if (c >= 0)
+                    h ^= solution_zobrist_key(model, c, r, d, s);
+            }
+        }
     }
     return h;
 }
 
+/*
+ * Rebuild the dense timetable [c,r,d,s] from the assignments.
+ * It's not kept within the solution since its size grows as C*R*D*S,
+ * it's meant only for debug purpose (e.g. consistency checks).
+ */
+static bool *solution_timetable_crds(const solution *sol) {
+    MODEL(sol->model);
+    bool *timetable_crds = callocx(C * R * D * S, sizeof(bool));
+
+    FOR_L {
+        if (!solution_lecture_is_assigned(sol, l))
+            continue;
+        const assignment *a = &sol->assignments[l];
+        timetable_crds[INDEX4(model->course_of_lecture[l], C,
+                              a->r, R, a->d, D, a->s, S)] = true;
+    }
+
+    return timetable_crds;
+}
+
 void solution_assert_consistency(const solution *sol) {
 #ifdef ASSERT
     solution_assert_consistency_real(sol);
@@ -776,14 +1144,14 @@ void solution_assert_consistency(const solution *sol) {
 /* Assert the consistency of the internal structures of the solution */
 void solution_assert_consistency_real(const solution *sol) {
     MODEL(sol->model);
-
+    bool *timetable_crds = solution_timetable_crds(sol);
 
     // c_rds (1)
     FOR_C {
         FOR_R {
             FOR_D {
                 FOR_S {
-                    if (sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)]) {
+                    if (timetable_crds[INDEX4(c, C, r, R, d, D, s, S)]) {
                         assert_real(sol->c_rds[INDEX3(r, R, d, D, s, S)] == c);
                     }
                 }
@@ -797,10 +1165,10 @@ void solution_assert_consistency_real(const solution *sol) {
             FOR_S {
                 int cc = sol->c_rds[INDEX3(r, R, d, D, s, S)];
                 if (cc >= 0)
-                    assert_real(sol->timetable_crds[INDEX4(cc, C, r, R, d, D, s, S)]);
+                    assert_real(timetable_crds[INDEX4(cc, C, r, R, d, D, s, S)]);
                 else {
                     FOR_C {
-                        assert_real(!sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)]);
+                        assert_real(!timetable_crds[INDEX4(c, C, r, R, d, D, s, S)]);
                     }
                 }
             }
@@ -813,7 +1181,7 @@ void solution_assert_consistency_real(const solution *sol) {
         FOR_R {
             FOR_D {
                 FOR_S {
-                    if (sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)]) {
+                    if (timetable_crds[INDEX4(c, C, r, R, d, D, s, S)]) {
                         assert_real(sol->c_rds[INDEX3(r, R, d, D, s, S)] == c);
                     }
                 }
@@ -827,10 +1195,10 @@ void solution_assert_consistency_real(const solution *sol) {
             FOR_S {
                 int rr = sol->r_cds[INDEX3(c, C, d, D, s, S)];
                 if (rr >= 0)
-                    assert_real(sol->timetable_crds[INDEX4(c, C, rr, R, d, D, s, S)]);
+                    assert_real(timetable_crds[INDEX4(c, C, rr, R, d, D, s, S)]);
                 else {
                     FOR_R {
-                        assert_real(!sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)]);
+                        assert_real(!timetable_crds[INDEX4(c, C, r, R, d, D, s, S)]);
                     }
                 }
             }
@@ -842,7 +1210,7 @@ void solution_assert_consistency_real(const solution *sol) {
         FOR_R {
             FOR_D {
                 FOR_S {
-                    if (sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)]) {
+                    if (timetable_crds[INDEX4(c, C, r, R, d, D, s, S)]) {
                         int l = sol->l_rds[INDEX3(r, R, d, D, s, S)];
                         assert_real(l >= 0);
                         assignment *a = &sol->assignments[l];
@@ -861,11 +1229,11 @@ void solution_assert_consistency_real(const solution *sol) {
             FOR_S {
                 int l = sol->l_rds[INDEX3(r, R, d, D, s, S)];
                 if (l >= 0) {
-                    assert_real(sol->timetable_crds[INDEX4(model->lectures[l].course->index, C, r, R, d, D, s, S)]);
+                    assert_real(timetable_crds[INDEX4(model->course_of_lecture[l], C, r, R, d, D, s, S)]);
                 }
                 else {
                     FOR_C {
-                        assert_real(!sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)]);
+                        assert_real(!timetable_crds[INDEX4(c, C, r, R, d, D, s, S)]);
                     }
                 }
             }
@@ -878,7 +1246,7 @@ void solution_assert_consistency_real(const solution *sol) {
             int sum = 0;
             FOR_D {
                 FOR_S {
-                    sum += sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)];
+                    sum += timetable_crds[INDEX4(c, C, r, R, d, D, s, S)];
                 }
             }
             assert_real(sum == sol->sum_cr[INDEX2(c, C, r, R)]);
@@ -891,9 +1259,9 @@ void solution_assert_consistency_real(const solution *sol) {
             FOR_S {
                 int sum = 0;
                 FOR_R {
-                    sum += sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)];
+                    sum += timetable_crds[INDEX4(c, C, r, R, d, D, s, S)];
                 }
-                assert_real(sum == sol->sum_cds[INDEX3(c, C, d, D, s, S)]);
+                assert_real(sum == SUM_CDS(sol, c, PERIOD(d, s)));
             }
         }
     };
@@ -904,20 +1272,35 @@ void solution_assert_consistency_real(const solution *sol) {
             int sum = 0;
             FOR_S {
                 FOR_R {
-                    sum += sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)];
+                    sum += timetable_crds[INDEX4(c, C, r, R, d, D, s, S)];
                 }
             }
             assert_real(sum == sol->sum_cd[INDEX2(c, C, d, D)]);
         }
     };
 
+    // working_days_c, used_rooms_c
+    FOR_C {
+        int working_days = 0;
+        FOR_D {
+            working_days += sol->sum_cd[INDEX2(c, C, d, D)] > 0;
+        }
+        assert_real(working_days == sol->working_days_c[c]);
+
+        int used_rooms = 0;
+        FOR_R {
+            used_rooms += sol->sum_cr[INDEX2(c, C, r, R)] > 0;
+        }
+        assert_real(used_rooms == sol->used_rooms_c[c]);
+    }
+
     // sum_rds
     FOR_R {
         FOR_D {
             FOR_S {
                 int sum = 0;
                 FOR_C {
-                    sum += sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)];
+                    sum += timetable_crds[INDEX4(c, C, r, R, d, D, s, S)];
                 }
                 assert_real(sum == sol->sum_rds[INDEX3(r, R, d, D, s, S)]);
             }
@@ -933,10 +1316,19 @@ void solution_assert_consistency_real(const solution *sol) {
                     if (!model_course_belongs_to_curricula(sol->model, c, q))
                         continue;
                     FOR_R {
-                        sum += sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)];
+                        sum += timetable_crds[INDEX4(c, C, r, R, d, D, s, S)];
                     }
                 }
-                assert_real(sum == sol->sum_qds[INDEX3(q, Q, d, D, s, S)]);
+                assert_real(sum == SUM_QDS(sol, q, PERIOD(d, s)));
+
+                const int W = model->curriculas_bitset_words;
+                const int p = PERIOD(d, s);
+                bool busy = (sol->busy_pq[INDEX2(p, P, q / 64, W)] >> (q % 64)) & 1;
+                bool crowded = (sol->crowded_pq[INDEX2(p, P, q / 64, W)] >> (q % 64)) & 1;
+                assert_real(busy == (sum > 0));
+                assert_real(crowded == (sum > 1));
+                bool slot = (sol->slots_qd[INDEX2(q, Q, d, D)] >> s) & 1;
+                assert_real(slot == (sum > 0));
             }
         }
     };
@@ -951,10 +1343,10 @@ void solution_assert_consistency_real(const solution *sol) {
                         continue;
 
                     FOR_R {
-                        sum += sol->timetable_crds[INDEX4(c, C, r, R, d, D, s, S)];
+                        sum += timetable_crds[INDEX4(c, C, r, R, d, D, s, S)];
                     }
                 }
-                assert_real(sum == sol->sum_tds[INDEX3(t, T, d, D, s, S)]);
+                assert_real(sum == SUM_TDS(sol, t, PERIOD(d, s)));
             }
         }
     };
@@ -965,10 +1357,23 @@ void solution_assert_consistency_real(const solution *sol) {
         const int c = ll->course->index;
         const assignment *a = &sol->assignments[l];
         if (a->r >= 0 && a->d >= 0 && a->s >= 0) {
-            assert_real(sol->timetable_crds[INDEX4(c, C, a->r, R, a->d, D, a->s, S)]);
+            assert_real(timetable_crds[INDEX4(c, C, a->r, R, a->d, D, a->s, S)]);
             assert_real(sol->l_rds[INDEX3(a->r, R, a->d, D, a->s, S)] == l);
         }
     }
+
+    // costs
+    solution_costs costs;
+    solution_compute_cost_breakdown(sol, &costs);
+    assert_real(costs.room_capacity == sol->costs.room_capacity);
+    assert_real(costs.min_working_days == sol->costs.min_working_days);
+    assert_real(costs.curriculum_compactness == sol->costs.curriculum_compactness);
+    assert_real(costs.room_stability == sol->costs.room_stability);
+
+    // fingerprint
+    assert_real(solution_compute_fingerprint(sol) == sol->fingerprint);
+
+    free(timetable_crds);
 }
 
 void solution_assert(const solution *sol, bool expected_feasibility, int expected_cost) {
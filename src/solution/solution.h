@@ -3,6 +3,8 @@
 
 #include "model/model.h"
 #include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
 
 /**
 ------------------
@@ -60,22 +62,83 @@ typedef struct assignment {
     int r, d, s;
 } assignment;
 
+/*
+ * Hot counters (sum_cds, sum_qds, sum_tds), read by the hard constraints
+ * checks of each move, can be tuned at build time:
+ * SOLUTION_COUNTER_BITS    width of the counters: 8, 16 or 32 (int)
+ * SOLUTION_PERIOD_MAJOR    store them as [p,x] instead of [x,p], so that the
+ *                          counters of the same period are adjacent
+ * where p = d * S + s is the index of the period (day d, slot s).
+ */
+#ifndef SOLUTION_COUNTER_BITS
+#define SOLUTION_COUNTER_BITS 32
+#endif
+
+#if SOLUTION_COUNTER_BITS == 8
+typedef uint8_t solution_counter;
+#define SOLUTION_COUNTER_MAX UINT8_MAX
+#elif SOLUTION_COUNTER_BITS == 16
+typedef uint16_t solution_counter;
+#define SOLUTION_COUNTER_MAX UINT16_MAX
+#elif SOLUTION_COUNTER_BITS == 32
+typedef int solution_counter;
+#define SOLUTION_COUNTER_MAX INT_MAX
+#else
+#error "SOLUTION_COUNTER_BITS must be 8, 16 or 32"
+#endif
+
+// Require the model constants (MODEL macro) to be defined
+#define PERIOD(d, s) ((d) * S + (s))
+
+#ifdef SOLUTION_PERIOD_MAJOR
+#define COUNTER_INDEX(x, X, p) ((p) * (X) + (x))
+#else
+#define COUNTER_INDEX(x, X, p) ((x) * P + (p))
+#endif
+
+#define SUM_CDS(sol, c, p) ((sol)->sum_cds[COUNTER_INDEX(c, C, p)])
+#define SUM_QDS(sol, q, p) ((sol)->sum_qds[COUNTER_INDEX(q, Q, p)])
+#define SUM_TDS(sol, t, p) ((sol)->sum_tds[COUNTER_INDEX(t, T, p)])
+
+/*
+ * Costs of the soft constraints of a solution
+ * (already multiplied by the respective factor).
+ */
+typedef struct solution_costs {
+    int room_capacity;
+    int min_working_days;
+    int curriculum_compactness;
+    int room_stability;
+} solution_costs;
+
+/*
+ * Entry of the undo log: the value `value` held by `ptr`
+ * (an int, a solution_counter or a bitset word) before being overwritten
+ * within a transaction.
+ */
+typedef enum solution_undo_kind {
+    SOLUTION_UNDO_INT,
+    SOLUTION_UNDO_COUNTER,
+    SOLUTION_UNDO_WORD
+} solution_undo_kind;
+
+typedef struct solution_undo_entry {
+    void *ptr;
+    uint64_t value;
+    solution_undo_kind kind;
+} solution_undo_entry;
+
 /*
  * Solution entity.
- * For represent a solution, only a timetable (e.g. timetable_crds) could
+ * For represent a solution, only the assignments of the lectures could
  * be enough, but for provide a more efficient computation, redundant
  * data is store (which must remain consistent).
+ * Note that no dense timetable [c,r,d,s] is kept: its size grows as
+ * C*R*D*S and every query can be answered by the helpers below.
  */
 typedef struct solution {
     const model *model;
 
-    /*
-     * Timetables.
-     * e.g. timetable_crds[c,r,d,s] is true if:
-     *      course c is assigned to room r on day d, slot s
-     */
-    bool *timetable_crds;  // [c,r,d,s]
-
     /*
      * Course/Room/Lecture helpers.
      * e.g. c_rds[r,d,s] contains:
@@ -89,29 +152,120 @@ typedef struct solution {
 
     /*
      * Sum helpers.
-     * e.g. sum_cr[c,r] contains sum_d€D(sum_s€S(timetable_crds[c,r,d,s]))
-     *      sum_cds[c,d,s] contains sum_r€R(timetable_crds[c,r,d,s])
+     * e.g. sum_cr[c,r] contains the number of lectures of course c in room r
+     *      sum_cds[c,d,s] contains the number of lectures of course c on day d, slot s
+     * sum_cds, sum_qds and sum_tds must be accessed with SUM_CDS, SUM_QDS
+     * and SUM_TDS, since their layout depends on the build.
      */
     int *sum_cr;    // [c,r]
-    int *sum_cds;   // [c,d,s]
+    solution_counter *sum_cds;   // [c,p]
     int *sum_cd;    // [c,d]
     int *sum_rds;   // [r,d,s]
-    int *sum_qds;   // [q,d,s]
-    int *sum_tds;   // [t,d,s]
+    solution_counter *sum_qds;   // [q,p]
+    solution_counter *sum_tds;   // [t,p]
+
+    // Number of days with lectures and of rooms used by each course
+    int *working_days_c;    // [c]
+    int *used_rooms_c;      // [c]
+
+    /*
+     * Curriculas busy in each period, as bitsets of Q bits (laid out as
+     * model->curriculas_of_course_bitset, curriculas_bitset_words per period):
+     * busy_pq[p] has the bit q set if sum_qds[q,p] > 0,
+     * crowded_pq[p] has the bit q set if sum_qds[q,p] > 1;
+     * the curriculum conflicts of a move are checked against
+     * them with a few AND of words.
+     */
+    uint64_t *busy_pq;      // [p,w]
+    uint64_t *crowded_pq;   // [p,w]
+
+    /*
+     * Slots of each day in which the curricula has lectures, as a mask
+     * of S bits: slots_qd[q,d] has the bit s set if sum_qds[q,d,s] > 0
+     * (thus no more than 64 slots per day are supported).
+     */
+    uint64_t *slots_qd;     // [q,d]
 
     // Assignment array of the lectures
     assignment *assignments; // [l]
 
+    // Soft constraints costs, updated at each assignment/unassignment
+    solution_costs costs;
+
+    // Zobrist hash of the (course, room, day, slot) assignments
+    unsigned long long fingerprint;
+
+    /*
+     * All the arrays above are allocated within a single arena:
+     * first the ones cleared to -1 (_arena_unassigned_size bytes),
+     * then the ones cleared to 0.
+     */
+    void *_arena;
+    size_t _arena_size;
+    size_t _arena_unassigned_size;
+
+    /*
+     * Undo log of the current transaction (see solution_begin):
+     * every write to the arrays above is recorded while _transaction is true.
+     */
+    bool _transaction;
+    solution_undo_entry *_undo_log;
+    int _undo_log_len;
+    int _undo_log_capacity;
+    solution_costs _undo_costs;
+    unsigned long long _undo_fingerprint;
+
     int _id;
 } solution;
 
 
+/*
+ * Compact copy of a solution: only the assignments of the lectures are
+ * stored, the redundant data is rebuilt by `solution_restore_snapshot`.
+ */
+typedef struct solution_snapshot {
+    const model *model;
+    assignment *assignments; // [l]
+} solution_snapshot;
+
+
+/*
+ * Pool of solutions of the same model: scratch solutions
+ * can be acquired and released without allocating new arenas.
+ * The content of an acquired solution is unspecified.
+ */
+typedef struct solution_pool {
+    const model *model;
+    GArray *solutions; // solution *
+} solution_pool;
+
+
 void solution_init(solution *solution, const model *model);
 void solution_clear(solution *solution);
 void solution_destroy(solution *solution);
 
+void solution_pool_init(solution_pool *pool, const model *model);
+void solution_pool_destroy(solution_pool *pool);
+solution *solution_pool_acquire(solution_pool *pool);
+void solution_pool_release(solution_pool *pool, solution *sol);
+
 void solution_copy(solution *solution_dest, const solution *solution_src);
 
+void solution_snapshot_init(solution_snapshot *snapshot, const model *model);
+void solution_snapshot_destroy(solution_snapshot *snapshot);
+void solution_take_snapshot(solution_snapshot *snapshot, const solution *sol);
+void solution_restore_snapshot(solution *sol, const solution_snapshot *snapshot);
+
+/*
+ * Transactions: after solution_begin every change to the solution is
+ * recorded, and can be either kept (solution_commit) or reverted in bulk
+ * (solution_rollback), without recomputing anything.
+ * Transactions can't be nested.
+ */
+void solution_begin(solution *sol);
+void solution_commit(solution *sol);
+void solution_rollback(solution *sol);
+
 void solution_assign_lecture(solution *sol, int l1, int r2, int d2, int s2);
 void solution_unassign_lecture(solution *sol, int l);
 void solution_get_lecture_assignment(const solution *sol, int l, int *r, int *d, int *s);
@@ -133,15 +287,20 @@ int solution_room_occupancy_violations(const solution *sol);
 int solution_conflicts_violations(const solution *sol);
 int solution_availabilities_violations(const solution *sol);
 
-// Soft constraints
+// Soft constraints (O(1): these return the costs kept up to date by the solution)
 int solution_cost(const solution *sol);
+void solution_cost_breakdown(const solution *sol, solution_costs *costs);
 int solution_room_capacity_cost(const solution *sol);
 int solution_min_working_days_cost(const solution *sol);
 int solution_curriculum_compactness_cost(const solution *sol);
 int solution_room_stability_cost(const solution *sol);
 
+/* Compute the soft constraints costs from scratch (i.e. not incrementally) */
+void solution_compute_cost_breakdown(const solution *sol, solution_costs *costs);
+
 // Debug purpose
 unsigned long long solution_fingerprint(const solution *sol);
+unsigned long long solution_compute_fingerprint(const solution *sol);
 
 void solution_assert_consistency(const solution *sol);
 void solution_assert_consistency_real(const solution *sol);
@@ -58,7 +58,7 @@ typedef struct solution_parser_line_handler_arg {
 /*
  * `fileparse` callback: real parsing logic.
  */
-static char * solution_parser_line_handler(const char *line, void *arg) {
+static char * solution_parser_line_handler(char *line, void *arg) {
     solution_parser_line_handler_arg *s_arg = (solution_parser_line_handler_arg *) arg;
     solution_parser *parser = s_arg->parser;
     solution_parser_state *state = (solution_parser_state *) parser->_state;
@@ -68,9 +68,8 @@ static char * solution_parser_line_handler(const char *line, void *arg) {
 
     char *fields[4];
     char *error = NULL;
-    char *line_copy = strdup(line);
 
-    if (strsplit(line_copy, " ", fields, 4) != 4) {
+    if (strsplit(line, " ", fields, 4) != 4) {
         error = strmake("unexpected fields count: expected 4");
         goto QUIT;
     }
@@ -109,8 +108,6 @@ static char * solution_parser_line_handler(const char *line, void *arg) {
     solution_assign_lecture(sol, l, r, d, s);
 
 QUIT:
-    free(line_copy);
-
     return error;
 }
 
@@ -11,6 +11,7 @@ void timeout_handler(int sig) {
 
 void set_timeout(unsigned int seconds) {
     verbose("Timeout: %u seconds", seconds);
+    timeout = 0;
     signal(SIGALRM, timeout_handler);
     alarm(seconds);
 }
@@ -2,6 +2,11 @@
 #include <errno.h>
 #include <string.h>
 #include <stdlib.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "log/verbose.h"
 #include "log/debug.h"
 #include "mem_utils.h"
@@ -50,6 +55,11 @@ int fileclear(const char *filename) {
 /*
  * Returns NULL on success, or a malloc-ed error string on failure.
  * `callback` is responsible for the parsing of the lines.
+ *
+ * The file is mapped in memory privately (or read at once, if it can't be
+ * mapped) and split into lines in place: each line is trimmed and
+ * NUL-terminated within the buffer itself, therefore there is neither
+ * a limit on the length of the lines nor any copy or allocation per line.
  */
 char * fileparse(const char *filename,
                  fileparse_options *parse_options,
@@ -59,30 +69,103 @@ char * fileparse(const char *filename,
     char error_reason[MAX_ERROR_LENGTH];
     error_reason[0] = '\0';
 
-    static const int MAX_LINE_LENGTH = 256;
-    char raw_line[MAX_LINE_LENGTH];
-    char *line;
+    char *error = NULL;
+    char *line = NULL;
+    size_t line_length = 0;
     int line_num = 0;
 
+    char *data = NULL;
+    size_t size = 0;
+    bool mapped = false;
+    char *last_line = NULL;
+
     verbose("Opening file: '%s'", filename);
-    FILE *file = fopen(filename, "r");
-    if (!file) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
         snprintf(error_reason, MAX_ERROR_LENGTH,
                  "failed to open '%s' (%s)", filename, strerror(errno));
         goto QUIT;
     }
 
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        size = st.st_size;
+        data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        mapped = data != MAP_FAILED;
+        if (mapped)
+            madvise(data, size, MADV_SEQUENTIAL);
+        else
+            data = NULL;
+    }
+
+    if (!mapped) {
+        // Fallback (e.g. pipes, which have no size and can't be mapped):
+        // read everything, leaving room for the terminator of the last line
+        size_t capacity = 4096;
+        size = 0;
+        data = mallocx(capacity, sizeof(char));
+        ssize_t n;
+        while ((n = read(fd, data + size, capacity - 1 - size)) != 0) {
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                snprintf(error_reason, MAX_ERROR_LENGTH,
+                         "failed to read '%s' (%s)", filename, strerror(errno));
+                close(fd);
+                goto QUIT;
+            }
+            size += n;
+            if (size == capacity - 1) {
+                capacity *= 2;
+                data = reallocx(data, capacity, sizeof(char));
+            }
+        }
+    }
+    close(fd);
+
     bool continue_parsing = true;
     char comment_prefix = '\0';
     if (parse_options)
         comment_prefix = parse_options->comment_prefix;
 
-    while (continue_parsing && fgets(raw_line, LENGTH(raw_line), file)) {
+    // Avoid a call per line if the lines wouldn't be printed anyway
+    const bool verbose_lines = get_verbosity() >= 2;
+
+    char *cursor = data;
+    char *data_end = data + size;
+
+    while (continue_parsing && cursor < data_end) {
+        char *line_end = memchr(cursor, '\n', data_end - cursor);
+        line = cursor;
+
+        if (line_end) {
+            cursor = line_end + 1;
+        } else {
+            // Last line without a trailing newline: a mapping has
+            // no room for the terminator, copy it aside
+            if (mapped) {
+                last_line = strndup(line, data_end - line);
+                line = last_line;
+                line_end = last_line + (data_end - cursor);
+            } else {
+                line_end = data_end;
+            }
+            cursor = data_end;
+        }
+
         line_num++;
-        line = strtrim(raw_line);
-        verbose2("<< %s", line);
 
-        if (strempty(line) || strstarts(line, comment_prefix))
+        while (line < line_end && isspace(*line))
+            line++;
+        while (line_end > line && isspace(line_end[-1]))
+            line_end--;
+        *line_end = '\0';
+        line_length = line_end - line;
+
+        if (verbose_lines)
+            verbose2("<< %s", line);
+
+        if (line == line_end || (comment_prefix && *line == comment_prefix))
             continue;
 
         char *err = callback(line, callback_arg);
@@ -90,12 +173,15 @@ char * fileparse(const char *filename,
             continue_parsing = false;
             snprintf(error_reason, MAX_ERROR_LENGTH, "%s", err);
             free(err);
+            // The callback might have split the line in place:
+            // rejoin its fields for reporting it whole
+            for (size_t i = 0; i < line_length; i++)
+                if (line[i] == '\0')
+                    line[i] = ' ';
         }
     }
 
     verbose("Closing file: '%s'", filename);
-    if (fclose(file) != 0)
-        verbose("WARN: failed to close '%s' (%s)", filename, strerror(errno));
 
 QUIT:
     if (!strempty(error_reason)) {
@@ -103,8 +189,16 @@ QUIT:
                 "Error reason: %s\n"
                 "Line number: %d\n"
                 "Line: %s", error_reason, line_num, line);
-        return strmake("parse error at line %d (%s)", line_num, error_reason);
+        error = line ?
+                strmake("parse error at line %d (%s): '%s'", line_num, error_reason, line) :
+                strmake("parse error at line %d (%s)", line_num, error_reason);
     }
 
-    return NULL; // success
+    if (mapped)
+        munmap(data, size);
+    else
+        free(data);
+    free(last_line);
+
+    return error; // NULL on success
 }
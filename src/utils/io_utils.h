@@ -13,9 +13,12 @@ int fileappend(const char *filename, const char *data);
 int fileclear(const char *filename);
 
 /* Callback passed to `fileparse`.
+ * The line (trimmed, never empty) belongs to the buffer of fileparse and
+ * can be modified in place (e.g. tokenized), but it is valid only
+ * within the callback.
  * Should return NULL on success, or a malloc-ed string on error. */
 typedef char * (*parse_line_callback)(
-        const char *    /* in: line */,
+        char *          /* in: line */,
         void *          /* in: arg */);
 
 typedef struct fileparse_options {
@@ -11,6 +11,24 @@ void *mallocx(size_t nmemb, size_t size) {
     return ptr;
 }
 
+void *reallocx(void *ptr, size_t nmemb, size_t size) {
+    ptr = realloc(ptr, nmemb * size);
+    if (!ptr) {
+        eprint("ERROR: realloc failed (out of memory)");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+void *aligned_mallocx(size_t alignment, size_t size) {
+    void *ptr;
+    if (posix_memalign(&ptr, alignment, size) != 0) {
+        eprint("ERROR: posix_memalign failed (out of memory)");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
 void *callocx(size_t nmemb, size_t size) {
     void *ptr = calloc(nmemb, size);
     if (!ptr) {
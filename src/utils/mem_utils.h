@@ -13,5 +13,7 @@
 
 void *mallocx(size_t nmemb, size_t size);
 void *callocx(size_t nmemb, size_t size);
+void *reallocx(void *ptr, size_t nmemb, size_t size);
+void *aligned_mallocx(size_t alignment, size_t size);
 
 #endif // MEM_UTILS_H
\ No newline at end of file
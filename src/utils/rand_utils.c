@@ -3,12 +3,27 @@
 #include <math.h>
 #include <stdbool.h>
 #include <string.h>
-
-static unsigned int the_seed;
+#include <stdint.h>
+#include <limits.h>
+
+/*
+ * The state of the generator is per thread, so that threads seeded
+ * with the same seeds produce the same sequences regardless of the
+ * scheduling; a thread that does not set the seed starts with seed 1
+ * (as random() does).
+ * The state has the size of the one of random(): in a single thread,
+ * the sequences are the ones of srandom()/random().
+ */
+static __thread unsigned int the_seed;
+static __thread struct random_data the_data;
+static __thread char the_state[128];
+static __thread bool the_state_initialized = false;
 
 void rand_set_seed(unsigned int seed) {
     the_seed = seed;
-    srandom(seed);
+    memset(&the_data, 0, sizeof(the_data));
+    initstate_r(seed, the_state, sizeof(the_state), &the_data);
+    the_state_initialized = true;
 }
 
 unsigned int rand_get_seed() {
@@ -16,11 +31,23 @@ unsigned int rand_get_seed() {
 }
 
 int rand_int() {
-    return (int) random();
+    if (!the_state_initialized)
+        rand_set_seed(1);
+    int32_t r;
+    random_r(&the_data, &r);
+    return (int) r;
 }
 
 int rand_range(int start, int end) {
-    return start + ((int) random() % (end - start));
+    return start + (rand_int() % (end - start));
+}
+
+int64_t rand_range64(int64_t start, int64_t end) {
+    if (end - start <= INT_MAX)
+        return start + rand_range(0, (int) (end - start));
+    // 62 random bits
+    const uint64_t r = ((uint64_t) rand_int() << 31) | (uint64_t) rand_int();
+    return start + (int64_t) (r % (uint64_t) (end - start));
 }
 
 double rand_uniform(double a, double b) {
@@ -35,8 +62,8 @@ double rand_normal(double mean, double std) {
     // z0 = u * sqrt(-2 * ln(s) / s)
     // z1 = v * sqrt(-2 * ln(s) / s)
     // G = mean + z0 * std      // mean + z1 * std
-    static bool z1_usable = false;
-    static double z1;
+    static __thread bool z1_usable = false;
+    static __thread double z1;
 
     if (z1_usable) {
         z1_usable = false;
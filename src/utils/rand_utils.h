@@ -2,6 +2,7 @@
 #define RAND_UTILS_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 void rand_set_seed(unsigned int seed);
 unsigned int rand_get_seed();
@@ -12,6 +13,10 @@ int rand_int();
 /* Random int between start (inclusive) and end (exclusive) */
 int rand_range(int start, int end);
 
+/* As rand_range, for ranges wider than INT_MAX too
+ * (the same number of rand_range, for the narrower ones) */
+int64_t rand_range64(int64_t start, int64_t end);
+
 /* Random double between a and b */
 double rand_uniform(double a, double b);
 
@@ -1,18 +1,28 @@
 #include <glib.h>
 #include <stdio.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <limits.h>
 #include <utils/io_utils.h>
 #include <heuristics/neighbourhoods/swap.h>
 #include "renderer/renderer.h"
 #include "heuristics/neighbourhoods/swap.h"
+#include "heuristics/neighbourhoods/swap_scan.h"
+#include "heuristics/neighbourhoods/swap_sampler.h"
 #include "utils/array_utils.h"
 #include "utils/str_utils.h"
+#include "utils/mem_utils.h"
 #include "utils/os_utils.h"
 #include "utils/rand_utils.h"
 #include "model/model_parser.h"
+#include "model/model_cache.h"
+#include "generator/generator.h"
 #include "solution/solution_parser.h"
 #include "solution/solution.h"
 #include "log/verbose.h"
 #include "finder/feasible_solution_finder.h"
+#include "decomposition/decomposition.h"
+#include "heuristics/methods/local_search.h"
 
 #define VERBOSITY 2
 
@@ -253,6 +263,107 @@ GLIB_TEST(test_pathjoin) {
 }
 
 
+typedef struct test_fileparse_lines {
+    char *lines[8];
+    int n_lines;
+} test_fileparse_lines;
+
+static char *test_fileparse_callback(char *line, void *arg) {
+    test_fileparse_lines *lines = arg;
+    g_assert_cmpint(lines->n_lines, <, LENGTH(lines->lines));
+    lines->lines[lines->n_lines++] = strdup(line);
+    return NULL;
+}
+
+static char *test_fileparse_split_callback(char *line, void *arg) {
+    char *fields[4];
+    if (strsplit(line, " ", fields, 4) != 4)
+        return strmake("expected 4 fields");
+    return NULL;
+}
+
+GLIB_TEST(test_fileparse) {
+    const char *filename = "/tmp/itc2007-cct-test-fileparse.txt";
+
+    // A line far longer than any fixed size buffer
+    const int LONG_LINE_LENGTH = 100000;
+    char *long_line = mallocx(LONG_LINE_LENGTH + 1, sizeof(char));
+    for (int i = 0; i < LONG_LINE_LENGTH; i++)
+        long_line[i] = i % 2 ? ' ' : 'x';
+    long_line[LONG_LINE_LENGTH - 1] = 'y';
+    long_line[LONG_LINE_LENGTH] = '\0';
+
+    g_assert_true(filewrite(filename, false, "  first line \r\n"));
+    g_assert_true(fileappend(filename, "# comment\n\n   \n"));
+    g_assert_true(fileappend(filename, long_line));
+    g_assert_true(fileappend(filename, "\n\tlast line without newline"));
+
+    test_fileparse_lines lines = { .n_lines = 0 };
+    fileparse_options options = { .comment_prefix = '#' };
+    char *error = fileparse(filename, &options, test_fileparse_callback, &lines);
+    g_assert_null(error);
+
+    g_assert_cmpint(lines.n_lines, ==, 3);
+    g_assert_eqstr(lines.lines[0], "first line");
+    g_assert_cmpint(strlen(lines.lines[1]), ==, LONG_LINE_LENGTH);
+    g_assert_cmpint(lines.lines[1][LONG_LINE_LENGTH - 1], ==, 'y');
+    g_assert_eqstr(lines.lines[2], "last line without newline");
+
+    for (int i = 0; i < lines.n_lines; i++)
+        free(lines.lines[i]);
+
+    // A pipe (no size, can't be mapped): same lines, read in several chunks
+    int fds[2];
+    g_assert_cmpint(pipe(fds), ==, 0);
+    pid_t pid = fork();
+    g_assert_cmpint(pid, >=, 0);
+    if (pid == 0) {
+        close(fds[0]);
+        char *content = fileread(filename);
+        size_t length = strlen(content);
+        for (size_t written = 0; written < length;) {
+            ssize_t n = write(fds[1], content + written, length - written);
+            if (n <= 0)
+                _exit(1);
+            written += n;
+        }
+        _exit(0);
+    }
+    close(fds[1]);
+
+    char pipe_filename[64];
+    snprintf(pipe_filename, sizeof(pipe_filename), "/dev/fd/%d", fds[0]);
+    lines.n_lines = 0;
+    error = fileparse(pipe_filename, &options, test_fileparse_callback, &lines);
+    g_assert_null(error);
+    close(fds[0]);
+    int status;
+    g_assert_cmpint(waitpid(pid, &status, 0), ==, pid);
+
+    g_assert_cmpint(lines.n_lines, ==, 3);
+    g_assert_eqstr(lines.lines[0], "first line");
+    g_assert_cmpint(strlen(lines.lines[1]), ==, LONG_LINE_LENGTH);
+    g_assert_cmpint(lines.lines[1][LONG_LINE_LENGTH - 1], ==, 'y');
+    g_assert_eqstr(lines.lines[2], "last line without newline");
+
+    for (int i = 0; i < lines.n_lines; i++)
+        free(lines.lines[i]);
+    free(long_line);
+    remove(filename);
+
+    error = fileparse(filename, NULL, test_fileparse_callback, &lines);
+    g_assert_nonnull(error);
+    free(error);
+
+    // A line split in place by the callback is reported whole
+    g_assert_true(filewrite(filename, false, "a b c d\na b c\n"));
+    error = fileparse(filename, NULL, test_fileparse_split_callback, NULL);
+    g_assert_nonnull(error);
+    g_assert_eqstr(error, "parse error at line 2 (expected 4 fields): 'a b c'");
+    free(error);
+    remove(filename);
+}
+
 GLIB_TEST(test_mkdirs) {
     if (!isdir("/tmp/dir")) {
         g_assert_true(mkdirs("/tmp/dir"));
@@ -292,6 +403,308 @@ GLIB_TEST_ARG(test_parser) {
     model_destroy(&m);
 }
 
+GLIB_TEST_ARG(test_model_relations) {
+    const char * dataset = arg;
+
+    model m;
+    model_init(&m);
+    g_assert_true(parse_model(&m, dataset));
+    MODEL(&m);
+
+    // curriculas_of_course agrees with course_belongs_to_curricula
+    FOR_C {
+        int n_curriculas;
+        int *curriculas = model_curriculas_of_course(model, c, &n_curriculas);
+        int expected = 0;
+        FOR_Q {
+            expected += model_course_belongs_to_curricula(model, c, q);
+        }
+        g_assert_cmpint(n_curriculas, ==, expected);
+        for (int i = 0; i < n_curriculas; i++)
+            g_assert_true(model_course_belongs_to_curricula(model, c, curriculas[i]));
+    }
+
+    // courses_of_curricula agrees with course_belongs_to_curricula
+    FOR_Q {
+        int n_courses;
+        int *courses = model_courses_of_curricula(model, q, &n_courses);
+        g_assert_cmpint(n_courses, ==, model->curriculas[q].n_courses);
+        for (int i = 0; i < n_courses; i++)
+            g_assert_true(model_course_belongs_to_curricula(model, courses[i], q));
+    }
+
+    // courses_of_teacher agrees with teacher_of_course
+    int n_teachers_courses = 0;
+    FOR_T {
+        int n_courses;
+        int *courses = model_courses_of_teacher(model, t, &n_courses);
+        for (int i = 0; i < n_courses; i++) {
+            g_assert_cmpint(model->teacher_of_course[courses[i]], ==, t);
+            g_assert_true(model_course_is_taught_by_teacher(model, courses[i], t));
+        }
+        n_teachers_courses += n_courses;
+    }
+    g_assert_cmpint(n_teachers_courses, ==, C);
+
+    // flat arrays agree with the entities
+    FOR_L {
+        g_assert_cmpint(model->course_of_lecture[l], ==, model->lectures[l].course->index);
+    }
+    FOR_C {
+        g_assert_cmpint(model->teacher_of_course[c], ==, model->courses[c].teacher->index);
+        g_assert_cmpint(model->students_of_course[c], ==, model->courses[c].n_students);
+    }
+    FOR_R {
+        g_assert_cmpint(model->capacity_of_room[r], ==, model->rooms[r].capacity);
+    }
+    FOR_C {
+        FOR_R {
+            g_assert_cmpint(model->room_capacity_penalty[INDEX2(c, C, r, R)], ==,
+                            MAX(0, model->courses[c].n_students - model->rooms[r].capacity));
+        }
+    }
+
+    model_destroy(&m);
+}
+
+GLIB_TEST_ARG(test_model_cache) {
+    const char * dataset = arg;
+    const char * filename = "/tmp/itc2007-cct-test-model-cache.ctt";
+    const char * cache_filename = "/tmp/itc2007-cct-test-model-cache.cttb";
+
+    char *content = fileread(dataset);
+    g_assert_nonnull(content);
+    g_assert_true(filewrite(filename, false, content));
+    free(content);
+
+    model m1;
+    model_init(&m1);
+    g_assert_true(parse_model(&m1, filename));
+    g_assert_true(model_cache_write(&m1, filename, cache_filename));
+
+    model m2, m3;
+    model_init(&m2);
+    g_assert_true(model_cache_load(&m2, filename, cache_filename));
+    MODEL(&m1);
+
+    // Same entities
+    g_assert_eqstr(m1.name, m2.name);
+    g_assert_cmpint(m2.n_courses, ==, C);
+    g_assert_cmpint(m2.n_rooms, ==, R);
+    g_assert_cmpint(m2.n_days, ==, D);
+    g_assert_cmpint(m2.n_slots, ==, S);
+    g_assert_cmpint(m2.n_curriculas, ==, Q);
+    g_assert_cmpint(m2.n_teachers, ==, T);
+    g_assert_cmpint(m2.n_lectures, ==, L);
+    g_assert_cmpint(m2.n_unavailability_constraints, ==, m1.n_unavailability_constraints);
+
+    FOR_C {
+        g_assert_eqstr(m1.courses[c].id, m2.courses[c].id);
+        g_assert_eqstr(m1.courses[c].teacher_id, m2.courses[c].teacher->id);
+        g_assert_cmpint(m1.courses[c].n_lectures, ==, m2.courses[c].n_lectures);
+        g_assert_true(model_course_by_id(&m2, m1.courses[c].id) == &m2.courses[c]);
+    }
+    FOR_R {
+        g_assert_true(model_room_by_id(&m2, m1.rooms[r].id) == &m2.rooms[r]);
+    }
+    FOR_Q {
+        g_assert_true(model_curricula_by_id(&m2, m1.curriculas[q].id) == &m2.curriculas[q]);
+        for (int i = 0; i < m1.curriculas[q].n_courses; i++)
+            g_assert_eqstr(m1.curriculas[q].courses_ids[i], m2.curriculas[q].courses_ids[i]);
+    }
+    for (int u = 0; u < m1.n_unavailability_constraints; u++)
+        g_assert_true(m2.unavailability_constraints[u].course ==
+                      &m2.courses[m1.unavailability_constraints[u].course->index]);
+    FOR_L {
+        g_assert_true(m2.lectures[l].course == &m2.courses[m1.lectures[l].course->index]);
+    }
+
+    // Same redundant data
+    g_assert_true(memcmp(m1.course_of_lecture, m2.course_of_lecture, L * sizeof(int)) == 0);
+    g_assert_true(memcmp(m1.teacher_of_course, m2.teacher_of_course, C * sizeof(int)) == 0);
+    g_assert_true(memcmp(m1.curriculas_of_course_offsets, m2.curriculas_of_course_offsets,
+                         (C + 1) * sizeof(int)) == 0);
+    g_assert_true(memcmp(m1.curriculas_of_course, m2.curriculas_of_course,
+                         m1.curriculas_of_course_offsets[C] * sizeof(int)) == 0);
+    g_assert_true(memcmp(m1.courses_of_curricula, m2.courses_of_curricula,
+                         m1.courses_of_curricula_offsets[Q] * sizeof(int)) == 0);
+    g_assert_true(memcmp(m1.courses_of_teacher, m2.courses_of_teacher, C * sizeof(int)) == 0);
+    g_assert_true(memcmp(m1.course_availabilities, m2.course_availabilities,
+                         C * D * S * sizeof(bool)) == 0);
+    g_assert_cmpint(m1.n_room_classes, ==, m2.n_room_classes);
+    g_assert_cmpint(m1.n_course_classes, ==, m2.n_course_classes);
+    g_assert_true(memcmp(m1.room_class, m2.room_class, R * sizeof(int)) == 0);
+    g_assert_true(memcmp(m1.room_class_prev, m2.room_class_prev, R * sizeof(int)) == 0);
+    g_assert_true(memcmp(m1.course_class, m2.course_class, C * sizeof(int)) == 0);
+    g_assert_true(memcmp(m1.room_capacity_penalty, m2.room_capacity_penalty, C * R * sizeof(int)) == 0);
+    FOR_C {
+        FOR_Q {
+            g_assert_cmpint(model_course_belongs_to_curricula(&m1, c, q), ==,
+                            model_course_belongs_to_curricula(&m2, c, q));
+        }
+    }
+
+    model_destroy(&m2);
+    model_destroy(&m1);
+
+    // The cache becomes stale as soon as the instance changes
+    g_assert_true(fileappend(filename, "\n"));
+    model_init(&m3);
+    g_assert_false(model_cache_load(&m3, filename, cache_filename));
+    model_destroy(&m3);
+
+    remove(filename);
+    remove(cache_filename);
+}
+
+GLIB_TEST_ARG(test_generator) {
+    const generator_config *config = arg;
+    const char * filename = "/tmp/itc2007-cct-test-generator.ctt";
+    const char * solution_filename = "/tmp/itc2007-cct-test-generator.ctt.sol";
+
+    g_assert_true(generate_instance(config, filename, solution_filename));
+
+    // Same seed, same instance
+    char *content1 = fileread(filename);
+    g_assert_true(generate_instance(config, filename, NULL));
+    char *content2 = fileread(filename);
+    g_assert_nonnull(content1);
+    g_assert_eqstr(content1, content2);
+    free(content1);
+    free(content2);
+
+    model m;
+    model_init(&m);
+    g_assert_true(parse_model(&m, filename));
+    MODEL(&m);
+
+    g_assert_cmpint(C, ==, config->n_courses);
+    g_assert_cmpint(D, ==, config->n_days);
+    g_assert_cmpint(S, ==, config->n_slots);
+    if (config->n_rooms)
+        g_assert_cmpint(R, ==, config->n_rooms);
+    FOR_C {
+        g_assert_cmpint(model->courses[c].n_lectures, >=, config->min_lectures);
+        g_assert_cmpint(model->courses[c].n_lectures, <=, config->max_lectures);
+    }
+
+    // Feasible by construction
+    solution sol;
+    solution_init(&sol, &m);
+    g_assert_true(parse_solution(&sol, solution_filename));
+    g_assert_true(solution_satisfy_hard_constraints(&sol));
+
+    solution_destroy(&sol);
+    model_destroy(&m);
+
+    remove(filename);
+    remove(solution_filename);
+}
+
+typedef struct test_decomposition_params {
+    generator_config generator;
+    const char *model_file;     // instead of the generated one, if not NULL
+    int threads;
+    bool decomposable;
+} test_decomposition_params;
+
+GLIB_TEST_ARG(test_decomposition) {
+    const test_decomposition_params *params = arg;
+    const char * filename = "/tmp/itc2007-cct-test-decomposition.ctt";
+
+    if (!params->model_file)
+        g_assert_true(generate_instance(&params->generator, filename, NULL));
+
+    model m;
+    model_init(&m);
+    g_assert_true(parse_model(&m, params->model_file ? params->model_file : filename));
+    MODEL(&m);
+
+    // Courses sharing curriculas or teachers are in the same component
+    int *component_of_course = mallocx(C, sizeof(int));
+    int K = model_course_components(&m, component_of_course);
+    g_assert_cmpint(K, >=, 1);
+    FOR_Q {
+        int n_courses;
+        const int *courses = model_courses_of_curricula(&m, q, &n_courses);
+        for (int i = 1; i < n_courses; i++)
+            g_assert_cmpint(component_of_course[courses[i]], ==, component_of_course[courses[0]]);
+    }
+    FOR_T {
+        int n_courses;
+        const int *courses = model_courses_of_teacher(&m, t, &n_courses);
+        for (int i = 1; i < n_courses; i++)
+            g_assert_cmpint(component_of_course[courses[i]], ==, component_of_course[courses[0]]);
+    }
+    free(component_of_course);
+
+    decomposition dec;
+    bool decomposed = decomposition_init(&dec, &m, params->threads);
+    g_assert_cmpint(decomposed, ==, params->decomposable);
+
+    if (decomposed) {
+        // The parts cover the model: each course, room and lecture once
+        int n_courses = 0, n_lectures = 0;
+        int *room_count = callocx(R, sizeof(int));
+        for (int p = 0; p < dec.n_parts; p++) {
+            const decomposition_part *part = &dec.parts[p];
+            n_courses += part->model.n_courses;
+            n_lectures += part->model.n_lectures;
+            for (int r = 0; r < part->model.n_rooms; r++) {
+                room_count[part->rooms[r]]++;
+                g_assert_cmpint(part->model.rooms[r].capacity, ==,
+                                model->rooms[part->rooms[r]].capacity);
+            }
+            for (int l = 0; l < part->model.n_lectures; l++) {
+                int pc = part->model.course_of_lecture[l];
+                g_assert_cmpint(model->course_of_lecture[part->lectures[l]], ==, part->courses[pc]);
+                g_assert_cmpstr(part->model.courses[pc].id, ==,
+                                model->courses[part->courses[pc]].id);
+            }
+        }
+        g_assert_cmpint(n_courses, ==, C);
+        g_assert_cmpint(n_lectures, ==, L);
+        FOR_R {
+            g_assert_cmpint(room_count[r], ==, 1);
+        }
+        free(room_count);
+        decomposition_destroy(&dec);
+    }
+
+    // Solve, either decomposed or as a whole
+    local_search_params ls;
+    local_search_params_default(&ls);
+    feasible_solution_finder_config finder_conf;
+    feasible_solution_finder_config_default(&finder_conf);
+
+    heuristic_solver_config solver_conf;
+    heuristic_solver_config_init(&solver_conf);
+    heuristic_solver_config_add_method(&solver_conf, local_search, &ls, "Local Search", "LS");
+    solver_conf.max_time = 10;
+    solver_conf.max_cycles = 2;
+    solver_conf.decomposition = true;
+    solver_conf.threads = params->threads;
+
+    heuristic_solver solver;
+    heuristic_solver_init(&solver);
+    heuristic_solver_stats stats;
+    heuristic_solver_stats_init(&stats);
+
+    solution sol;
+    solution_init(&sol, &m);
+    g_assert_true(heuristic_solver_solve(&solver, &solver_conf, &finder_conf, &sol, &stats));
+    g_assert_true(solution_satisfy_hard_constraints(&sol));
+    solution_assert_consistency_real(&sol);
+
+    solution_destroy(&sol);
+    heuristic_solver_stats_destroy(&stats);
+    heuristic_solver_destroy(&solver);
+    heuristic_solver_config_destroy(&solver_conf);
+    model_destroy(&m);
+
+    remove(filename);
+}
+
 GLIB_TEST_ARG(test_solution_parser) {
     const char * model_file = ((const char **) arg)[0];
     const char * solution_file = ((const char **) arg)[1];
@@ -340,6 +753,13 @@ GLIB_TEST_ARG(test_solution_cost) {
     g_assert_cmpint(params->s3, ==, solution_curriculum_compactness_cost(&s));
     g_assert_cmpint(params->s4, ==, solution_room_stability_cost(&s));
 
+    solution_costs costs;
+    solution_compute_cost_breakdown(&s, &costs);
+    g_assert_cmpint(params->s1, ==, costs.room_capacity);
+    g_assert_cmpint(params->s2, ==, costs.min_working_days);
+    g_assert_cmpint(params->s3, ==, costs.curriculum_compactness);
+    g_assert_cmpint(params->s4, ==, costs.room_stability);
+
     model_destroy(&m);
     solution_destroy(&s);
 }
@@ -409,15 +829,577 @@ GLIB_TEST_ARG(test_swap_iter_next) {
     swap_iter_init(&iter, &s);
 
     while (swap_iter_next(&iter)) {
-        g_assert_true(s.timetable_crds[INDEX4(
-                iter.move.helper.c1, C, iter.move.helper.r1, R,
-                iter.move.helper.d1, D, iter.move.helper.s1, S)]);
+        g_assert_cmpint(s.c_rds[INDEX3(
+                iter.move.helper.r1, R,
+                iter.move.helper.d1, D, iter.move.helper.s1, S)], ==, iter.move.helper.c1);
         g_assert_true(swap_move_is_effective(&iter.move));
     }
 
     EPILOGUE();
 }
 
+GLIB_TEST_ARG(test_swap_symmetry) {
+    const char *model_file = (const char *) arg;
+    PROLOGUE(model_file);
+
+    for (int round = 0; round < 3; round++) {
+        int n_enumerated = 0;
+
+        for (int l = 0; l < L; l++) {
+            for (int r = 0; r < R; r++) {
+                for (int d = 0; d < D; d++) {
+                    for (int sl = 0; sl < S; sl++) {
+                        swap_move mv = {.l1 = l, .r2 = r, .d2 = d, .s2 = sl};
+                        swap_move_compute_helper(&s, &mv);
+                        if (mv.helper.c1 <= mv.helper.c2)
+                            continue;
+                        if (!swap_move_is_symmetric(&s, &mv)) {
+                            n_enumerated++;
+                            continue;
+                        }
+
+                        swap_result result;
+                        swap_predict(&s, &mv,
+                                     NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
+                                     NEIGHBOURHOOD_PREDICT_COST_ALWAYS,
+                                     &result);
+
+                        if (mv.helper.c2 >= 0) {
+                            // Swap of interchangeable courses: nothing changes
+                            g_assert_true(result.feasible);
+                            g_assert_cmpint(result.delta.cost, ==, 0);
+                            continue;
+                        }
+
+                        // Same outcome of the move to the first equivalent room
+                        swap_move equivalent = mv;
+                        for (int r2 = model->room_class_prev[r]; r2 >= 0; r2 = model->room_class_prev[r2])
+                            if (s.l_rds[INDEX3(r2, R, d, D, sl, S)] < 0 && !s.sum_cr[INDEX2(mv.helper.c1, C, r2, R)])
+                                equivalent.r2 = r2;
+                        g_assert_cmpint(equivalent.r2, <, r);
+                        swap_move_compute_helper(&s, &equivalent);
+                        g_assert_false(swap_move_is_symmetric(&s, &equivalent));
+
+                        swap_result equivalent_result;
+                        swap_predict(&s, &equivalent,
+                                     NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
+                                     NEIGHBOURHOOD_PREDICT_COST_ALWAYS,
+                                     &equivalent_result);
+                        g_assert_cmpbool(result.feasible, ==, equivalent_result.feasible);
+                        g_assert_cmpint(result.delta.room_capacity_cost, ==,
+                                        equivalent_result.delta.room_capacity_cost);
+                        g_assert_cmpint(result.delta.min_working_days_cost, ==,
+                                        equivalent_result.delta.min_working_days_cost);
+                        g_assert_cmpint(result.delta.curriculum_compactness_cost, ==,
+                                        equivalent_result.delta.curriculum_compactness_cost);
+                        g_assert_cmpint(result.delta.room_stability_cost, ==,
+                                        equivalent_result.delta.room_stability_cost);
+                    }
+                }
+            }
+        }
+
+        // swap_iter enumerates all but the symmetric moves
+        swap_iter iter;
+        swap_iter_init(&iter, &s);
+        while (swap_iter_next(&iter))
+            g_assert_false(swap_move_is_symmetric(&s, &iter.move));
+        g_assert_cmpint(iter.i, ==, n_enumerated);
+        swap_iter_destroy(&iter);
+
+        for (int i = 0; i < 1000; i++) {
+            swap_move mv;
+            swap_move_generate_random_feasible_effective(&s, &mv);
+            swap_perform(&s, &mv, NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
+        }
+    }
+
+    EPILOGUE();
+}
+
+GLIB_TEST_ARG(test_swap_iter_pruned) {
+    const char *model_file = (const char *) arg;
+    PROLOGUE(model_file);
+
+    swap_move *feasible_moves = mallocx(swap_neighbourhood_maximum_size(model), sizeof(swap_move));
+    // The transitions are identified by the (unordered) pair of cells swapped
+    const int n_cells = R * D * S;
+    bool *enumerated = mallocx(n_cells * n_cells, sizeof(bool));
+#define CELL(r, d, sl) INDEX3(r, R, d, D, sl, S)
+#define TRANSITION(cell1, cell2) INDEX2(MIN(cell1, cell2), n_cells, MAX(cell1, cell2), n_cells)
+
+    for (int round = 0; round < 3; round++) {
+        // Feasible moves of the full enumeration
+        int n_feasible = 0;
+        swap_iter iter;
+        swap_iter_init(&iter, &s);
+        while (swap_iter_next(&iter)) {
+            swap_result result;
+            swap_predict(&s, &iter.move,
+                         NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
+                         NEIGHBOURHOOD_PREDICT_COST_NEVER,
+                         &result);
+            if (result.feasible)
+                feasible_moves[n_feasible++] = iter.move;
+        }
+        swap_iter_destroy(&iter);
+
+        // The pruned enumeration skips only infeasible moves, without reordering
+        int n_pruned_feasible = 0;
+        memset(enumerated, 0, n_cells * n_cells * sizeof(bool));
+        swap_iter pruned_iter;
+        swap_iter_init_pruned(&pruned_iter, &s);
+        while (swap_iter_next(&pruned_iter)) {
+            // Each transition is enumerated at most once
+            const int transition = TRANSITION(
+                    CELL(pruned_iter.move.helper.r1, pruned_iter.move.helper.d1, pruned_iter.move.helper.s1),
+                    CELL(pruned_iter.move.r2, pruned_iter.move.d2, pruned_iter.move.s2));
+            g_assert_false(enumerated[transition]);
+            enumerated[transition] = true;
+
+            swap_move mv = {.l1 = pruned_iter.move.l1, .r2 = pruned_iter.move.r2,
+                            .d2 = pruned_iter.move.d2, .s2 = pruned_iter.move.s2};
+            swap_move_compute_helper(&s, &mv);
+            g_assert_true(memcmp(&mv.helper, &pruned_iter.move.helper, sizeof(mv.helper)) == 0);
+
+            swap_result result;
+            swap_predict(&s, &pruned_iter.move,
+                         NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
+                         NEIGHBOURHOOD_PREDICT_COST_NEVER,
+                         &result);
+            if (!result.feasible)
+                continue;
+
+            g_assert_cmpint(n_pruned_feasible, <, n_feasible);
+            const swap_move *expected = &feasible_moves[n_pruned_feasible++];
+            g_assert_cmpint(pruned_iter.move.l1, ==, expected->l1);
+            g_assert_cmpint(pruned_iter.move.r2, ==, expected->r2);
+            g_assert_cmpint(pruned_iter.move.d2, ==, expected->d2);
+            g_assert_cmpint(pruned_iter.move.s2, ==, expected->s2);
+        }
+        g_assert_cmpint(n_feasible, >, 0);
+        g_assert_cmpint(n_pruned_feasible, ==, n_feasible);
+        g_assert_cmpint(pruned_iter.i, <=, iter.i);
+        g_assert_cmpint(pruned_iter.n_duplicates, <=, iter.n_duplicates);
+        swap_iter_destroy(&pruned_iter);
+
+        // ...and each feasible transition is enumerated at least once,
+        // but for the ones equivalent to another one
+        for (int l = 0; l < L; l++) {
+            for (int r = 0; r < R; r++) {
+                for (int d = 0; d < D; d++) {
+                    for (int sl = 0; sl < S; sl++) {
+                        swap_move mv = {.l1 = l, .r2 = r, .d2 = d, .s2 = sl};
+                        swap_move_compute_helper(&s, &mv);
+                        if (mv.helper.c1 == mv.helper.c2)
+                            continue; // same timetable
+
+                        swap_move canonical = mv;
+                        if (mv.helper.c2 > mv.helper.c1) {
+                            canonical = (swap_move) {.l1 = mv.helper.l2, .r2 = mv.helper.r1,
+                                                     .d2 = mv.helper.d1, .s2 = mv.helper.s1};
+                            swap_move_compute_helper(&s, &canonical);
+                        }
+                        if (swap_move_is_symmetric(&s, &canonical))
+                            continue;
+
+                        swap_result result;
+                        swap_predict(&s, &mv,
+                                     NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
+                                     NEIGHBOURHOOD_PREDICT_COST_NEVER,
+                                     &result);
+                        if (result.feasible)
+                            g_assert_true(enumerated[TRANSITION(
+                                CELL(mv.helper.r1, mv.helper.d1, mv.helper.s1), CELL(r, d, sl))]);
+                    }
+                }
+            }
+        }
+
+        for (int i = 0; i < 1000; i++) {
+            swap_move mv;
+            swap_move_generate_random_feasible_effective(&s, &mv);
+            swap_perform(&s, &mv, NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
+        }
+    }
+
+#undef CELL
+#undef TRANSITION
+    free(enumerated);
+    free(feasible_moves);
+
+    EPILOGUE();
+}
+
+static void assert_swap_predict_batch(const solution *sol, const swap_moves *moves, int n,
+                                      const swap_results *results) {
+    for (int i = 0; i < n; i++) {
+        swap_move mv;
+        swap_moves_get(sol, moves, i, &mv);
+        swap_result result;
+        swap_predict(sol, &mv,
+                     NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
+                     NEIGHBOURHOOD_PREDICT_COST_IF_FEASIBLE,
+                     &result);
+        g_assert_cmpbool(results->feasible[i], ==, result.feasible);
+        if (result.feasible)
+            g_assert_cmpint(results->cost[i], ==, result.delta.cost);
+    }
+}
+
+GLIB_TEST_ARG(test_swap_predict_batch) {
+    const char *model_file = (const char *) arg;
+    PROLOGUE(model_file);
+
+    const int n = 1000;
+    swap_moves moves;
+    swap_moves_init(&moves, n);
+    swap_results results;
+    swap_results_init(&results, n);
+
+    for (int round = 0; round < 20; round++) {
+        // Both the scalar and the vectorized kernels (if supported)
+        for (int vectorization = 0; vectorization <= 1; vectorization++) {
+            swap_set_vectorization(vectorization);
+
+            // Random moves (in runs of the same lecture, as swap_iter does)
+            for (int i = 0; i < n; i++) {
+                swap_move mv;
+                swap_move_generate_random_raw(&s, &mv);
+                moves.l1[i] = i > 0 && i % 10 ? moves.l1[i - 1] : mv.l1;
+                moves.r2[i] = i > 0 && i % 5 ? moves.r2[i - 1] : mv.r2;
+                moves.d2[i] = mv.d2;
+                moves.s2[i] = mv.s2;
+            }
+            swap_predict_batch(&s, &moves, n, &results);
+            assert_swap_predict_batch(&s, &moves, n, &results);
+
+            // The moves of a scan
+            if (round % 5 == 0) {
+                swap_iter iter;
+                swap_iter_init_pruned(&iter, &s);
+                int n_moves;
+                while ((n_moves = swap_iter_next_batch(&iter, &moves)) > 0) {
+                    swap_predict_batch(&s, &moves, n_moves, &results);
+                    assert_swap_predict_batch(&s, &moves, n_moves, &results);
+                }
+                swap_iter_destroy(&iter);
+            }
+        }
+
+        for (int i = 0; i < 100; i++) {
+            swap_move mv;
+            swap_move_generate_random_feasible_effective(&s, &mv);
+            swap_perform(&s, &mv, NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
+        }
+    }
+
+    swap_set_vectorization(true);
+    swap_results_destroy(&results);
+    swap_moves_destroy(&moves);
+
+    EPILOGUE();
+}
+
+typedef struct test_swap_scan_block {
+    swap_move *moves;   // feasible moves, in scan order
+    int *costs;
+    int n;
+} test_swap_scan_block;
+
+typedef struct test_swap_scan_arg {
+    swap_scan *scan;
+    const solution *solution;
+    test_swap_scan_block *blocks;
+    bool first_improving;   // stop at the first improving move
+} test_swap_scan_arg;
+
+static bool test_swap_scan_visit(int thread, int block,
+                                 const swap_moves *moves, int n,
+                                 const swap_results *results, void *arg) {
+    test_swap_scan_arg *a = arg;
+    test_swap_scan_block *b = &a->blocks[block];
+    for (int i = 0; i < n; i++) {
+        if (!results->feasible[i] || (a->first_improving && results->cost[i] >= 0))
+            continue;
+        swap_moves_get(a->solution, moves, i, &b->moves[b->n]);
+        b->costs[b->n++] = results->cost[i];
+        if (a->first_improving) {
+            swap_scan_stop_after(a->scan, block);
+            return false;
+        }
+    }
+    return true;
+}
+
+GLIB_TEST_ARG(test_swap_scan) {
+    const char *model_file = (const char *) arg;
+    PROLOGUE(model_file);
+
+    const int max_moves = swap_neighbourhood_maximum_size(model);
+    swap_move *expected = mallocx(max_moves, sizeof(swap_move));
+    int *expected_costs = mallocx(max_moves, sizeof(int));
+    swap_moves moves;
+    swap_moves_init(&moves, SWAP_MOVES_BATCH_SIZE);
+    swap_results results;
+    swap_results_init(&results, SWAP_MOVES_BATCH_SIZE);
+
+    for (int round = 0; round < 3; round++) {
+        // Feasible moves of a sequential scan
+        int n_expected = 0, first_improving = -1;
+        swap_iter iter;
+        swap_iter_init_pruned(&iter, &s);
+        int n;
+        while ((n = swap_iter_next_batch(&iter, &moves)) > 0) {
+            swap_predict_batch(&s, &moves, n, &results);
+            for (int i = 0; i < n; i++) {
+                if (!results.feasible[i])
+                    continue;
+                if (first_improving < 0 && results.cost[i] < 0)
+                    first_improving = n_expected;
+                swap_moves_get(&s, &moves, i, &expected[n_expected]);
+                expected_costs[n_expected++] = results.cost[i];
+            }
+        }
+        swap_iter_destroy(&iter);
+
+        // The blocks, in order, give the same moves for any number of threads
+        for (int threads = 1; threads <= 3; threads += 2) {
+            swap_scan scan;
+            swap_scan_init(&scan, model, threads);
+            g_assert_cmpint(scan.block_begin[0], ==, 0);
+            g_assert_cmpint(scan.block_begin[scan.n_blocks], ==, L);
+
+            test_swap_scan_arg a = {.scan = &scan, .solution = &s};
+            a.blocks = mallocx(scan.n_blocks, sizeof(test_swap_scan_block));
+            for (int b = 0; b < scan.n_blocks; b++) {
+                a.blocks[b].moves = mallocx(max_moves, sizeof(swap_move));
+                a.blocks[b].costs = mallocx(max_moves, sizeof(int));
+            }
+
+            for (int first = 0; first <= 1; first++) {
+                a.first_improving = first;
+                for (int b = 0; b < scan.n_blocks; b++)
+                    a.blocks[b].n = 0;
+                swap_scan_run(&scan, &s, test_swap_scan_visit, &a);
+
+                int k = 0;
+                for (int b = 0; b < scan.n_blocks; b++) {
+                    for (int i = 0; i < a.blocks[b].n; i++, k++) {
+                        const swap_move *mv = &a.blocks[b].moves[i];
+                        const int j = first ? first_improving : k;
+                        g_assert_cmpint(j, <, n_expected);
+                        g_assert_true(memcmp(mv, &expected[j], sizeof(swap_move)) == 0);
+                        g_assert_cmpint(a.blocks[b].costs[i], ==, expected_costs[j]);
+                    }
+                    if (first && k > 0)
+                        break; // the blocks after the first improving one might have one too
+                }
+                g_assert_cmpint(k, ==, first ? first_improving >= 0 : n_expected);
+                if (!first)
+                    g_assert_cmpint(scan.n_moves, ==, iter.i);
+            }
+
+            for (int b = 0; b < scan.n_blocks; b++) {
+                free(a.blocks[b].moves);
+                free(a.blocks[b].costs);
+            }
+            free(a.blocks);
+            swap_scan_destroy(&scan);
+        }
+
+        for (int i = 0; i < 1000; i++) {
+            swap_move mv;
+            swap_move_generate_random_feasible_effective(&s, &mv);
+            swap_perform(&s, &mv, NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
+        }
+    }
+
+    swap_results_destroy(&results);
+    swap_moves_destroy(&moves);
+    free(expected_costs);
+    free(expected);
+
+    EPILOGUE();
+}
+
+GLIB_TEST_ARG(test_local_search_minimum) {
+    const char *model_file = (const char *) arg;
+    PROLOGUE(model_file);
+
+    feasible_solution_finder_config finder_conf;
+    feasible_solution_finder_config_default(&finder_conf);
+    unsigned long long fingerprint = 0;
+
+    // With the don't look bits and with any number of threads, LS
+    // reaches the same true local minimum of the whole neighbourhood
+    for (int threads = 1; threads <= 3; threads += 2) {
+        local_search_params ls;
+        local_search_params_default(&ls);
+        ls.threads = threads;
+        ls.dont_look_bits = true;
+
+        heuristic_solver_config solver_conf;
+        heuristic_solver_config_init(&solver_conf);
+        heuristic_solver_config_add_method(&solver_conf, local_search, &ls, "Local Search", "LS");
+        solver_conf.starting_solution = &s;
+        solver_conf.max_cycles = 1;
+
+        heuristic_solver solver;
+        heuristic_solver_init(&solver);
+        heuristic_solver_stats stats;
+        heuristic_solver_stats_init(&stats);
+
+        solution result;
+        solution_init(&result, &m);
+        g_assert_true(heuristic_solver_solve(&solver, &solver_conf, &finder_conf, &result, &stats));
+        g_assert_cmpint(stats.move_count, >, 0);
+        solution_assert_consistency_real(&result);
+
+        swap_iter iter;
+        swap_iter_init(&iter, &result);
+        while (swap_iter_next(&iter)) {
+            swap_result r;
+            swap_predict(&result, &iter.move,
+                         NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
+                         NEIGHBOURHOOD_PREDICT_COST_IF_FEASIBLE,
+                         &r);
+            g_assert_false(r.feasible && r.delta.cost < 0);
+        }
+        swap_iter_destroy(&iter);
+
+        if (threads == 1)
+            fingerprint = solution_fingerprint(&result);
+        else
+            g_assert_cmpuint(solution_fingerprint(&result), ==, fingerprint);
+
+        solution_destroy(&result);
+        heuristic_solver_stats_destroy(&stats);
+        heuristic_solver_destroy(&solver);
+        heuristic_solver_config_destroy(&solver_conf);
+    }
+
+    EPILOGUE();
+}
+
+static void assert_swap_sampler(const swap_sampler *sampler, const solution *sol) {
+    MODEL(sol->model);
+    FOR_C {
+        int n_periods[2] = {0, 0};
+        for (int p = 0; p < P; p++) {
+            int kind = swap_period_kind(sol, c, p);
+            if (kind == SWAP_ITER_PERIOD_OWN)
+                kind = -1;
+            g_assert_cmpint(sampler->kinds[INDEX2(c, C, p, P)], ==, kind);
+            if (kind >= 0) {
+                const int position = sampler->position[INDEX2(c, C, p, P)];
+                g_assert_cmpint(sampler->periods[kind][INDEX2(c, C, position, P)], ==, p);
+                n_periods[kind]++;
+            }
+        }
+        g_assert_cmpint(sampler->n_periods[SWAP_ITER_PERIOD_FREE][c], ==, n_periods[SWAP_ITER_PERIOD_FREE]);
+        g_assert_cmpint(sampler->n_periods[SWAP_ITER_PERIOD_BUSY][c], ==, n_periods[SWAP_ITER_PERIOD_BUSY]);
+    }
+}
+
+/*
+ * Sample n moves from s (performing every other one), checking them
+ * and the periods of the sampler.
+ */
+static void assert_swap_sampler_samples(solution *s, int n) {
+    swap_sampler sampler;
+    swap_sampler_init(&sampler, s);
+    assert_swap_sampler(&sampler, s);
+
+    for (int i = 0; i < n; i++) {
+        swap_move mv;
+        swap_result result;
+        swap_sampler_sample(&sampler, s, &mv, &result);
+
+        // The move is a feasible and effective one, with its cost
+        swap_move expected = {.l1 = mv.l1, .r2 = mv.r2, .d2 = mv.d2, .s2 = mv.s2};
+        swap_move_compute_helper(s, &expected);
+        g_assert_true(memcmp(&mv.helper, &expected.helper, sizeof(mv.helper)) == 0);
+        g_assert_true(swap_move_is_effective(&mv));
+        g_assert_false(swap_move_is_symmetric(s, &mv));
+
+        swap_result expected_result;
+        swap_predict(s, &mv,
+                     NEIGHBOURHOOD_PREDICT_FEASIBILITY_ALWAYS,
+                     NEIGHBOURHOOD_PREDICT_COST_ALWAYS,
+                     &expected_result);
+        g_assert_true(result.feasible);
+        g_assert_true(expected_result.feasible);
+        g_assert_cmpint(result.delta.cost, ==, expected_result.delta.cost);
+
+        if (i % 2 == 0) {
+            swap_perform(s, &mv, NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
+            swap_sampler_update(&sampler, s, &mv);
+        }
+        if (i % 1000 == 0)
+            assert_swap_sampler(&sampler, s);
+    }
+
+    assert_swap_sampler(&sampler, s);
+    g_assert_cmpint(sampler.n_samples, ==, n);
+    g_assert_cmpint(sampler.n_draws, >=, sampler.n_samples);
+
+    swap_sampler_destroy(&sampler);
+}
+
+GLIB_TEST_ARG(test_swap_sampler) {
+    const char *model_file = (const char *) arg;
+    PROLOGUE(model_file);
+
+    assert_swap_sampler_samples(&s, 20000);
+    solution_assert_consistency_real(&s);
+
+    EPILOGUE();
+}
+
+/* An instance with more than INT_MAX moves for the sampler (~L*R*P) */
+GLIB_TEST(test_swap_sampler_large) {
+    const char *filename = "/tmp/itc2007-cct-test-swap-sampler.ctt";
+    const char *solution_filename = "/tmp/itc2007-cct-test-swap-sampler.ctt.sol";
+
+    generator_config config;
+    generator_config_default(&config);
+    config.n_courses = 3000;
+    config.n_rooms = 2000;
+    config.n_days = 10;
+    config.n_slots = 20;
+    config.unavailability_ratio = 0;
+    config.seed = 4;
+    g_assert_true(generate_instance(&config, filename, solution_filename));
+
+    model m;
+    model_init(&m);
+    g_assert_true(parse_model(&m, filename));
+    MODEL(&m);
+    solution s;
+    solution_init(&s, &m);
+    g_assert_true(parse_solution(&s, solution_filename));
+    g_assert_true(solution_satisfy_hard_constraints(&s));
+
+    swap_sampler sampler;
+    swap_sampler_init(&sampler, &s);
+    int64_t total = 0;
+    FOR_C {
+        total += (int64_t) model->courses[c].n_lectures *
+                 (R * (sampler.n_periods[SWAP_ITER_PERIOD_FREE][c] + 1) +
+                  sampler.n_periods[SWAP_ITER_PERIOD_BUSY][c]);
+    }
+    g_assert_cmpint(total, >, INT_MAX);
+    swap_sampler_destroy(&sampler);
+
+    assert_swap_sampler_samples(&s, 2000);
+    g_assert_true(solution_satisfy_hard_constraints(&s));
+
+    EPILOGUE();
+    remove(filename);
+    remove(solution_filename);
+}
+
 typedef struct test_swap_effectiveness_params {
     const char *model_file;
     int trials;
@@ -446,6 +1428,7 @@ GLIB_TEST_ARG(test_swap_effectiveness) {
         swap_perform(&s, &mv, NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
 
         unsigned long long h2 = solution_fingerprint(&s);
+        g_assert_cmpuint(h2, ==, solution_compute_fingerprint(&s));
 
         if (swap_move_is_effective(&mv))
             g_assert_cmpuint(h, !=, h2);
@@ -480,6 +1463,7 @@ GLIB_TEST_ARG(test_swap_reverse) {
         swap_perform(&s, &mv_back, NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
         unsigned long long h2 = solution_fingerprint(&s);
         g_assert_cmpuint(h, ==, h2);
+        g_assert_cmpuint(h2, ==, solution_compute_fingerprint(&s));
 
     }
 
@@ -559,6 +1543,13 @@ GLIB_TEST_ARG(test_swap_cost) {
         g_assert_cmpint(mwd + result.delta.min_working_days_cost, ==, solution_min_working_days_cost(&s));
         g_assert_cmpint(cc + result.delta.curriculum_compactness_cost, ==, solution_curriculum_compactness_cost(&s));
         g_assert_cmpint(rs + result.delta.room_stability_cost, ==, solution_room_stability_cost(&s));
+
+        solution_costs costs;
+        solution_compute_cost_breakdown(&s, &costs);
+        g_assert_cmpint(costs.room_capacity, ==, solution_room_capacity_cost(&s));
+        g_assert_cmpint(costs.min_working_days, ==, solution_min_working_days_cost(&s));
+        g_assert_cmpint(costs.curriculum_compactness, ==, solution_curriculum_compactness_cost(&s));
+        g_assert_cmpint(costs.room_stability, ==, solution_room_stability_cost(&s));
         rc += result.delta.room_capacity_cost;
         mwd += result.delta.min_working_days_cost;
         cc += result.delta.curriculum_compactness_cost;
@@ -569,6 +1560,88 @@ GLIB_TEST_ARG(test_swap_cost) {
 }
 
 
+typedef struct test_solution_snapshot_params {
+    const char *model_file;
+    int trials;
+} test_solution_snapshot_params;
+
+
+GLIB_TEST_ARG(test_solution_snapshot) {
+    test_solution_snapshot_params *params = (test_solution_snapshot_params *) arg;
+    PROLOGUE(params->model_file);
+
+    swap_move mv;
+
+    solution_snapshot snapshot;
+    solution_snapshot_init(&snapshot, &m);
+    solution_take_snapshot(&snapshot, &s);
+
+    unsigned long long h = solution_fingerprint(&s);
+    int cost = solution_cost(&s);
+
+    for (int i = 0; i < params->trials; i++) {
+        swap_move_generate_random_feasible_effective(&s, &mv);
+        swap_perform(&s, &mv, NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
+    }
+
+    solution_restore_snapshot(&s, &snapshot);
+    solution_assert_consistency_real(&s);
+    g_assert_cmpuint(h, ==, solution_fingerprint(&s));
+    g_assert_cmpint(cost, ==, solution_cost(&s));
+    g_assert_true(solution_satisfy_hard_constraints(&s));
+
+    solution_snapshot_destroy(&snapshot);
+    EPILOGUE();
+}
+
+typedef struct test_solution_transaction_params {
+    const char *model_file;
+    int trials;
+    int moves;
+} test_solution_transaction_params;
+
+
+GLIB_TEST_ARG(test_solution_transaction) {
+    test_solution_transaction_params *params = (test_solution_transaction_params *) arg;
+    PROLOGUE(params->model_file);
+
+    swap_move mv;
+
+    solution s_before;
+    solution_init(&s_before, &m);
+
+    for (int i = 0; i < params->trials; i++) {
+        solution_copy(&s_before, &s);
+
+        solution_begin(&s);
+        for (int j = 0; j < params->moves; j++) {
+            swap_move_generate_random_feasible_effective(&s, &mv);
+            swap_perform(&s, &mv, NEIGHBOURHOOD_PERFORM_ALWAYS, NULL);
+        }
+        unsigned long long h = solution_fingerprint(&s);
+        int cost = solution_cost(&s);
+
+        if (i % 2) {
+            // Rollback: must be exactly the solution before the transaction
+            solution_rollback(&s);
+            solution_assert_consistency_real(&s);
+            g_assert_cmpuint(solution_fingerprint(&s), ==, solution_fingerprint(&s_before));
+            g_assert_cmpint(solution_cost(&s), ==, solution_cost(&s_before));
+            g_assert_true(memcmp(s._arena, s_before._arena, s._arena_size) == 0);
+        } else {
+            // Commit: the moves are kept
+            solution_commit(&s);
+            solution_assert_consistency_real(&s);
+            g_assert_cmpuint(solution_fingerprint(&s), ==, h);
+            g_assert_cmpint(solution_cost(&s), ==, cost);
+        }
+    }
+
+    solution_destroy(&s_before);
+    EPILOGUE();
+}
+
+
 int main(int argc, char *argv[]) {
     set_verbosity(0  );
 
@@ -603,7 +1676,49 @@ int main(int argc, char *argv[]) {
     GLIB_ADD_TEST("/os/pathjoin", test_pathjoin);
     GLIB_ADD_TEST("/os/mkdirs", test_mkdirs);
 
+    GLIB_ADD_TEST("/io/fileparse", test_fileparse);
+
     GLIB_ADD_TEST_ARG("/itc/test_parser/toy", test_parser, "datasets/toy.ctt");
+    GLIB_ADD_TEST_ARG("/itc/model_relations/toy", test_model_relations, "datasets/toy.ctt");
+    GLIB_ADD_TEST_ARG("/itc/model_relations/comp07", test_model_relations, "datasets/comp07.ctt");
+    GLIB_ADD_TEST_ARG("/itc/model_cache/toy", test_model_cache, "datasets/toy.ctt");
+    GLIB_ADD_TEST_ARG("/itc/model_cache/comp07", test_model_cache, "datasets/comp07.ctt");
+
+    generator_config generator_default;
+    generator_config_default(&generator_default);
+    generator_default.seed = 1;
+    GLIB_ADD_TEST_ARG("/itc/generator/default", test_generator, &generator_default);
+
+    generator_config generator_tight;
+    generator_config_default(&generator_tight);
+    generator_tight.n_courses = 300;
+    generator_tight.n_days = 4;
+    generator_tight.n_slots = 4;
+    generator_tight.occupancy = 1;
+    generator_tight.curricula_density = 3;
+    generator_tight.teacher_load = 4;
+    generator_tight.unavailability_ratio = 0.5;
+    generator_tight.seed = 2;
+    GLIB_ADD_TEST_ARG("/itc/generator/tight", test_generator, &generator_tight);
+
+    test_decomposition_params decomposition_disconnected = { .threads = 3, .decomposable = true };
+    generator_config_default(&decomposition_disconnected.generator);
+    decomposition_disconnected.generator.n_courses = 60;
+    decomposition_disconnected.generator.curricula_density = 0.3;
+    decomposition_disconnected.generator.teacher_load = 1;
+    decomposition_disconnected.generator.seed = 3;
+    GLIB_ADD_TEST_ARG("/itc/decomposition/disconnected", test_decomposition, &decomposition_disconnected);
+
+    test_decomposition_params decomposition_connected = {
+        .model_file = "datasets/toy.ctt", .threads = 3, .decomposable = false
+    };
+    GLIB_ADD_TEST_ARG("/itc/decomposition/toy", test_decomposition, &decomposition_connected);
+
+    // Two components, but the rooms are too few for giving one to the smaller
+    test_decomposition_params decomposition_few_rooms = {
+        .model_file = "datasets/comp01.ctt", .threads = 3, .decomposable = false
+    };
+    GLIB_ADD_TEST_ARG("/itc/decomposition/comp01", test_decomposition, &decomposition_few_rooms);
 
     const char *_1[] = {"datasets/toy.ctt", "tests/solutions/toy.ctt.sol"};
     GLIB_ADD_TEST_ARG("/itc/solution_parser/toy", test_solution_parser, _1);
@@ -636,6 +1751,19 @@ int main(int argc, char *argv[]) {
     GLIB_ADD_TEST_ARG("/itc/finder/comp03", test_finder, "datasets/comp03.ctt");
 
     GLIB_ADD_TEST_ARG("/itc/swap_iter_next/comp01", test_swap_iter_next, "datasets/comp01.ctt");
+    GLIB_ADD_TEST_ARG("/itc/swap_symmetry/comp02", test_swap_symmetry, "datasets/comp02.ctt");
+    GLIB_ADD_TEST_ARG("/itc/swap_symmetry/comp09", test_swap_symmetry, "datasets/comp09.ctt");
+    GLIB_ADD_TEST_ARG("/itc/swap_iter_pruned/comp01", test_swap_iter_pruned, "datasets/comp01.ctt");
+    GLIB_ADD_TEST_ARG("/itc/swap_iter_pruned/comp05", test_swap_iter_pruned, "datasets/comp05.ctt");
+    GLIB_ADD_TEST_ARG("/itc/swap_predict_batch/comp01", test_swap_predict_batch, "datasets/comp01.ctt");
+    GLIB_ADD_TEST_ARG("/itc/swap_predict_batch/comp12", test_swap_predict_batch, "datasets/comp12.ctt");
+    GLIB_ADD_TEST_ARG("/itc/swap_scan/comp01", test_swap_scan, "datasets/comp01.ctt");
+    GLIB_ADD_TEST_ARG("/itc/swap_scan/comp07", test_swap_scan, "datasets/comp07.ctt");
+    GLIB_ADD_TEST_ARG("/itc/local_search_minimum/comp01", test_local_search_minimum, "datasets/comp01.ctt");
+    GLIB_ADD_TEST_ARG("/itc/local_search_minimum/comp07", test_local_search_minimum, "datasets/comp07.ctt");
+    GLIB_ADD_TEST_ARG("/itc/swap_sampler/comp01", test_swap_sampler, "datasets/comp01.ctt");
+    GLIB_ADD_TEST_ARG("/itc/swap_sampler/comp05", test_swap_sampler, "datasets/comp05.ctt");
+    GLIB_ADD_TEST("/itc/swap_sampler/large", test_swap_sampler_large);
 
     test_swap_effectiveness_params _5 = {
         .model_file = "datasets/toy.ctt",
@@ -697,5 +1825,38 @@ int main(int argc, char *argv[]) {
     };
     GLIB_ADD_TEST_ARG("/itc/swap_cost/comp07", test_swap_cost, &_14);
 
+    // Many curriculas per course
+    test_swap_cost_params _14b = {
+        .model_file = "datasets/comp12.ctt",
+        .trials = 20000
+    };
+    GLIB_ADD_TEST_ARG("/itc/swap_cost/comp12", test_swap_cost, &_14b);
+
+    test_solution_snapshot_params _15 = {
+        .model_file = "datasets/comp01.ctt",
+        .trials = 1000
+    };
+    GLIB_ADD_TEST_ARG("/itc/solution_snapshot/comp01", test_solution_snapshot, &_15);
+
+    test_solution_snapshot_params _16 = {
+        .model_file = "datasets/comp07.ctt",
+        .trials = 1000
+    };
+    GLIB_ADD_TEST_ARG("/itc/solution_snapshot/comp07", test_solution_snapshot, &_16);
+
+    test_solution_transaction_params _17 = {
+        .model_file = "datasets/comp01.ctt",
+        .trials = 1000,
+        .moves = 4
+    };
+    GLIB_ADD_TEST_ARG("/itc/solution_transaction/comp01", test_solution_transaction, &_17);
+
+    test_solution_transaction_params _18 = {
+        .model_file = "datasets/comp07.ctt",
+        .trials = 200,
+        .moves = 20
+    };
+    GLIB_ADD_TEST_ARG("/itc/solution_transaction/comp07", test_solution_transaction, &_18);
+
     g_test_run();
 }
\ No newline at end of file